@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <nlohmann/json.hpp>
+
+#include "SeqLock.h"
+
+namespace singular {
+namespace gateway {
+namespace gateio {
+
+// Spot and perpetual best bid/offer for one asset (e.g. BTC_USDT) and the basis between them
+struct BasisRecord {
+    double spot_bid = 0.0;
+    double spot_ask = 0.0;
+    double perp_bid = 0.0;
+    double perp_ask = 0.0;
+
+    double basis = 0.0;              // perp mid - spot mid
+    double basis_bps = 0.0;          // relative to spot mid
+    double sell_perp_buy_spot = 0.0; // perp bid - spot ask, executable
+    double buy_perp_sell_spot = 0.0; // perp ask - spot bid, executable
+
+    int64_t spot_exchange_time_ms = 0;
+    int64_t perp_exchange_time_ms = 0;
+    int64_t spot_receive_time_ns = 0;
+    int64_t perp_receive_time_ns = 0;
+    int64_t leg_skew_ns = 0;         // perp receive - spot receive of the legs in this record
+    bool spot_live = false;          // leg quoted on both sides from a book without a gap
+    bool perp_live = false;
+    bool complete = false;           // both legs live; the derived values are 0 while not
+};
+
+// Consolidated spot/perpetual view. Spot BASE_QUOTE@SPOT and perpetual BASE_QUOTE@FUTURE
+// are paired through the instrument catalog's base and quote, and the basis is recomputed
+// on every top-of-book change of either leg. Readers go through a SeqLock.
+class BasisView {
+public:
+    class Pair {
+    public:
+        BasisRecord read() const { return record_.read(); }
+        uint64_t version() const { return record_.version(); }
+
+    private:
+        friend class BasisView;
+        std::string asset_;
+        SeqLock<BasisRecord> record_;
+    };
+
+    // Returns the pair symbol belongs to (created on first use) and whether it is the spot leg,
+    // or nullptr for instruments that are neither spot nor perpetual
+    Pair* link(const std::string& symbol, bool& spot_leg);
+
+    // Called from the feed thread after the leg's top of book or validity changed. A leg that
+    // is not live (one-sided, or its book lost sequence) takes the pair out of complete.
+    void on_leg(Pair& pair, bool spot_leg, bool live, double bid, double ask, int64_t exchange_time_ms, int64_t receive_time_ns);
+
+    bool read(const std::string& asset, BasisRecord& out) const;
+    nlohmann::json get_stats() const;
+
+private:
+    mutable std::mutex pairs_mutex_;  // only taken to create or look up pairs
+    std::unordered_map<std::string, std::unique_ptr<Pair>> pairs_;
+};
+
+} // namespace gateio
+} // namespace gateway
+} // namespace singular
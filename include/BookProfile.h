@@ -0,0 +1,65 @@
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <nlohmann/json.hpp>
+
+namespace singular {
+namespace gateway {
+namespace gateio {
+
+// How one symbol's order book is subscribed.
+//   DELTA     spot/futures.order_book_update, incremental levels at 20ms or 100ms
+//   SNAPSHOT  spot/futures.order_book, the full top-N book on every push
+//   OBU       spot/futures.obu (order book v2), "ob.<pair>.<50|400>" incremental stream
+// Text form is kind[:interval][:depth], e.g. "delta:20ms:20", "snapshot:1000ms:5", "obu:400".
+struct BookProfile {
+    enum class Kind { DELTA, SNAPSHOT, OBU };
+
+    Kind kind = Kind::DELTA;
+    std::string interval = "100ms";
+    int depth = 20;
+
+    static bool parse(const std::string& text, BookProfile& out);
+    std::string to_string() const;
+
+    // Snaps interval and depth to values Gate.io accepts for the market ("SPOT" or "FUTURE")
+    BookProfile normalized(const std::string& market) const;
+
+    std::string channel(const std::string& market) const;
+    nlohmann::json payload(const std::string& pair, const std::string& market) const;
+
+    bool operator==(const BookProfile& other) const
+    {
+        return kind == other.kind && interval == other.interval && depth == other.depth;
+    }
+    bool operator!=(const BookProfile& other) const { return !(*this == other); }
+};
+
+// Default profile plus per-symbol overrides, keyed by internal symbol ("BTC_USDT@SPOT").
+// Loaded from GATEIO_BOOK_PROFILE and GATEIO_BOOK_PROFILES, changeable at runtime.
+class BookProfileTable {
+public:
+    BookProfileTable();
+
+    // "BTC_USDT@SPOT=delta:20ms:20;ETH_USDT@FUTURE=obu:400", bad entries are logged and skipped
+    void load(const std::string& default_profile, const std::string& overrides);
+
+    BookProfile resolve(const std::string& symbol) const;
+    void set(const std::string& symbol, const BookProfile& profile);
+    void reset(const std::string& symbol);
+
+    nlohmann::json get_stats() const;
+
+private:
+    std::string log_service_name = "GATEIO";
+
+    mutable std::mutex mutex_;
+    BookProfile default_;
+    std::unordered_map<std::string, BookProfile> overrides_;
+};
+
+} // namespace gateio
+} // namespace gateway
+} // namespace singular
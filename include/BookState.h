@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace singular {
+namespace gateway {
+namespace gateio {
+
+struct BookLevel {
+    double price = 0.0;
+    double quantity = 0.0;
+};
+
+// Top-N view of one symbol's book after an update has been applied.
+// symbol uses the internal form, e.g. BTC_USDT@SPOT or BTC_USD@FUTURE.
+struct BookState {
+    std::string symbol;
+    uint64_t first_update_id = 0;
+    uint64_t last_update_id = 0;
+    int64_t exchange_time_ms = 0;
+    int64_t receive_time_ns = 0;
+    int64_t latency_ns = 0;  // estimated one-way delay of the carrying message, 0 if unknown
+    bool valid = true;       // false from a sequence gap until the next snapshot or full book
+    std::vector<BookLevel> bids;
+    std::vector<BookLevel> asks;
+};
+
+} // namespace gateio
+} // namespace gateway
+} // namespace singular
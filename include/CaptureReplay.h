@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#include "FeedCapture.h"
+#include "LatencyHistogram.h"
+
+namespace singular {
+namespace gateway {
+namespace gateio {
+
+// Reads capture segments written by FeedCapture, in the order given, frame by frame.
+// The writer drains connections in batches, so frames are merged back into receive order
+// by their wall-clock stamp through a reorder window of FeedCapture::WRITE_BATCH frames
+// per connection. A frame that still arrives behind one already returned is counted as
+// late. Payloads stay valid until the next call to next().
+class CaptureReader {
+public:
+    struct Frame {
+        const std::string* connection = nullptr;
+        uint16_t connection_id = 0;
+        uint64_t tsc = 0;
+        int64_t wall_ns = 0;
+        const char* data = nullptr;
+        size_t size = 0;
+    };
+
+    explicit CaptureReader(std::vector<std::string> paths);
+    ~CaptureReader();
+
+    CaptureReader(const CaptureReader&) = delete;
+    CaptureReader& operator=(const CaptureReader&) = delete;
+
+    bool next(Frame& frame);
+
+    double tsc_ticks_per_ns() const { return tsc_ticks_per_ns_; }
+    uint64_t segments_read() const { return segments_read_; }
+    uint64_t bytes_read() const { return bytes_read_; }
+    uint64_t frames_reordered() const { return frames_reordered_; }
+    uint64_t frames_late() const { return frames_late_; }
+    // Connection names by id, complete for every connection registered before the first frame
+    const std::unordered_map<uint16_t, std::string>& connections() const { return connections_; }
+
+private:
+    struct Pending {
+        uint64_t sequence = 0;       // file order, breaks ties between equal stamps
+        uint16_t connection_id = 0;
+        uint64_t tsc = 0;
+        int64_t wall_ns = 0;
+        std::string payload;
+    };
+
+    bool open_next();
+    void unmap();
+    bool read_record(Pending& frame);
+
+    std::string log_service_name = "GATEIO";
+    std::vector<std::string> paths_;
+    size_t next_path_ = 0;
+
+    const char* mapped_ = nullptr;
+    size_t mapped_size_ = 0;
+    size_t offset_ = 0;
+    double tsc_ticks_per_ns_ = 1.0;
+    std::unordered_map<uint16_t, std::string> connections_;
+    std::string unknown_connection_ = "unknown";
+
+    std::vector<Pending> window_;    // min-heap on (wall_ns, sequence)
+    Pending current_;
+    uint64_t sequence_ = 0;
+    int64_t newest_wall_ns_ = 0;
+    int64_t released_wall_ns_ = 0;
+    bool exhausted_ = false;
+
+    uint64_t segments_read_ = 0;
+    uint64_t bytes_read_ = 0;
+    uint64_t frames_reordered_ = 0;
+    uint64_t frames_late_ = 0;
+};
+
+// Plays a capture back into a frame handler, optionally paced by the recorded wall clock.
+// The pacing clock never runs backwards: a late frame is replayed at once.
+// Per-stage latency is collected around the reader and the handler; handlers can add
+// their own stages through stage().
+class CaptureReplayer {
+public:
+    enum class Mode { FAST, REAL_TIME, SCALED };
+
+    using Handler = std::function<void(const std::string& connection, const std::string& frame)>;
+
+    CaptureReplayer(Mode mode, double speed);
+
+    // Blocks until the capture is exhausted, returns the number of frames replayed
+    uint64_t run(CaptureReader& reader, const Handler& handler);
+
+    LatencyHistogram& stage(const std::string& name) { return stages_[name]; }
+    nlohmann::json get_stats() const;
+
+    static bool parse_mode(const std::string& text, Mode& mode);
+
+private:
+    void pace(int64_t recorded_offset_ns, int64_t replay_start_ns);
+
+    Mode mode_;
+    double speed_;
+    std::unordered_map<std::string, LatencyHistogram> stages_;
+    std::unordered_map<std::string, uint64_t> frames_per_connection_;
+    uint64_t frames_ = 0;
+    uint64_t bytes_ = 0;
+    int64_t elapsed_ns_ = 0;
+    int64_t recorded_span_ns_ = 0;
+};
+
+} // namespace gateio
+} // namespace gateway
+} // namespace singular
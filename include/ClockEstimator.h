@@ -0,0 +1,68 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <nlohmann/json.hpp>
+
+#include "LatencyHistogram.h"
+#include "SeqLock.h"
+
+namespace singular {
+namespace gateway {
+namespace gateio {
+
+struct ClockSnapshot {
+    int64_t offset_ns = 0;            // exchange clock - local clock
+    bool offset_from_ping = false;    // false: assumes the fastest recent message had zero latency
+    int64_t min_rtt_ns = 0;
+    int64_t last_rtt_ns = 0;
+    int64_t last_latency_ns = 0;      // one-way, exchange push to local receive
+    double latency_ewma_ns = 0.0;
+    int64_t last_sample_wall_ns = 0;
+    uint64_t samples = 0;
+    uint64_t pings = 0;
+};
+
+// Estimates the exchange-to-local clock offset and the one-way feed latency of one
+// connection from the time_ms stamped on every Gate.io push and, when available, from
+// ping/pong round trips (NTP style: the lowest-RTT exchange in the window wins).
+// Fed from the connection's own thread; snapshots are read lock-free.
+class ClockEstimator {
+public:
+    explicit ClockEstimator(const std::string& name);
+
+    // Returns the one-way latency estimate for this message in ns
+    int64_t on_message(int64_t exchange_time_ms, int64_t receive_wall_ns);
+    void on_pong(int64_t send_wall_ns, int64_t receive_wall_ns, int64_t server_time_ms);
+
+    ClockSnapshot read() const { return snapshot_.read(); }
+    const std::string& name() const { return name_; }
+    nlohmann::json get_stats();
+
+private:
+    static constexpr size_t DELAY_BUCKETS = 6;        // minimum raw delay per 10s, over one minute
+    static constexpr int64_t DELAY_BUCKET_NS = 10000000000LL;
+    static constexpr size_t PING_WINDOW = 8;
+
+    struct PingSample {
+        int64_t rtt_ns = 0;
+        int64_t offset_ns = 0;
+    };
+
+    int64_t window_min_delay() const;
+
+    std::string name_;
+    SeqLock<ClockSnapshot> snapshot_;
+
+    // Writer-side state
+    std::array<int64_t, DELAY_BUCKETS> bucket_min_delay_;
+    std::array<int64_t, DELAY_BUCKETS> bucket_start_ns_{};
+    std::array<PingSample, PING_WINDOW> pings_{};
+    size_t ping_count_ = 0;
+    LatencyHistogram latency_;
+};
+
+} // namespace gateio
+} // namespace gateway
+} // namespace singular
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace singular {
+namespace gateway {
+namespace gateio {
+
+// Optional tuning knobs are read from the environment (the Gateway loads .env first).
+// Every knob has a default so an unset variable keeps the previous behaviour.
+
+inline bool env_flag(const char* name, bool fallback)
+{
+    const char* value = std::getenv(name);
+    if (!value || value[0] == '\0')
+        return fallback;
+    return strcmp(value, "1") == 0 || strcmp(value, "true") == 0 || strcmp(value, "TRUE") == 0;
+}
+
+inline long env_long(const char* name, long fallback)
+{
+    const char* value = std::getenv(name);
+    if (!value || value[0] == '\0')
+        return fallback;
+    char* end = nullptr;
+    long parsed = std::strtol(value, &end, 10);
+    return end == value ? fallback : parsed;
+}
+
+inline std::string env_string(const char* name, const std::string& fallback)
+{
+    const char* value = std::getenv(name);
+    return (value && value[0] != '\0') ? std::string(value) : fallback;
+}
+
+// Comma separated integers, e.g. GATEIO_CPU_PUBLIC_SPOT=3,4
+inline std::vector<long> env_long_list(const char* name)
+{
+    std::vector<long> values;
+    const char* value = std::getenv(name);
+    while (value && *value) {
+        char* end = nullptr;
+        long parsed = std::strtol(value, &end, 10);
+        if (end == value)
+            break;
+        values.push_back(parsed);
+        value = (*end == ',') ? end + 1 : end;
+    }
+    return values;
+}
+
+} // namespace gateio
+} // namespace gateway
+} // namespace singular
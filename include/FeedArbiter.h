@@ -0,0 +1,92 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <nlohmann/json.hpp>
+
+#include "LatencyHistogram.h"
+
+namespace singular {
+namespace gateway {
+namespace gateio {
+
+// Picks one copy of every update when the same symbols are subscribed on two public
+// sockets (line A and line B). Frames are keyed by channel and symbol and ordered by the
+// update id read straight from the raw frame: u for books and book tickers, lastUpdateId
+// or id for snapshots, id for trades. The first copy of an id is applied and later copies
+// are dropped before any JSON parsing. Frames without an id (tickers, acks) are taken from
+// the lowest open line. When a line skips ids that the other line already delivered, that
+// is counted as a gap fill: the gap never reached the book.
+// offer() is called from both lines' loops. apply runs under the arbiter's lock, so the
+// shared book sees updates in id order.
+class FeedArbiter {
+public:
+    static constexpr size_t MAX_LINES = 2;
+
+    FeedArbiter(const std::string& name, size_t lines);
+
+    // Runs apply() and returns true for the first copy of a frame, false for a duplicate
+    template <typename Fn>
+    bool offer(size_t line, const std::string& frame, Fn&& apply)
+    {
+        if (line >= lines_)
+        {
+            return false;
+        }
+        Key& key = keys_[line];
+        const bool keyed = read_key(frame, key);
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!admit(line, keyed, key))
+        {
+            return false;
+        }
+        apply();
+        return true;
+    }
+
+    void set_line_open(size_t line, bool open);
+    const std::string& name() const { return name_; }
+    nlohmann::json get_stats() const;
+
+private:
+    struct Key {
+        std::string stream;          // channel|symbol
+        uint64_t first = 0;          // U of a book delta, 0 when the frame carries a single id
+        uint64_t last = 0;
+    };
+
+    struct Stream {
+        uint64_t last = 0;
+        int64_t last_ns = 0;         // arrival of the first copy of last
+        std::array<uint64_t, MAX_LINES> line_last{};
+    };
+
+    struct Line {
+        bool open = false;
+        uint64_t frames = 0;
+        uint64_t wins = 0;
+        uint64_t duplicates = 0;
+        uint64_t gap_fills = 0;
+        uint64_t untracked = 0;
+    };
+
+    static bool read_key(const std::string& frame, Key& key);
+    bool admit(size_t line, bool keyed, const Key& key);
+
+    std::string name_;
+    size_t lines_;
+    std::array<Key, MAX_LINES> keys_;    // scratch, each touched only by its line's loop
+
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, Stream> streams_;
+    std::array<Line, MAX_LINES> line_stats_;
+    uint64_t gaps_ = 0;                  // ids missing on every line
+    LatencyHistogram lead_;              // first copy to duplicate, ns
+};
+
+} // namespace gateio
+} // namespace gateway
+} // namespace singular
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <nlohmann/json.hpp>
+
+#include "SpscQueue.h"
+
+namespace singular {
+namespace gateway {
+namespace gateio {
+
+// On-disk layout of a capture segment (little endian, host byte order):
+//   CaptureFileHeader, then records aligned to 8 bytes, each a CaptureRecordHeader
+//   followed by `length` payload bytes. CONNECTION records name a connection id and
+//   are repeated at the top of every segment, so each segment can be read on its own.
+struct CaptureFileHeader {
+    char magic[8];               // "GIOCAP1"
+    uint32_t version;
+    uint32_t header_size;
+    int64_t start_wall_ns;
+    uint64_t start_tsc;
+    double tsc_ticks_per_ns;
+};
+
+struct CaptureRecordHeader {
+    enum Kind : uint8_t { FRAME = 0, CONNECTION = 1 };
+
+    uint32_t length;             // payload bytes, excluding padding
+    uint16_t connection;
+    uint8_t kind;
+    uint8_t reserved;
+    uint64_t tsc;                // receive time on the socket thread
+    int64_t wall_ns;
+};
+
+static_assert(sizeof(CaptureRecordHeader) == 24, "capture record header must stay packed");
+
+// Records raw websocket frames into memory-mapped, size-rotated segment files.
+// Socket threads only stamp the frame and copy it into their own SPSC queue;
+// a writer thread moves the frames into the mapped segment. A full queue drops
+// the frame and counts it rather than slowing the socket down.
+class FeedCapture {
+public:
+    static constexpr size_t MAX_CONNECTIONS = 256;
+    // Frames the writer moves per connection per pass. Segments hold each connection's
+    // frames in receive order, but frames of different connections can be this far apart.
+    static constexpr size_t WRITE_BATCH = 256;
+
+    FeedCapture(const std::string& directory, size_t segment_bytes, size_t queue_capacity);
+    ~FeedCapture();
+
+    FeedCapture(const FeedCapture&) = delete;
+    FeedCapture& operator=(const FeedCapture&) = delete;
+
+    // Registers a connection, the id is written with every frame it captures.
+    // Gateways sharing the hub's capture may register from their own threads.
+    uint16_t add_connection(const std::string& name);
+
+    // Called from the connection's socket thread only
+    void record(uint16_t connection, const std::string& frame);
+
+    bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+    nlohmann::json get_stats() const;
+
+private:
+    struct PendingFrame {
+        uint64_t tsc = 0;
+        int64_t wall_ns = 0;
+        std::string payload;
+    };
+
+    struct Connection {
+        std::string name;
+        SpscQueue<PendingFrame> queue;
+        std::atomic<uint64_t> captured{0};
+        std::atomic<uint64_t> dropped{0};
+
+        Connection(const std::string& connection_name, size_t capacity) : name(connection_name), queue(capacity) {}
+    };
+
+    void writer_loop();
+    bool open_segment();
+    void close_segment();
+    bool append(uint16_t connection, uint8_t kind, uint64_t tsc, int64_t wall_ns, const std::string& payload);
+
+    std::string log_service_name = "GATEIO";
+    std::string directory_;
+    size_t segment_bytes_;
+    size_t queue_capacity_;
+    std::atomic<bool> enabled_{true};
+
+    std::array<std::unique_ptr<Connection>, MAX_CONNECTIONS> connections_;
+    std::atomic<size_t> connection_count_{0};
+    std::mutex add_mutex_;
+
+    // Writer thread state
+    int fd_ = -1;
+    char* mapped_ = nullptr;
+    size_t offset_ = 0;
+    uint64_t segment_index_ = 0;
+    std::string segment_path_;
+
+    std::atomic<bool> running_{true};
+    std::atomic<uint64_t> bytes_written_{0};
+    std::atomic<uint64_t> segments_{0};
+    std::thread writer_;
+};
+
+} // namespace gateio
+} // namespace gateway
+} // namespace singular
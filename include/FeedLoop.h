@@ -0,0 +1,47 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <singular/network/libhv/EventLoopThread.h>
+
+namespace singular {
+namespace gateway {
+namespace gateio {
+
+// An event loop on its own thread, optionally pinned to one CPU.
+// The gateway gives each socket (or socket group) one of these so a burst on one
+// feed cannot delay callbacks of another.
+class FeedLoop {
+public:
+    FeedLoop(const std::string& name, int cpu);
+    ~FeedLoop();
+
+    FeedLoop(const FeedLoop&) = delete;
+    FeedLoop& operator=(const FeedLoop&) = delete;
+
+    const hv::EventLoopPtr& loop() const { return thread_.loop(); }
+    const std::string& name() const { return name_; }
+    int cpu() const { return cpu_; }
+
+private:
+    std::string name_;
+    int cpu_;
+    hv::EventLoopThread thread_;
+};
+
+// Runs fn on loop and returns once it has run. Runs it in place on the loop's own thread and
+// when the loop is not running, so it never waits for a loop that cannot get to it.
+void run_in_loop_and_wait(const hv::EventLoopPtr& loop, const std::function<void()>& fn);
+
+// count loops named "gio-<group><i>", pinned to the CPUs listed in cpu_env and owned by
+// owner; just {executor} when dedicated is false
+std::vector<hv::EventLoopPtr> make_feed_loops(std::vector<std::unique_ptr<FeedLoop>>& owner, bool dedicated,
+                                              const std::string& group, size_t count, const char* cpu_env,
+                                              hv::EventLoopPtr& executor);
+
+} // namespace gateio
+} // namespace gateway
+} // namespace singular
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <nlohmann/json.hpp>
+
+#include "SeqLock.h"
+
+namespace singular {
+namespace gateway {
+namespace gateio {
+
+// Perpetual contract state decoded from futures.tickers
+struct FundingRecord {
+    double funding_rate = 0.0;
+    double funding_rate_indicative = 0.0;
+    double mark_price = 0.0;
+    double index_price = 0.0;
+    double last_price = 0.0;
+    double open_interest = 0.0;          // total_size, in contracts
+    int64_t next_funding_time_ms = 0;
+    int64_t exchange_time_ms = 0;
+    int64_t receive_time_ns = 0;
+};
+
+// Per-contract FundingRecords keyed by internal symbol ("BTC_USDT@FUTURE").
+// Readers go through a SeqLock and never block the feed. The change callback fires
+// on the feed thread only when a value actually moved, not on every ticker push.
+class FundingTable {
+public:
+    using ChangeCallback = std::function<void(const std::string& symbol, const FundingRecord& record)>;
+
+    class Entry {
+    public:
+        FundingRecord read() const { return record_.read(); }
+        uint64_t version() const { return record_.version(); }
+
+    private:
+        friend class FundingTable;
+
+        std::string symbol_;
+        SeqLock<FundingRecord> record_;
+        // Writer-side state
+        int64_t funding_interval_ms_ = 0;
+        int64_t funding_anchor_ms_ = 0;
+        std::atomic<uint64_t> pushes_{0};
+        std::atomic<uint64_t> changes_{0};
+    };
+
+    // Must be set before the feeds start
+    void set_change_callback(ChangeCallback callback) { on_change_ = std::move(callback); }
+
+    // Creates the entry on first use, seeding the funding schedule from the instrument catalog
+    Entry* entry(const std::string& symbol);
+    bool read(const std::string& symbol, FundingRecord& out) const;
+
+    // Applies one ticker push; fields missing from the push keep their previous value.
+    // The record, and its timestamps, are only rewritten when a value changed.
+    void on_ticker(Entry& entry, const nlohmann::json& ticker, int64_t exchange_time_ms, int64_t receive_time_ns);
+
+    nlohmann::json get_stats() const;
+
+private:
+    int64_t next_funding_time(const Entry& entry, int64_t now_ms) const;
+
+    ChangeCallback on_change_;
+    mutable std::mutex entries_mutex_;
+    std::unordered_map<std::string, std::unique_ptr<Entry>> entries_;
+};
+
+} // namespace gateio
+} // namespace gateway
+} // namespace singular
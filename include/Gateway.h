@@ -1,5 +1,8 @@
 #pragma once
 
+#include <array>
+#include <deque>
+#include <mutex>
 #include <string_view>
 #include <thread>
 #include <nlohmann/json.hpp>
@@ -26,6 +29,29 @@
 #include <gateway/include/AbstractGateway_V2.h>
 #include <singular/utility/include/RedisHelper.h>
 #include "ErrorCodes.h"
+#include "Config.h"
+#include "PublicFeedHandler.h"
+#include "MarketDataConflator.h"
+#include "SubscriptionManager.h"
+#include "PublicConnectionPool.h"
+#include "InstrumentCatalog.h"
+#include "MarketDataHub.h"
+#include "OrderRoute.h"
+#include "BookProfile.h"
+#include "FeedArbiter.h"
+#include "FeedCapture.h"
+#include "MarketSnapshot.h"
+#include "FundingTable.h"
+#include "GatewayHealth.h"
+#include "ClockEstimator.h"
+#include "Heartbeat.h"
+#include "Reconnector.h"
+#include "RedundantSessions.h"
+#include "PrivateOrderTable.h"
+#include "SendQueue.h"
+#include "FeedLoop.h"
+#include "SpscQueue.h"
+#include "WsClient.h"
 
 namespace singular {
 namespace gateway {
@@ -40,7 +66,7 @@ public:
             const std::string& secret,
             const std::string& passphrase,
             const std::string& mode);
-
+    ~Gateway();
 
     void initialize_callback_funcs();
     void do_place(singular::types::Symbol symbol, singular::types::InstrumentType type,
@@ -63,6 +89,7 @@ public:
     void do_subscribe_trades(std::vector<singular::types::Symbol>& symbols);
     void do_unsubscribe_trades(std::vector<singular::types::Symbol>& symbols);
     void do_subscribe_funding(std::vector<singular::types::Symbol>& symbols);
+    void do_unsubscribe_funding(std::vector<singular::types::Symbol>& symbols);
     singular::types::GatewayStatus status();
     std::string getCurrentTimestamp();
     std::string iso_timestamp();
@@ -79,22 +106,121 @@ public:
     void unset_order_execution_quality_channel_status(std::string session_id);
     nlohmann::json get_orderbook_data();
     nlohmann::json get_last_trades_data();
+    // Pulls decoded books from the conflation stage; nothing is queued for this gateway until the first call
+    size_t drain_market_data(const MarketDataConflator::Consumer& consumer);
+    nlohmann::json get_conflation_stats();
+    nlohmann::json get_public_connection_stats();
+    // A/B feed lines (GATEIO_FEED_AB): per-line win rates, gap fills and first-to-duplicate lead per slot
+    nlohmann::json get_feed_arbitration_stats();
+    // Switches the order book stream of an internal symbol ("BTC_USDT@SPOT") at runtime,
+    // e.g. "delta:20ms:20" or "obu:400"; an empty profile falls back to the default
+    bool set_book_profile(const std::string& symbol, const std::string& profile);
+    nlohmann::json get_book_profiles();
+    nlohmann::json get_capture_stats();
+    // Latest top of book with microprice, imbalance, spread and rolling VWAP for an internal symbol
+    bool read_market_snapshot(const std::string& symbol, MarketSnapshot& snapshot);
+    // Stable handle for hot readers; entry->read() never blocks the feed
+    const MarketSnapshotTable::Entry* market_snapshot_entry(const std::string& symbol);
+    nlohmann::json get_market_snapshot_stats();
+    // Spot vs perpetual best bid/offer and basis for an asset such as "BTC_USDT",
+    // recomputed whenever either leg's top of book moves
+    bool read_basis(const std::string& asset, BasisRecord& record);
+    nlohmann::json get_basis_stats();
+    // Funding rate, next funding time, mark/index price and open interest per perpetual.
+    // The callback runs on the feed thread when a value changes; set it before the feeds start.
+    void set_funding_callback(FundingTable::ChangeCallback callback);
+    bool read_funding(const std::string& symbol, FundingRecord& record);
+    nlohmann::json get_funding_stats();
+    // Exchange clock offset, ping RTT and one-way latency per public connection and private session
+    nlohmann::json get_clock_stats();
+    // Ping RTT percentiles and stale detections of every socket
+    nlohmann::json get_heartbeat_stats();
+    // Reconnect state, attempts and disconnect-to-data-restored times of every socket
+    nlohmann::json get_reconnect_stats();
+    // Fires once, on the thread that completed the last needed socket (public pools open,
+    // private futures logged in); set it before the gateway starts connecting
+    void set_ready_callback(std::function<void()> callback) { ready_callback_ = std::move(callback); }
+    bool is_ready() const { return ready_; }
+    nlohmann::json get_readiness_stats();
+    // UP / DEGRADED / DOWN with the faulted components and recent transitions. The callback
+    // runs on the thread that caused a transition; set it before the gateway starts connecting.
+    // The order sessions are this gateway's own, the feeds are the shared hub's
+    GatewayHealth::State health() const;
+    void set_health_callback(GatewayHealth::TransitionCallback callback) { health_.set_transition_callback(std::move(callback)); }
+    nlohmann::json get_health_stats();
+    // Hot-standby futures order sessions: per-session RTT, sends, first-response wins and dropped duplicates
+    nlohmann::json get_order_session_stats();
+    // Frames, loop wakeups and writer calls per socket send path, see GATEIO_SEND_COALESCING
+    nlohmann::json get_send_stats();
+    // Websocket transport per socket (epoll or io_uring, see GATEIO_URING_CONNECTIONS); the
+    // io_uring client adds reads, writes, submits, wakeups and its last connect phases
+    nlohmann::json get_transport_stats();
+    // Process-wide TLS session tickets per endpoint: offered, resumed and rejected, and full
+    // vs resumed handshake times, see GATEIO_TLS_SESSION_CACHE
+    nlohmann::json get_tls_session_stats();
+    // Live orders shared by the order-entry and stream sessions: acks, pushes and pushes that
+    // overtook their ack, see GATEIO_PRIVATE_STREAM_SESSION, and private frames that found the
+    // engine's inbox full
+    nlohmann::json get_private_order_stats();
+    // Construction time, resident memory before and after it, and which sessions and markets are
+    // connected, see GATEIO_LAZY_CONNECT. Memory is process-wide, so other gateways built at the
+    // same time show up in the delta.
+    nlohmann::json get_startup_stats();
+    // Process-wide public feed hub: attached gateways and how many share each subscription
+    nlohmann::json get_market_data_hub_stats();
+    // Feeds one frame to the handler that owns the named connection, as the socket callback
+    // would; used to replay captures without a network. Private connections are recorded as
+    // "<connection>@<gateway name>", e.g. "GATEIO_PRIVATE_FUTURES@acct1", since the capture is
+    // shared by every gateway on the hub
+    void dispatch_frame(const std::string& connection, const std::string& frame);
+
+    static constexpr const char* PRIVATE_SPOT_CONNECTION = "GATEIO_PRIVATE_SPOT";
+    static constexpr const char* PRIVATE_FUTURES_CONNECTION = "GATEIO_PRIVATE_FUTURES";
+    static constexpr const char* PRIVATE_FUTURES_STREAM_CONNECTION = "GATEIO_PRIVATE_FUTURES_STREAM";
     void send_final_latency_info(singular::types::AlgorithmId algo_id, char* credential_id);
     void close_private_socket();
     void close_public_socket();
     void purge();
     bool is_purged() const { return is_purged_; }
 private:
-    void subscribe_fills();
+    // futures.orders / futures.usertrades (or the spot pair) on the session that carries the pushes
+    void subscribe_fills(SendQueue* sender, bool spot);
     void unsubscribe_fills();
+    std::string private_subscription_frame(const std::string& channel, const std::string& event, const nlohmann::json& payload);
+    void handle_private_push(const nlohmann::json& message);
     void login_spot_private();
     void login_futures_private();
     void run_private_spot_ws();
     void run_private_futures_ws();
+    void connect_private_spot();
+    void connect_private_futures();
+    void connect_private_stream();
     void run_public_ws_spot();
     void run_public_ws_futures_btc();
     void run_public_ws_futures_usdt();
     void login_public();
+    void expect_ready(unsigned parts);
+    void mark_ready(unsigned part);
+    void announce_ready();
+    // GATEIO_LAZY_CONNECT: an order session connects with its first request and closes when idle
+    void start_private_session(size_t session);
+    void stop_private_session(size_t session, const std::string& reason);
+    void flush_deferred_requests(size_t session);
+    void reap_idle_sessions();
+    // Stops the order sessions' timers and closes their sockets, each on its own loop
+    void shutdown_sessions();
+    std::string capture_name(const char* connection) const;
+    std::vector<hv::EventLoopPtr> make_feed_loops(const std::string& group, size_t count, const char* cpu_env, hv::EventLoopPtr& executor);
+    void enqueue_private(size_t source, SpscQueue<std::string>& inbox, const std::string& message);
+    bool accept_private(size_t source, const std::string& message);
+    // Cancels are broadcast to every futures session; false when the frame was refused for backpressure
+    bool send_order_request(const OrderRoute& route, const char* channel, const std::string& req_id, const std::string& frame, SendQueue::Priority priority);
+    bool send_futures_request(const std::string& channel, const std::string& req_id, const std::string& frame, SendQueue::Priority priority);
+    // A place refused before it reached the wire: order_reject on the order channel, and dropped from the order tables
+    void reject_place(singular::types::OrderId order_id, const std::string& reason);
+    std::string futures_login_frame(const std::string& req_id);
+    void drain_private_inbox();
+    void schedule_private_drain();
     unsigned long long get_client_id(singular::types::OrderId order_id);
     void parse_websocket_private(const std::string& buffer);
     void stream_order_data(nlohmann::json message, const std::string order_state);
@@ -112,12 +238,111 @@ private:
     const char* public_futures_btc_url;
     bool sim_trading;
 
+    // Public feeds are decoded once per process by the shared hub, which publishes every book
+    // into this gateway's conflation stage; the hub outlives this gateway's socket loops
+    std::shared_ptr<MarketDataConflator> md_conflator_;
+    std::shared_ptr<MarketDataHub> hub_;
+    size_t hub_id_ = MarketDataHub::MAX_OWNERS;
+
+    // Clock offset and latency of the private sessions
+    ClockEstimator private_spot_clock_{PRIVATE_SPOT_CONNECTION};
+    ClockEstimator private_futures_clock_{PRIVATE_FUTURES_CONNECTION};
+    ClockEstimator private_stream_clock_{PRIVATE_FUTURES_STREAM_CONNECTION};
+    std::unique_ptr<Heartbeat> private_spot_heartbeat_;
+    std::unique_ptr<Heartbeat> private_futures_heartbeat_;
+    std::unique_ptr<Heartbeat> private_stream_heartbeat_;
+    std::unique_ptr<Reconnector> private_spot_reconnect_;
+    std::unique_ptr<Reconnector> private_futures_reconnect_;
+    std::unique_ptr<Reconnector> private_stream_reconnect_;
+    // Optional standby futures order sessions; responses are deduplicated against the primary (source 0)
+    static constexpr size_t PRIMARY_SOURCE = 0;
+    std::unique_ptr<RedundantSessions> futures_standby_;
+
+    // Optional raw frame capture, owned by the hub; ids are per private session
+    FeedCapture* capture_ = nullptr;
+    uint16_t private_spot_capture_id_ = FeedCapture::MAX_CONNECTIONS;
+    uint16_t private_futures_capture_id_ = FeedCapture::MAX_CONNECTIONS;
+    uint16_t private_stream_capture_id_ = FeedCapture::MAX_CONNECTIONS;
+
+    // Startup readiness, one bit per socket that has to be up
+    static constexpr unsigned READY_PUBLIC_SPOT = 1;
+    static constexpr unsigned READY_PUBLIC_FUTURES_USDT = 2;
+    static constexpr unsigned READY_PUBLIC_FUTURES_BTC = 4;
+    static constexpr unsigned READY_PRIVATE_SPOT = 8;
+    static constexpr unsigned READY_PRIVATE_FUTURES = 16;
+    static constexpr unsigned READY_PRIVATE_STREAM = 32;
+    std::atomic<unsigned> ready_needed_{0};
+    std::atomic<unsigned> ready_seen_{0};
+    std::atomic<bool> ready_{false};
+    int64_t ready_start_ns_ = 0;
+    std::atomic<int64_t> ready_time_ns_{0};
+    std::function<void()> ready_callback_;
+
+    // Lazily connected order sessions (GATEIO_LAZY_CONNECT), indexed by session. Requests sent
+    // before the session has logged in wait here and go out with the login. Engine loop only.
+    static constexpr size_t FUTURES_SESSION = 0;
+    static constexpr size_t SPOT_SESSION = 1;
+    static constexpr size_t MAX_DEFERRED_REQUESTS = 1024;
+    struct DeferredRequest {
+        const OrderRoute* route;
+        const char* channel;
+        std::string req_id;
+        std::string frame;
+        SendQueue::Priority priority;
+    };
+    bool lazy_connect_ = false;
+    int64_t idle_timeout_ns_ = 0;
+    hv::TimerID idle_timer_ = INVALID_TIMER_ID;
+    std::array<bool, 2> session_started_{};
+    std::array<int64_t, 2> session_last_use_ns_{};
+    std::array<uint64_t, 2> session_starts_{};
+    std::array<uint64_t, 2> session_idle_closes_{};
+    std::array<std::vector<DeferredRequest>, 2> deferred_requests_;
+
+    // Cost of constructing this gateway
+    int64_t construct_ns_ = 0;
+    int64_t rss_before_bytes_ = 0;
+    int64_t rss_after_bytes_ = 0;
+
+    // Private frames are handed from the socket loops to the engine loop through these
+    static constexpr size_t PRIVATE_INBOX_SIZE = 4096;
+    SpscQueue<std::string> private_futures_inbox_{PRIVATE_INBOX_SIZE};
+    SpscQueue<std::string> private_spot_inbox_{PRIVATE_INBOX_SIZE};
+    SpscQueue<std::string> private_stream_inbox_{PRIVATE_INBOX_SIZE};
+    std::atomic<bool> private_drain_scheduled_{false};
+    // Frames that found their inbox full, with their source; drained after the inboxes
+    std::mutex private_overflow_mutex_;
+    std::deque<std::pair<size_t, std::string>> private_overflow_;
+    std::atomic<bool> private_overflow_pending_{false};
+    std::atomic<uint64_t> private_overflows_{0};
+
+    // Login and heartbeat state of the order sessions; status() reads it
+    GatewayHealth health_{"GATEIO"};
+    // Live orders of the order-entry and stream sessions
+    PrivateOrderTable private_orders_;
+    // Channel, contract string and session per traded symbol, resolved on the first order
+    OrderRouteTable order_routes_;
+
+    // Dedicated event loop threads must outlive every socket that runs on them;
+    // everything their callbacks touch is declared above so it outlives the threads.
+    // ~Gateway shuts the sessions down on their loops and stops the loops before any
+    // member is destroyed.
+    std::vector<std::unique_ptr<FeedLoop>> feed_loops_;
+    hv::EventLoopPtr private_spot_loop_;
+    hv::EventLoopPtr private_futures_loop_;
+    hv::EventLoopPtr private_stream_loop_;
+    hv::EventLoopPtr engine_loop_;
+    bool dedicated_loops_ = true;
+
     std::unique_ptr<singular::network::WebsocketClient> public_client_;
-    std::unique_ptr<singular::network::WebsocketClient> public_client_spot;
-    std::unique_ptr<singular::network::WebsocketClient> public_client_futures_usdt;
-    std::unique_ptr<singular::network::WebsocketClient> public_client_futures_btc;
-    std::unique_ptr<singular::network::WebsocketClient> private_spot_client_;
-    std::unique_ptr<singular::network::WebsocketClient> private_futures_client_;
+    std::unique_ptr<WsClient> private_spot_client_;
+    std::unique_ptr<WsClient> private_futures_client_;
+    // Optional futures session that only carries the order and usertrade pushes
+    std::unique_ptr<WsClient> private_stream_client_;
+    // Order and login frames go through these; pings go straight to the clients
+    std::unique_ptr<SendQueue> private_spot_send_;
+    std::unique_ptr<SendQueue> private_futures_send_;
+    std::unique_ptr<SendQueue> private_stream_send_;
     std::unique_ptr<singular::network::WebsocketClient> private_client_;
     std::string orderbook_channel_ = "futures.order_book_update";
     std::string ticker_channel_ = "futures.tickers";
@@ -125,7 +350,17 @@ private:
     std::string book_ticker_channel_ = "futures.book_ticker";
 
     bool authenticate_;
-    bool authenticated_ = {false};
+    // Login state per order session, written on the session loops and the engine loop
+    std::atomic<bool> spot_authenticated_{false};
+    std::atomic<bool> futures_authenticated_{false};
+    // Logged in on at least one order session
+    bool authenticated() const { return spot_authenticated_ || futures_authenticated_; }
+    std::atomic<bool> stream_authenticated_{false};
+    bool private_spot_enabled_ = false;
+    // Login req_id of the stream session, so its login response is told apart from the order session's
+    std::string stream_login_id_;
+    // Account uid from the futures login response, needed by the futures push subscriptions
+    std::string user_id_;
     bool is_purged_ = { false };
     bool login_flag_= {false};
 
@@ -138,14 +373,6 @@ private:
     nlohmann::json account_info;
     nlohmann::json session_map = nlohmann::json::array();
 
-    singular::types::GatewayStatus private_status_ = {singular::types::GatewayStatus::OFFLINE};
-    singular::types::GatewayStatus public_status_ = {singular::types::GatewayStatus::OFFLINE};
-
-    singular::types::GatewayStatus private_spot_status_ = {singular::types::GatewayStatus::OFFLINE};
-    singular::types::GatewayStatus public_spot_status_ = {singular::types::GatewayStatus::OFFLINE};
-    singular::types::GatewayStatus private_futures_status_ = {singular::types::GatewayStatus::OFFLINE};
-    singular::types::GatewayStatus public_futures_status_ = {singular::types::GatewayStatus::OFFLINE};
-
     std::map<unsigned long int, singular::types::Symbol> client_id_to_symbol_map_;
     std::map<unsigned long int, singular::types::OrderId> client_to_internal_id_map_;
     std::map<unsigned long int, singular::types::RequestSource> client_id_to_source_map_;
@@ -170,7 +397,7 @@ private:
     std::unordered_map<singular::types::OrderId, std::string> internal_to_credential_id_map_;
     //std::unordered_map<std::string, double> symbol_volume_map_;
     std::unordered_map<singular::types::Symbol, double> symbol_volume_map_;
-    std::unordered_map<singular::types::OrderId, singular::types::InstrumentType> internal_to_type_map_;
+    std::unordered_map<singular::types::OrderId, const OrderRoute*> internal_to_route_map_;
 
     void initializeMaps();
 
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <nlohmann/json.hpp>
+
+namespace singular {
+namespace gateway {
+namespace gateio {
+
+// Aggregated gateway health in one atomic word: the low 32 bits hold the fault of every
+// component, bits 32-39 the derived state and the high bits count transitions.
+//   UP        no watched component faulted
+//   DEGRADED  only non-critical faults (a public socket down, books invalid after a gap)
+//   DOWN      a critical component faulted (the private order session closed, stale or logged out)
+// Components report with set_fault from their own threads; state() and can_trade() are a
+// single relaxed load so they can sit in front of every order. State changes are logged and
+// handed to the transition callback on the thread that caused them.
+class GatewayHealth {
+public:
+    enum class State : uint8_t { DOWN = 0, DEGRADED = 1, UP = 2 };
+
+    // Component bits
+    static constexpr uint32_t PUBLIC_SPOT = 1;
+    static constexpr uint32_t PUBLIC_FUTURES_USDT = 2;
+    static constexpr uint32_t PUBLIC_FUTURES_BTC = 4;
+    static constexpr uint32_t PRIVATE_SPOT = 8;
+    static constexpr uint32_t PRIVATE_FUTURES = 16;
+    static constexpr uint32_t BOOKS = 32;
+    static constexpr uint32_t PRIVATE_FUTURES_STREAM = 64;
+    // Highest component bit; keep in step when adding one
+    static constexpr uint32_t LAST_COMPONENT = PRIVATE_FUTURES_STREAM;
+
+    struct Transition {
+        State from;
+        State to;
+        uint32_t component;      // bit whose change caused the transition
+        std::string reason;
+        int64_t time_ns;         // wall clock
+    };
+
+    using TransitionCallback = std::function<void(const Transition&)>;
+
+    explicit GatewayHealth(const std::string& name);
+
+    // Components that count, and which of them take the gateway DOWN. Watched connection
+    // components start faulted and clear once they report up.
+    void watch(uint32_t components, uint32_t critical);
+    // Set before the sockets start
+    void set_transition_callback(TransitionCallback callback) { on_transition_ = std::move(callback); }
+
+    void set_fault(uint32_t component, bool fault, const std::string& reason);
+    // Starts or stops watching one component, e.g. a socket connected on first use and closed when
+    // idle. A newly watched component is faulted until it reports up; an unwatched one is cleared.
+    void set_watched(uint32_t component, bool watched, bool critical, const std::string& reason);
+    // Per-symbol book validity, the BOOKS component is faulted while any book is invalid
+    void on_book_validity(bool valid);
+
+    State state() const { return state_of(word_.load(std::memory_order_relaxed)); }
+    bool can_trade() const { return state() != State::DOWN; }
+    uint32_t faults() const { return static_cast<uint32_t>(word_.load(std::memory_order_relaxed)); }
+
+    static const char* to_string(State state);
+    static const char* component_name(uint32_t component);
+    nlohmann::json get_stats() const;
+
+private:
+    static constexpr size_t MAX_HISTORY = 32;
+
+    static State state_of(uint64_t word) { return static_cast<State>((word >> 32) & 0xff); }
+    State classify(uint32_t faults) const;
+
+    std::string name_;
+    std::atomic<uint32_t> watched_{0};
+    std::atomic<uint32_t> critical_{0};
+    std::atomic<uint64_t> word_;
+    std::atomic<int64_t> invalid_books_{0};
+    TransitionCallback on_transition_;
+
+    mutable std::mutex history_mutex_;
+    std::deque<Transition> history_;
+};
+
+} // namespace gateio
+} // namespace gateway
+} // namespace singular
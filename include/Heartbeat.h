@@ -0,0 +1,97 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <nlohmann/json.hpp>
+
+#include <singular/network/network/include/WebsocketClient.h>
+#include "ClockEstimator.h"
+#include "LatencyHistogram.h"
+
+namespace singular {
+namespace gateway {
+namespace gateio {
+
+// Application-level ping for one socket. Sends spot.ping / futures.ping on the socket's
+// event loop, measures the round trip of every pong and declares the connection stale
+// when a pong is overdue, RTT stays above the threshold or nothing at all arrives for
+// too long. Pings carry their wall-clock send time as id, which Gate.io echoes back; the
+// round trip is timed on the steady clock against the send time kept for that id, and the
+// wall-clock id only feeds the clock offset sample.
+// start/stop/on_frame run on the socket's loop; stats may be read from any thread.
+class Heartbeat {
+public:
+    struct Options {
+        int interval_ms = 5000;          // 0 disables the heartbeat
+        int stale_rtt_ms = 2000;         // pong overdue, or this slow for slow_pings in a row
+        int stale_silence_ms = 15000;    // no frame of any kind
+        int slow_pings = 3;
+    };
+
+    using SendFunction = std::function<void(const std::string&)>;
+    using StaleCallback = std::function<void(const std::string& reason)>;
+
+    Heartbeat(hv::EventLoopPtr loop, const std::string& name, const char* ping_channel, SendFunction send, const Options& options);
+    ~Heartbeat();
+
+    // Pong round trips are also offset samples for clock; set before start
+    void set_clock(ClockEstimator* clock) { clock_ = clock; }
+    // Fires once per connection lifetime, on the socket's loop
+    void set_stale_callback(StaleCallback callback) { on_stale_ = std::move(callback); }
+
+    void start();
+    void stop();
+    // Every received frame; returns true when it was a pong
+    bool on_frame(const std::string& frame);
+
+    bool stale() const { return stale_; }
+    // EWMA of pong round trips (gain 1/8), 0 before the first pong
+    int64_t smoothed_rtt_ns() const { return smoothed_rtt_ns_; }
+    const std::string& name() const { return name_; }
+    nlohmann::json get_stats() const;
+
+private:
+    void tick();
+    void declare_stale(const std::string& reason);
+
+    hv::EventLoopPtr loop_;
+    std::string name_;
+    std::string ping_channel_;
+    SendFunction send_;
+    Options options_;
+    ClockEstimator* clock_ = nullptr;
+    StaleCallback on_stale_;
+
+    struct SentPing {
+        int64_t id = 0;                  // wall-clock send time, echoed in the pong
+        int64_t send_ns = 0;             // steady clock
+    };
+    static constexpr size_t SENT_PINGS = 4;
+
+    // Loop-side state
+    hv::TimerID timer_ = INVALID_TIMER_ID;
+    int64_t last_frame_ns_ = 0;
+    std::array<SentPing, SENT_PINGS> sent_{};
+    size_t next_sent_ = 0;
+    int64_t outstanding_id_ = 0;         // 0 when no ping is in flight
+    int64_t outstanding_send_ns_ = 0;    // steady clock
+    int slow_in_row_ = 0;
+    std::string frame_buffer_;
+
+    std::atomic<bool> stale_{false};
+    std::atomic<uint64_t> pings_sent_{0};
+    std::atomic<uint64_t> pongs_{0};
+    std::atomic<uint64_t> stale_events_{0};
+    std::atomic<int64_t> last_rtt_ns_{0};
+    std::atomic<int64_t> smoothed_rtt_ns_{0};
+    mutable std::mutex rtt_mutex_;
+    LatencyHistogram rtt_;
+    std::string last_stale_reason_;
+};
+
+} // namespace gateio
+} // namespace gateway
+} // namespace singular
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <nlohmann/json.hpp>
+
+namespace singular {
+namespace gateway {
+namespace gateio {
+
+struct CatalogEntry {
+    std::string symbol;           // exchange name, e.g. BTC_USDT
+    std::string instrument_type;  // SPOT, LINEAR_PERPETUAL, INVERSE_PERPETUAL, ...
+    std::string base;
+    std::string quote;
+    std::string settle;           // settle currency for derivatives (usdt, btc), empty for spot
+    int64_t funding_interval_s = 0;   // perpetuals only
+    int64_t funding_next_apply_s = 0; // next funding as of the REST fetch
+};
+
+// Process-wide view of the Gate.io instruments fetched over REST at startup.
+// Entries are keyed by the internal symbol form: BTC_USDT@SPOT, BTC_USD@FUTURE,
+// BTC_USDT_20250328@DELIVERY, BTC_USDT-20250328-50000-C@OPTION.
+class InstrumentCatalog {
+public:
+    static InstrumentCatalog& instance();
+
+    // Accepts the "instruments" array built by the get_gateio_*_instruments helpers
+    void load(const nlohmann::json& instruments);
+
+    bool find(const std::string& internal_symbol, CatalogEntry& entry) const;
+    std::string settle_of(const std::string& internal_symbol) const;
+    size_t size() const;
+
+    static std::string market_suffix(const std::string& instrument_type);
+
+private:
+    InstrumentCatalog() = default;
+
+    mutable std::shared_mutex mutex_;
+    std::unordered_map<std::string, CatalogEntry> entries_;
+};
+
+} // namespace gateio
+} // namespace gateway
+} // namespace singular
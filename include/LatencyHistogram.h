@@ -0,0 +1,102 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <nlohmann/json.hpp>
+
+namespace singular {
+namespace gateway {
+namespace gateio {
+
+// Log-linear histogram of nanosecond values: 16 linear sub-buckets per power of two,
+// so any recorded value is reported within ~6%. Fixed size, no allocation, not thread safe.
+class LatencyHistogram {
+public:
+    void record(uint64_t value)
+    {
+        ++counts_[bucket_of(value)];
+        ++count_;
+        sum_ += value;
+        min_ = std::min(min_, value);
+        max_ = std::max(max_, value);
+    }
+
+    void merge(const LatencyHistogram& other)
+    {
+        for (size_t i = 0; i < BUCKETS; ++i)
+            counts_[i] += other.counts_[i];
+        count_ += other.count_;
+        sum_ += other.sum_;
+        min_ = std::min(min_, other.min_);
+        max_ = std::max(max_, other.max_);
+    }
+
+    void reset() { *this = LatencyHistogram(); }
+
+    uint64_t count() const { return count_; }
+    double mean() const { return count_ ? static_cast<double>(sum_) / count_ : 0.0; }
+
+    // Lower bound of the bucket holding the given quantile (0..1)
+    uint64_t percentile(double quantile) const
+    {
+        if (count_ == 0)
+            return 0;
+        if (quantile >= 1.0)
+            return max_;
+        uint64_t rank = static_cast<uint64_t>(quantile * (count_ - 1)) + 1;
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BUCKETS; ++i) {
+            seen += counts_[i];
+            if (seen >= rank)
+                return std::max(min_, std::min(max_, lower_bound_of(i)));
+        }
+        return max_;
+    }
+
+    nlohmann::json to_json() const
+    {
+        return {{"count", count_},
+                {"mean", mean()},
+                {"min", count_ ? min_ : 0},
+                {"p50", percentile(0.50)},
+                {"p90", percentile(0.90)},
+                {"p99", percentile(0.99)},
+                {"p999", percentile(0.999)},
+                {"max", max_}};
+    }
+
+private:
+    static constexpr size_t SUB_BITS = 4;
+    static constexpr size_t SUB_BUCKETS = 1 << SUB_BITS;
+    static constexpr size_t BUCKETS = 64 * SUB_BUCKETS;
+
+    static size_t bucket_of(uint64_t value)
+    {
+        if (value < SUB_BUCKETS)
+            return static_cast<size_t>(value);
+        size_t exponent = 63 - __builtin_clzll(value);
+        size_t mantissa = (value >> (exponent - SUB_BITS)) & (SUB_BUCKETS - 1);
+        return (exponent - SUB_BITS + 1) * SUB_BUCKETS + mantissa;
+    }
+
+    static uint64_t lower_bound_of(size_t bucket)
+    {
+        if (bucket < SUB_BUCKETS)
+            return bucket;
+        size_t exponent = bucket / SUB_BUCKETS + SUB_BITS - 1;
+        uint64_t mantissa = bucket % SUB_BUCKETS;
+        return (SUB_BUCKETS + mantissa) << (exponent - SUB_BITS);
+    }
+
+    std::array<uint64_t, BUCKETS> counts_{};
+    uint64_t count_ = 0;
+    uint64_t sum_ = 0;
+    uint64_t min_ = std::numeric_limits<uint64_t>::max();
+    uint64_t max_ = 0;
+};
+
+} // namespace gateio
+} // namespace gateway
+} // namespace singular
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#include "BookState.h"
+#include "SpscQueue.h"
+
+namespace singular {
+namespace gateway {
+namespace gateio {
+
+// Sits between the public feed handlers and the market data consumer.
+// With conflation enabled only the latest BookState per symbol is kept together with
+// a dirty flag, so a consumer that falls behind jumps straight to the current book.
+// With conflation disabled every update is queued and delivered in order.
+//
+// Each feed thread publishes through its own Producer, which owns single-producer
+// queues towards the consumer, so no lock is shared between feed threads.
+// Nothing is queued until the first consume() call: a gateway whose books are never drained
+// does not fill its queues.
+class MarketDataConflator {
+    struct Slot;
+
+public:
+    using Consumer = std::function<void(const BookState&)>;
+
+    static constexpr size_t MAX_PRODUCERS = 64;
+    // Symbols a producer can have waiting at once; one more waits for its next update
+    static constexpr size_t READY_CAPACITY = 4096;
+    // Queued updates per producer without conflation; beyond that a symbol falls back to conflation
+    static constexpr size_t PASS_THROUGH_CAPACITY = 1024;
+
+    class Producer {
+    public:
+        // Called from the owning feed thread only
+        void publish(const BookState& state);
+
+    private:
+        friend class MarketDataConflator;
+
+        struct QueuedState {
+            BookState state;
+            int64_t published_ns = 0;
+            Slot* slot = nullptr;
+        };
+
+        explicit Producer(MarketDataConflator& owner);
+        void mark_dirty(Slot& slot, const BookState& state, int64_t published_ns);
+
+        MarketDataConflator& owner_;
+        std::unordered_map<std::string, Slot*> slot_cache_;
+        SpscQueue<QueuedState> backlog_;
+        SpscQueue<Slot*> ready_;
+    };
+
+    explicit MarketDataConflator(bool enabled);
+
+    bool enabled() const { return enabled_; }
+    bool consumer_attached() const { return consumer_attached_.load(std::memory_order_relaxed); }
+
+    // Registers one feed thread; the returned producer lives as long as the conflator
+    Producer* add_producer();
+
+    // Consumer side, returns the number of book states delivered. The first call starts publication.
+    size_t consume(const Consumer& consumer);
+
+    nlohmann::json get_stats() const;
+
+private:
+    struct Slot {
+        std::atomic_flag lock = ATOMIC_FLAG_INIT;
+        BookState state;
+        bool dirty = false;
+        int64_t pending_since_ns = 0; // publish time of the oldest undelivered update
+        uint64_t delivered_update_id = 0;
+        uint64_t published = 0;
+        uint64_t delivered = 0;
+        uint64_t conflated = 0;       // updates overwritten before the consumer saw them
+        uint64_t overflowed = 0;      // pass-through updates that fell back to conflation
+        int64_t last_lag_ns = 0;
+        int64_t max_lag_ns = 0;
+
+        void acquire() { while (lock.test_and_set(std::memory_order_acquire)) {} }
+        void release() { lock.clear(std::memory_order_release); }
+    };
+
+    Slot* slot_for(const std::string& symbol);
+    static void record_lag(Slot& slot, int64_t lag_ns);
+    bool deliver(Slot& slot, const BookState& state, int64_t published_ns);
+
+    bool enabled_;
+    std::atomic<bool> consumer_attached_{false};
+
+    mutable std::mutex slots_mutex_;  // only taken when a producer meets a new symbol
+    std::unordered_map<std::string, std::unique_ptr<Slot>> slots_;
+
+    std::mutex producers_mutex_;      // only taken by add_producer
+    std::vector<std::unique_ptr<Producer>> owned_producers_;
+    std::array<std::atomic<Producer*>, MAX_PRODUCERS> producers_{};
+    std::atomic<size_t> producer_count_{0};
+
+    BookState consume_scratch_;
+};
+
+} // namespace gateio
+} // namespace gateway
+} // namespace singular
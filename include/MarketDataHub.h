@@ -0,0 +1,206 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#include <singular/network/network/include/WebsocketClient.h>
+#include "BasisView.h"
+#include "BookProfile.h"
+#include "ClockEstimator.h"
+#include "FeedArbiter.h"
+#include "FeedCapture.h"
+#include "FeedLoop.h"
+#include "FundingTable.h"
+#include "GatewayHealth.h"
+#include "MarketDataConflator.h"
+#include "MarketSnapshot.h"
+#include "PublicConnectionPool.h"
+#include "PublicFeedHandler.h"
+
+namespace singular {
+namespace gateway {
+namespace gateio {
+
+// Process-wide Gate.io public market data, shared by every Gateway instance (one per
+// account). The first gateway to acquire the hub creates the public pools, feed handlers,
+// snapshot, basis and funding tables; the last one to release it tears them down.
+// Subscriptions are reference counted per owner and stream, so a symbol is subscribed
+// once and every frame is decoded once, however many accounts want it. Decoded books are
+// fanned out to the conflator of every attached owner.
+// With GATEIO_LAZY_CONNECT a market's sockets open with its first subscription and close
+// again once it has had none for GATEIO_IDLE_TIMEOUT_MS.
+// Public methods may be called from any thread.
+class MarketDataHub {
+public:
+    enum Market { SPOT = 0, FUTURES_USDT = 1, FUTURES_BTC = 2, MARKETS = 3 };
+    enum class Stream { BOOK, TICKER, TRADES, FUNDING };
+
+    using SplitSymbol = std::pair<std::string, std::string>;   // ("BTC_USDT", "SPOT")
+
+    static constexpr size_t MAX_OWNERS = 64;
+
+    // Returns the live hub with conflator attached as owner, creating the hub when there is none
+    // or the last one has closed. Executor and urls are only used when this call creates it.
+    static std::shared_ptr<MarketDataHub> acquire(hv::EventLoopPtr& executor, const char* spot_url,
+                                                  const char* futures_usdt_url, const char* futures_btc_url,
+                                                  std::shared_ptr<MarketDataConflator> conflator, size_t& owner);
+
+    MarketDataHub(hv::EventLoopPtr& executor, const char* spot_url, const char* futures_usdt_url, const char* futures_btc_url);
+    ~MarketDataHub();
+
+    MarketDataHub(const MarketDataHub&) = delete;
+    MarketDataHub& operator=(const MarketDataHub&) = delete;
+
+    // Registers an owner whose conflator receives every decoded book; returns its owner id,
+    // MAX_OWNERS once the hub has closed or every id is in use. The owner's producers are only
+    // created with its first book subscription.
+    size_t attach(std::shared_ptr<MarketDataConflator> conflator);
+    // Drops the owner's subscriptions, callbacks and producers and frees its id for reuse;
+    // the sockets close with the last owner
+    void detach(size_t owner);
+    bool closed() const { return closed_; }
+    bool lazy() const { return lazy_; }
+
+    // Starts the market's sockets on first use; on_open runs once the market has an open socket
+    void run(size_t owner, Market market, std::function<void()> on_open);
+
+    void subscribe(size_t owner, Stream stream, const std::vector<SplitSymbol>& symbols);
+    void unsubscribe(size_t owner, Stream stream, const std::vector<SplitSymbol>& symbols);
+    bool set_book_profile(const std::string& symbol, const std::string& profile);
+
+    void set_funding_callback(size_t owner, FundingTable::ChangeCallback callback);
+    void dispatch_frame(const std::string& connection, const std::string& frame);
+
+    MarketSnapshotTable& snapshots() { return *market_snapshots_; }
+    BasisView& basis() { return basis_; }
+    FundingTable& funding() { return funding_; }
+    GatewayHealth& health() { return health_; }
+    // Shared with the gateways for their private sessions, nullptr without GATEIO_CAPTURE_DIR
+    FeedCapture* capture() { return capture_.get(); }
+
+    nlohmann::json get_book_stats() const;
+    nlohmann::json get_book_profiles();
+    nlohmann::json get_public_connection_stats() const;
+    nlohmann::json get_feed_arbitration_stats() const;
+    nlohmann::json get_clock_stats() const;
+    nlohmann::json get_heartbeat_stats() const;
+    nlohmann::json get_reconnect_stats() const;
+    nlohmann::json get_capture_stats() const;
+    nlohmann::json get_send_stats() const;
+    nlohmann::json get_transport_stats() const;
+    // Owners and shared subscriptions per stream, and which markets have their sockets open
+    nlohmann::json get_stats();
+
+private:
+    struct MarketState {
+        bool started = false;
+        bool open = false;
+        uint64_t starts = 0;
+        uint64_t idle_closes = 0;
+        std::vector<std::pair<size_t, std::function<void()>>> on_open;
+    };
+
+    struct Ref {
+        Stream stream;
+        SplitSymbol symbol;
+        Market market = MARKETS;
+        std::set<size_t> owners;
+    };
+
+    using Producers = std::array<std::atomic<MarketDataConflator::Producer*>, MAX_OWNERS>;
+
+    static const char* stream_name(Stream stream);
+    static uint32_t health_component(Market market);
+    Market market_of(const SplitSymbol& symbol) const;
+    PublicConnectionPool* pool_for(const SplitSymbol& symbol);
+    SubscriptionManager* subscriptions_for(const SplitSymbol& symbol, bool place);
+    // Hands the market's pool its socket callbacks; once, before any socket opens
+    void bind(Market market);
+    void start(Market market);
+    // Closes the sockets of lazily connected markets that have been without subscriptions too long
+    void reap_idle();
+    // Drops one subscribed stream of the market; called with refs_mutex_ held
+    void release_market(Market market);
+    void publish(size_t feed, const BookState& state);
+    // One producer per feed for owner, on its first book subscription
+    void add_producers(size_t owner);
+    // Returns once no feed thread can still be publishing through a producer taken out before
+    void wait_for_feeds();
+    // Sends the exchange subscription when the first owner arrives / the last one leaves
+    void open_stream(Stream stream, const SplitSymbol& symbol);
+    void close_stream(Stream stream, const SplitSymbol& symbol);
+    bool retain_futures_ticker(const std::string& contract, unsigned user, bool retain);
+    // Called from a feed thread when a book loses its seed (needed) or is seeded again: obu
+    // streams are resubscribed, which starts them with a full book; delta streams get a
+    // snapshot subscription alongside until the snapshot has arrived
+    void resync_book(const std::string& symbol, bool needed);
+
+    std::string log_service_name = "GATEIO";
+    hv::EventLoopPtr executor_;
+    bool dedicated_loops_ = true;
+    bool lazy_ = false;
+    int64_t idle_timeout_ns_ = 0;
+    hv::TimerID idle_timer_ = INVALID_TIMER_ID;
+
+    GatewayHealth health_{"GATEIO_MD"};
+    BasisView basis_;
+    std::unique_ptr<MarketSnapshotTable> market_snapshots_;
+    FundingTable funding_;
+    std::mutex funding_callbacks_mutex_;
+    std::vector<std::pair<size_t, FundingTable::ChangeCallback>> funding_callbacks_;
+
+    // Requested order book profiles and the ones currently subscribed
+    BookProfileTable book_profiles_;
+    std::mutex book_profiles_mutex_;
+    std::unordered_map<std::string, BookProfile> active_book_profiles_;
+    std::unordered_map<std::string, BookProfile> resync_snapshots_;    // snapshot streams seeding a delta book
+
+    // Owners per stream and symbol; futures.tickers is shared by the ticker and funding streams.
+    // Both maps are guarded by refs_mutex_, which is held while the exchange frames are queued.
+    static constexpr unsigned TICKER_USER_TICKERS = 1;
+    static constexpr unsigned TICKER_USER_FUNDING = 2;
+    std::mutex refs_mutex_;
+    std::unordered_map<std::string, Ref> refs_;               // keyed by stream|symbol
+    std::unordered_map<std::string, unsigned> futures_ticker_users_;
+    // Subscribed streams per market and since when a market has had none (0 while it has some)
+    std::array<size_t, MARKETS> market_refs_{};
+    std::array<int64_t, MARKETS> idle_since_ns_{};
+
+    // Owners and the producer each feed publishes through, per owner. A detached owner's
+    // conflator is only released, and its id reused, after every feed loop has run past it.
+    std::mutex owners_mutex_;
+    std::vector<std::shared_ptr<MarketDataConflator>> conflators_;   // by owner id, null when free
+    std::vector<bool> attached_;
+    size_t attached_count_ = 0;
+    std::atomic<bool> closed_{false};
+    std::vector<std::unique_ptr<Producers>> producers_;               // per feed
+    std::atomic<size_t> owner_count_{0};
+
+    std::mutex markets_mutex_;
+    std::array<MarketState, MARKETS> markets_;
+
+    // One decoder per pool slot, one clock per socket
+    std::unordered_map<const PublicConnectionPool*, std::vector<std::unique_ptr<PublicFeedHandler>>> public_feeds_;
+    std::unordered_map<const PublicConnectionPool*, std::vector<std::unique_ptr<FeedArbiter>>> public_arbiters_;
+    std::unordered_map<const PublicConnectionPool*, std::vector<std::unique_ptr<ClockEstimator>>> public_clocks_;
+
+    std::unique_ptr<FeedCapture> capture_;
+    std::unordered_map<const PublicConnectionPool*, std::vector<uint16_t>> capture_ids_;
+
+    // Loop threads outlive the sockets on them; everything their callbacks touch is above
+    std::vector<std::unique_ptr<FeedLoop>> feed_loops_;
+    std::array<std::unique_ptr<PublicConnectionPool>, MARKETS> pools_;
+};
+
+} // namespace gateio
+} // namespace gateway
+} // namespace singular
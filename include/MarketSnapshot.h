@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <nlohmann/json.hpp>
+
+#include "BasisView.h"
+#include "BookState.h"
+#include "LatencyHistogram.h"
+#include "SeqLock.h"
+
+namespace singular {
+namespace gateway {
+namespace gateio {
+
+// Latest top of book and derived microstructure values for one symbol
+struct MarketSnapshot {
+    double bid_price = 0.0;
+    double bid_quantity = 0.0;
+    double ask_price = 0.0;
+    double ask_quantity = 0.0;
+    bool has_top = false;           // both sides quoted; the top of book fields are 0 while not
+    uint64_t update_id = 0;
+    int64_t exchange_time_ms = 0;
+    int64_t receive_time_ns = 0;
+    int64_t latency_ns = 0;         // estimated one-way feed latency of the last book update
+    bool stale = false;             // latency_ns above the table's stale threshold
+    bool book_valid = true;         // no unrecovered sequence gap in the book
+
+    double mid = 0.0;
+    double spread = 0.0;
+    double spread_bps = 0.0;
+    double microprice = 0.0;        // size weighted mid of the best levels
+    double imbalance = 0.0;         // (bid - ask) / (bid + ask) volume over the imbalance depth
+
+    double vwap = 0.0;              // over the trades of the rolling window
+    double vwap_volume = 0.0;
+    uint32_t window_trades = 0;
+    double last_trade_price = 0.0;
+    int64_t last_trade_time_ms = 0;
+};
+
+// Per-symbol MarketSnapshots, updated incrementally from book states and trades and read
+// lock-free through a SeqLock. Writers resolve an Entry once and keep the pointer;
+// entries are never removed, so the pointers stay valid for the table's lifetime.
+class MarketSnapshotTable {
+public:
+    struct Options {
+        size_t imbalance_depth = 5;
+        int64_t vwap_window_ms = 60000;
+        int64_t stale_latency_ns = 0;   // 0 never flags
+    };
+
+    class Entry {
+    public:
+        MarketSnapshot read() const { return snapshot_.read(); }
+        uint64_t version() const { return snapshot_.version(); }
+
+    private:
+        friend class MarketSnapshotTable;
+
+        struct Trade {
+            int64_t time_ms;
+            double price;
+            double quantity;
+        };
+
+        SeqLock<MarketSnapshot> snapshot_;
+        // Writer-side state, only touched inside snapshot_.write()
+        std::deque<Trade> trades_;
+        double window_notional_ = 0.0;
+        double window_volume_ = 0.0;
+        LatencyHistogram book_cost_;  // TSC ticks per update
+        LatencyHistogram trade_cost_;
+        BasisView::Pair* basis_ = nullptr;
+        bool basis_spot_leg_ = false;
+    };
+
+    explicit MarketSnapshotTable(const Options& options);
+
+    // Top-of-book changes are forwarded to basis; set before the feeds start
+    void set_basis_view(BasisView* basis) { basis_ = basis; }
+
+    // Creates the entry on first use
+    Entry* entry(const std::string& symbol);
+    const Entry* find(const std::string& symbol) const;
+    bool read(const std::string& symbol, MarketSnapshot& out) const;
+
+    void on_book(Entry& entry, const BookState& state);
+    void on_trade(Entry& entry, double price, double quantity, int64_t time_ms);
+
+    const Options& options() const { return options_; }
+    nlohmann::json get_stats() const;
+
+private:
+    Options options_;
+    BasisView* basis_ = nullptr;
+    mutable std::mutex entries_mutex_;  // only taken to create or look up entries
+    std::unordered_map<std::string, std::unique_ptr<Entry>> entries_;
+};
+
+} // namespace gateio
+} // namespace gateway
+} // namespace singular
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <singular/types/include/Order.h>
+#include "SendQueue.h"
+
+namespace singular {
+namespace gateway {
+namespace gateio {
+
+// Where one instrument's orders go, resolved the first time the symbol is traded so the
+// place and cancel paths only read fields: channel names, the contract string Gate.io
+// expects, the key it goes under and the private session that carries it.
+// Spot orders travel on the spot session and futures orders on the futures session set,
+// each on its own loop, so neither order flow waits behind the other.
+struct OrderRoute {
+    singular::types::InstrumentType type;
+    bool spot = false;
+    bool perpetual = false;
+    std::string contract;                // "BTC_USDT"
+    const char* place_channel = nullptr;
+    const char* cancel_channel = nullptr;
+    const char* symbol_key = nullptr;    // "currency_pair" or "contract"
+    // Send path of the session that carries the orders, nullptr while it is disabled. Futures
+    // requests still go through Gateway::send_futures_request so standby sessions can take them.
+    SendQueue* sender = nullptr;
+};
+
+// Routes per internal symbol ("BTC_USDT@SPOT"). Used from the engine loop only; routes
+// are never removed, so pointers stay valid for the gateway's lifetime.
+class OrderRouteTable {
+public:
+    void set_senders(SendQueue* spot, SendQueue* futures)
+    {
+        spot_sender_ = spot;
+        futures_sender_ = futures;
+    }
+
+    const OrderRoute& resolve(const std::string& symbol, singular::types::InstrumentType type);
+    size_t size() const { return routes_.size(); }
+
+private:
+    SendQueue* spot_sender_ = nullptr;
+    SendQueue* futures_sender_ = nullptr;
+    std::unordered_map<std::string, std::unique_ptr<OrderRoute>> routes_;
+    std::vector<std::unique_ptr<OrderRoute>> retired_;
+};
+
+} // namespace gateio
+} // namespace gateway
+} // namespace singular
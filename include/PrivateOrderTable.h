@@ -0,0 +1,76 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <nlohmann/json.hpp>
+
+namespace singular {
+namespace gateway {
+namespace gateio {
+
+// Live orders keyed by the client id carried in the order's "t-Z-<id>" text, shared by the
+// order-entry session (place acks) and the stream session (futures.orders / usertrades
+// pushes). With the two on separate sockets a push can overtake the ack of the same order;
+// whichever arrives first records the exchange order id, so cancels by exchange id and
+// fills resolve either way. Entries go once the order is finished or its place is rejected.
+// Open orders are also counted per order-entry session, so an idle session can be told apart.
+// Used from the engine loop only.
+class PrivateOrderTable {
+public:
+    struct Entry {
+        std::string exchange_id;
+        std::string state;              // last pushed state, empty until the first push
+        double filled = 0.0;
+        bool acked = false;
+        int64_t sent_ns = 0;
+        int64_t acked_ns = 0;
+        int64_t pushed_ns = 0;          // first push
+        size_t session = 0;             // order-entry session that placed it
+    };
+
+    static constexpr size_t INITIAL_SIZE = 10000;
+    static constexpr size_t SESSIONS = 2;
+
+    PrivateOrderTable() { orders_.reserve(INITIAL_SIZE); exchange_ids_.reserve(INITIAL_SIZE); }
+
+    void on_sent(uint64_t client_id, size_t session);
+    // Place ack on the order-entry session
+    Entry* on_ack(uint64_t client_id, const std::string& exchange_id);
+    // Error response to the place; the order never reached the book
+    void on_reject(uint64_t client_id);
+    // futures.orders / spot.orders push; finished orders are removed after the caller's use,
+    // on the next push or lookup
+    Entry* on_push(uint64_t client_id, const std::string& exchange_id, const std::string& state, double filled, bool finished);
+    // Client id of an exchange order id, 0 when unknown
+    uint64_t client_id(const std::string& exchange_id) const;
+    Entry* find(uint64_t client_id);
+    size_t size() const { return orders_.size(); }
+    // Orders placed on session that are neither finished nor rejected
+    size_t open(size_t session) const { return open_[session]; }
+
+    static uint64_t parse_text(const std::string& text);
+    nlohmann::json get_stats() const;
+
+private:
+    void record_exchange_id(uint64_t client_id, Entry& entry, const std::string& exchange_id);
+    void reap();
+
+    std::unordered_map<uint64_t, Entry> orders_;
+    std::unordered_map<std::string, uint64_t> exchange_ids_;
+    uint64_t finished_ = 0;                 // client id finished by the last push, reaped on the next call
+    std::array<size_t, SESSIONS> open_{};
+
+    uint64_t acks_ = 0;
+    uint64_t pushes_ = 0;
+    uint64_t pushes_before_ack_ = 0;        // push reached the engine before the ack of its order
+    uint64_t unknown_pushes_ = 0;           // orders not placed through this gateway
+    uint64_t rejects_ = 0;
+    uint64_t ack_to_push_ns_total_ = 0;
+    uint64_t ack_to_push_samples_ = 0;
+};
+
+} // namespace gateio
+} // namespace gateway
+} // namespace singular
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#include <singular/network/network/include/WebsocketClient.h>
+#include "SubscriptionManager.h"
+#include "Heartbeat.h"
+#include "Reconnector.h"
+#include "SendQueue.h"
+#include "WsClient.h"
+
+namespace singular {
+namespace gateway {
+namespace gateio {
+
+// A set of public sockets to one Gate.io endpoint (spot, futures usdt or futures btc).
+// Callbacks of connection i arrive on that connection's event loop.
+// Symbols are placed on the connection with the lowest measured message rate and are
+// periodically moved from the busiest to the quietest connection when the load drifts apart.
+// A connection that closes is reopened with backoff and gets its subscriptions replayed.
+// With lines > 1 every slot has one connection per line (index = line * connections + slot)
+// and the line-0 connection mirrors its subscriptions to the other lines, so each symbol
+// arrives on independent sockets and can be arbitrated, see FeedArbiter.
+class PublicConnectionPool {
+public:
+    struct Options {
+        size_t connections = 1;
+        size_t lines = 1;                   // copies of every subscription, on separate sockets
+        double subscribe_rate = 50.0;
+        size_t subscribe_batch = 50;
+        int rebalance_interval_ms = 30000;
+        double rebalance_threshold = 0.5;   // rebalance when busiest > quietest * (1 + threshold)
+        std::string ping_channel = "spot.ping";
+        Heartbeat::Options heartbeat;
+        Reconnector::Options reconnect;
+        SendQueue::Options send;            // coalescing flushes the subscription frames of one loop iteration at once
+    };
+
+    using OpenCallback = std::function<void(size_t index)>;
+    using CloseCallback = std::function<void(size_t index)>;
+    using MessageHandler = std::function<void(size_t index, const std::string& message)>;
+
+    // Connection i runs on loops[i % loops.size()]
+    PublicConnectionPool(const std::string& name, const std::vector<hv::EventLoopPtr>& loops, const char* url, const Options& options);
+    ~PublicConnectionPool();
+
+    // Set once before the first run; the sockets' loops read them without locking
+    void set_callbacks(OpenCallback on_open, CloseCallback on_close, MessageHandler handler);
+    // Opens the sockets; run again after close() to reopen them
+    void run();
+    void close();
+
+    // Returns the line-0 subscriptions of the slot that owns symbol, placing it first if needed
+    SubscriptionManager* place(const std::string& symbol);
+    // Returns the owning connection or nullptr when the symbol is not placed
+    SubscriptionManager* find(const std::string& symbol);
+
+    // Attributes one decoded message to symbol for load measurement
+    void record_message(size_t index, const std::string& symbol);
+    // A copy that lost arbitration: the connection is delivering data, the symbol load is already counted
+    void record_duplicate(size_t index);
+
+    // Pong round trips of connection index also feed clock; set before run
+    void set_clock(size_t index, ClockEstimator* clock);
+
+    void rebalance();
+    size_t open_connections() const;
+    size_t size() const { return connections_.size(); }
+    size_t lines() const { return lines_; }
+    size_t slots() const { return connections_.size() / lines_; }
+    size_t line_of(size_t index) const { return index / slots(); }
+    size_t slot_of(size_t index) const { return index % slots(); }
+    const std::string& name() const { return name_; }
+    nlohmann::json get_stats() const;
+    nlohmann::json get_heartbeat_stats() const;
+    nlohmann::json get_reconnect_stats() const;
+    nlohmann::json get_send_stats() const;
+    nlohmann::json get_transport_stats() const;
+
+private:
+    struct Connection {
+        size_t index = 0;
+        size_t line = 0;
+        hv::EventLoopPtr loop;
+        std::unique_ptr<WsClient> client;
+        std::unique_ptr<SendQueue> sender;
+        std::unique_ptr<SubscriptionManager> subscriptions;
+        std::unique_ptr<Heartbeat> heartbeat;
+        std::unique_ptr<Reconnector> reconnect;
+        std::atomic<bool> open{false};
+        std::atomic<uint64_t> messages{0};
+        std::atomic<uint64_t> bytes{0};
+        std::atomic<uint64_t> duplicates{0};
+        uint64_t messages_at_sample = 0;
+        double message_rate = 0.0;                            // messages/s over the last window
+
+        std::mutex mutex;                                     // guards symbol counters
+        std::unordered_map<std::string, uint64_t> symbol_messages;
+    };
+
+    struct Placement {
+        size_t index = 0;
+        uint64_t messages_at_sample = 0;
+        double rate = 0.0;                                    // EWMA of messages/s
+    };
+
+    void connect(Connection& connection);
+    double load_of(size_t index) const;
+    double default_symbol_rate() const;
+    void sample_rates();
+
+    std::string name_;
+    hv::EventLoopPtr loop_;
+    Options options_;
+    size_t lines_ = 1;
+    std::vector<std::unique_ptr<Connection>> connections_;
+    OpenCallback on_open_;
+    CloseCallback on_close_;
+    MessageHandler handler_;
+
+    mutable std::mutex placement_mutex_;
+    std::unordered_map<std::string, Placement> placements_;
+    int64_t last_sample_ns_ = 0;
+    uint64_t moves_ = 0;
+    std::atomic<uint64_t> stale_closes_{0};
+    hv::TimerID rebalance_timer_ = INVALID_TIMER_ID;
+};
+
+} // namespace gateio
+} // namespace gateway
+} // namespace singular
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <functional>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <nlohmann/json.hpp>
+
+#include "BookState.h"
+#include "ClockEstimator.h"
+#include "MarketSnapshot.h"
+#include "FundingTable.h"
+#include "GatewayHealth.h"
+
+namespace singular {
+namespace gateway {
+namespace gateio {
+
+// Decodes frames from the Gate.io public sockets (spot and futures) and keeps a
+// local L2 book per symbol. Every applied book update is handed to book_callback_
+// as a top-N BookState. Incremental (order_book_update, obu) and snapshot
+// (order_book) channels feed the same book, so a symbol can switch profile live.
+// Deltas only apply to a book seeded by a snapshot or a "full" push. Until then, and after a
+// sequence gap, they are dropped and resync_callback_ asks for a fresh snapshot.
+class PublicFeedHandler {
+public:
+    using BookCallback = std::function<void(const BookState&)>;
+    // needed is true when a book lost its seed, false once a snapshot has seeded it again
+    using ResyncCallback = std::function<void(const std::string& symbol, bool needed)>;
+
+    explicit PublicFeedHandler(size_t depth = 20);
+
+    void set_book_callback(BookCallback callback) { book_callback_ = std::move(callback); }
+    void set_resync_callback(ResyncCallback callback) { resync_callback_ = std::move(callback); }
+    // Book and trade updates also refresh the symbol's snapshot and analytics in table
+    void set_snapshot_table(MarketSnapshotTable* table) { snapshots_ = table; }
+    // futures.tickers pushes update the contract's funding record in table
+    void set_funding_table(FundingTable* table) { funding_ = table; }
+    // Every push's time_ms feeds clock, which stamps book states with latency
+    void set_clock(ClockEstimator* clock) { clock_ = clock; }
+    // Books going out of and back into sequence are reported to health
+    void set_health(GatewayHealth* health) { health_ = health; }
+    void on_message(const std::string& buffer);
+    // Internal symbol of the last decoded market data message, empty for control frames
+    const std::string& last_symbol() const { return last_symbol_; }
+    nlohmann::json get_book_stats() const;
+
+private:
+    struct LocalBook {
+        std::map<double, double, std::greater<double>> bids;
+        std::map<double, double> asks;
+        uint64_t last_update_id = 0;
+        uint64_t updates = 0;
+        uint64_t gaps = 0;
+        uint64_t snapshots = 0;
+        uint64_t resyncs = 0;
+        uint64_t dropped = 0;            // deltas received while unseeded
+        bool seeded = false;
+        bool resync_pending = false;
+        bool valid = true;
+        MarketSnapshotTable::Entry* snapshot = nullptr;
+    };
+
+    static std::string book_symbol(const nlohmann::json& result, const char* market_suffix);
+    void apply_book_update(const nlohmann::json& result, const char* market_suffix);
+    void apply_book_snapshot(const nlohmann::json& result, const char* market_suffix);
+    void apply_futures_tickers(const nlohmann::json& result, int64_t exchange_time_ms);
+    void apply_trades(const nlohmann::json& result, const char* market_suffix);
+    void apply_trade(const nlohmann::json& trade, const char* market_suffix);
+    void set_valid(LocalBook& book, bool valid);
+    void request_resync(const std::string& symbol, LocalBook& book);
+    void seed(const std::string& symbol, LocalBook& book);
+    void publish_book(const std::string& symbol, LocalBook& book, const nlohmann::json& result);
+
+    std::string log_service_name = "GATEIO";
+    size_t depth_;
+    BookCallback book_callback_;
+    ResyncCallback resync_callback_;
+    std::unordered_map<std::string, LocalBook> books_;
+    MarketSnapshotTable* snapshots_ = nullptr;
+    std::unordered_map<std::string, MarketSnapshotTable::Entry*> trade_entries_;
+    FundingTable* funding_ = nullptr;
+    ClockEstimator* clock_ = nullptr;
+    GatewayHealth* health_ = nullptr;
+    int64_t message_latency_ns_ = 0;
+    std::unordered_map<std::string, FundingTable::Entry*> funding_entries_;
+    BookState scratch_;
+    std::string last_symbol_;
+};
+
+} // namespace gateio
+} // namespace gateway
+} // namespace singular
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <string>
+#include <nlohmann/json.hpp>
+
+#include <singular/network/network/include/WebsocketClient.h>
+#include "LatencyHistogram.h"
+#include "WsClient.h"
+
+namespace singular {
+namespace gateway {
+namespace gateio {
+
+// Reconnect state machine for one socket:
+//   CONNECTED --close--> BACKOFF --timer--> CONNECTING --open--> RESTORING --data--> CONNECTED
+// A close while CONNECTING or RESTORING goes back to BACKOFF with the next, longer delay.
+// Delays grow exponentially from initial_backoff_ms up to max_backoff_ms and are jittered
+// to [delay/2, delay] so sockets that dropped together do not reconnect in lockstep.
+// "Restored" means market data flowing again (public) or the login acknowledged (private);
+// the time from the first close to that point is recorded per outage, and split into the
+// connect of the successful attempt (TCP, TLS and upgrade, with the TLS handshake separately
+// when the transport reports it) and the backoff and restore time around it. An open that
+// arrives with no attempt in progress, from a warm standby, counts as instant.
+// on_open/on_close and the timer run on the socket's loop; on_restored, stop and stats
+// may be called from any thread.
+class Reconnector {
+public:
+    struct Options {
+        int initial_backoff_ms = 100;
+        int max_backoff_ms = 30000;
+        double multiplier = 2.0;
+    };
+
+    enum class State { IDLE, CONNECTED, BACKOFF, CONNECTING, RESTORING, STOPPED };
+
+    using ConnectFunction = std::function<void()>;
+
+    Reconnector(hv::EventLoopPtr loop, const std::string& name, ConnectFunction connect, const Options& options);
+    ~Reconnector();
+
+    // Returns true when this open ends an outage, i.e. the session has to be set up again.
+    // connect is the client's last_connect(), used when the open ends a reconnect attempt.
+    bool on_open(const WsClient::ConnectInfo& connect = WsClient::ConnectInfo());
+    void on_close();
+    // Cheap when nothing is being restored, so it can sit on the message path
+    void on_restored()
+    {
+        if (state_.load(std::memory_order_relaxed) == State::RESTORING)
+        {
+            finish_restore();
+        }
+    }
+    // Deliberate close: no further attempts until resume
+    void stop();
+    void resume();
+
+    State state() const { return state_; }
+    static const char* to_string(State state);
+    nlohmann::json get_stats() const;
+
+private:
+    void finish_restore();
+    int next_delay_ms();
+
+    hv::EventLoopPtr loop_;
+    std::string name_;
+    ConnectFunction connect_;
+    Options options_;
+
+    mutable std::mutex mutex_;
+    std::atomic<State> state_{State::IDLE};
+    hv::TimerID timer_ = INVALID_TIMER_ID;
+    int attempt_ = 0;                  // consecutive attempts in the current outage
+    int64_t outage_start_ns_ = 0;      // first close of the current outage, 0 when none
+    int64_t attempt_start_ns_ = 0;     // connect() of the attempt in progress, 0 when none
+    std::mt19937 random_;
+
+    uint64_t disconnects_ = 0;
+    uint64_t attempts_ = 0;
+    uint64_t restores_ = 0;
+    int64_t last_restore_ns_ = 0;
+    LatencyHistogram restore_time_;    // first close to data restored, ns
+    uint64_t instant_opens_ = 0;
+    uint64_t tls_resumed_ = 0;
+    uint64_t tls_full_ = 0;
+    int64_t last_connect_ns_ = 0;
+    int64_t last_tls_ns_ = -1;
+    LatencyHistogram connect_time_;    // reconnect attempt to socket open, ns
+    LatencyHistogram tls_time_;        // TLS handshake of that attempt, ns
+};
+
+} // namespace gateio
+} // namespace gateway
+} // namespace singular
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#include <singular/network/network/include/WebsocketClient.h>
+#include "ClockEstimator.h"
+#include "FeedCapture.h"
+#include "Heartbeat.h"
+#include "Reconnector.h"
+#include "SendQueue.h"
+#include "SpscQueue.h"
+#include "WsClient.h"
+
+namespace singular {
+namespace gateway {
+namespace gateio {
+
+// Hot-standby futures order-entry sessions kept logged in next to the primary private
+// socket. The gateway sends cancels on every usable session and places on the one with
+// the lowest smoothed ping RTT, so losing a session costs no reconnect on the order path.
+// Responses of all sessions (source 0 is the primary, i + 1 standby i) go through accept(),
+// which lets exactly one copy of each request's response through: the first success, or
+// the last failure once every copy has failed. A failure held for copies that never come,
+// because their session closed or HOLD_TIMEOUT_MS passed, is released through
+// drain_released() so the order still gets its reject.
+class RedundantSessions {
+public:
+    struct Session {
+        std::string name;
+        std::unique_ptr<WsClient> client;
+        std::unique_ptr<SendQueue> sender;
+        std::unique_ptr<Heartbeat> heartbeat;
+        std::unique_ptr<Reconnector> reconnect;
+        std::unique_ptr<ClockEstimator> clock;
+        SpscQueue<std::string> inbox{INBOX_SIZE};
+        std::atomic<bool> open{false};
+        std::atomic<bool> authenticated{false};
+        std::atomic<uint64_t> sent{0};
+        size_t source = 0;
+        uint16_t capture_id = FeedCapture::MAX_CONNECTIONS;
+
+        bool usable() const { return open && authenticated && !heartbeat->stale(); }
+    };
+
+    using LoginFrame = std::function<std::string()>;
+    // Hands a frame from a session's loop to the engine, see Gateway::enqueue_private
+    using FrameSink = std::function<void(size_t source, SpscQueue<std::string>& inbox, const std::string& frame)>;
+    // Called from a session loop or the hold timer once a held failure is waiting in drain_released()
+    using ReleaseCallback = std::function<void()>;
+    using CaptureName = std::function<std::string(const std::string& session)>;
+
+    static constexpr size_t INBOX_SIZE = 4096;
+    static constexpr const char* STANDBY_PREFIX = "GATEIO_PRIVATE_STANDBY#";
+    static constexpr int HOLD_TIMEOUT_MS = 1000;
+
+    // One standby session per loop
+    RedundantSessions(const std::vector<hv::EventLoopPtr>& loops, const char* url, const char* login_channel,
+                      const Heartbeat::Options& heartbeat, const Reconnector::Options& reconnect,
+                      const SendQueue::Options& send_options, LoginFrame login, FrameSink sink);
+    ~RedundantSessions();
+
+    void set_release_callback(ReleaseCallback callback) { release_callback_ = std::move(callback); }
+    // Records every standby frame under name(session name); set before run
+    void set_capture(FeedCapture* capture, const CaptureName& name);
+
+    void run();
+    void close();
+
+    size_t size() const { return sessions_.size(); }
+    // Usable standby with the lowest measured smoothed RTT, nullptr if none
+    Session* fastest();
+    std::vector<Session*> usable();
+    // false when the session refused the frame for backpressure
+    bool send(Session& session, const std::string& frame, SendQueue::Priority priority, bool urgent);
+    // The primary's share of the traffic, for the stats
+    void count_primary_send() { ++primary_sent_; }
+
+    // Sources a request is sent on, registered before the first copy goes out
+    void expect(const std::string& channel, const std::string& req_id, const std::vector<size_t>& sources);
+    // Engine side: true for the one copy of a response that should be processed
+    bool accept(size_t source, const std::string& frame);
+    // Copies still expected from source will not come; the primary reports its own closes
+    void on_session_closed(size_t source);
+
+    // Engine side: consumer(source, frame) for every queued standby frame
+    template <typename Fn>
+    void drain(Fn&& consumer)
+    {
+        for (size_t i = 0; i < sessions_.size(); ++i)
+        {
+            while (sessions_[i]->inbox.consume_one([&](std::string& frame) { consumer(i + 1, frame); }))
+            {
+            }
+        }
+    }
+
+    // Engine side: consumer(frame) for every held failure released since the last call. These
+    // are final: they have already been through accept().
+    template <typename Fn>
+    void drain_released(Fn&& consumer)
+    {
+        std::deque<std::string> released;
+        {
+            std::lock_guard<std::mutex> lock(pending_mutex_);
+            released.swap(released_);
+        }
+        for (std::string& frame : released)
+        {
+            consumer(frame);
+        }
+    }
+
+    nlohmann::json get_stats() const;
+
+private:
+    struct Pending {
+        std::vector<size_t> waiting;    // sources whose copy has neither arrived nor been lost
+        bool delivered = false;
+        std::string held;               // last failure, while other copies may still succeed
+        int64_t held_since_ns = 0;
+    };
+
+    static constexpr size_t MAX_TRACKED = 8192;
+
+    void connect(Session& session);
+    // Called with pending_mutex_ held
+    void release(Pending& pending);
+    void release_expired();
+
+    std::string login_channel_;
+    LoginFrame login_;
+    FrameSink sink_;
+    std::vector<std::unique_ptr<Session>> sessions_;   // standby i is response source i + 1
+    ReleaseCallback release_callback_;
+    FeedCapture* capture_ = nullptr;
+    hv::EventLoopPtr timer_loop_;
+    hv::TimerID hold_timer_ = INVALID_TIMER_ID;
+
+    mutable std::mutex pending_mutex_;
+    std::unordered_map<std::string, Pending> pending_;    // channel|req_id, and channel|req_id|ack
+    std::deque<std::string> pending_order_;               // oldest first, bounds pending_
+    std::deque<std::string> held_order_;                  // keys of held failures, oldest first
+    std::deque<std::string> released_;                    // held failures waiting for the engine
+    std::vector<uint64_t> wins_;                          // final responses delivered, per source
+    uint64_t duplicates_ = 0;
+    uint64_t held_failures_ = 0;
+    uint64_t failures_released_ = 0;                      // after a lost copy or the hold timeout
+    std::atomic<uint64_t> primary_sent_{0};
+};
+
+} // namespace gateio
+} // namespace gateway
+} // namespace singular
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#include <singular/network/network/include/WebsocketClient.h>
+#include "LatencyHistogram.h"
+
+namespace singular {
+namespace gateway {
+namespace gateio {
+
+// Outbound path of one socket. Without coalescing every frame goes straight to the client,
+// so a send from another thread costs one loop wakeup plus one socket write. With
+// coalescing, frames sent during one event loop iteration are queued and written back to
+// back by a single task on the socket's loop: one wakeup per burst instead of one per
+// frame. An urgent frame sent on the socket's own loop flushes the queue and goes out at
+// once; from another thread it joins the pending flush, which is already the earliest
+// point it can be written.
+//
+// With prioritization, queued frames wait in one lane per class and every flush writes
+// cancels first, then amends, places and everything else, at most flush_batch frames per
+// loop task, so a cancel sent behind a batch of places overtakes whatever has not been
+// written yet. Places and amends are refused once max_pending of them are queued; cancels
+// and other frames are never refused.
+// Wakeups and writer calls are counted in both modes, so bursts can be compared before and after.
+// send() may be called from any thread; the writer runs on the socket's loop or the caller's.
+class SendQueue {
+public:
+    enum class Priority : uint8_t { CANCEL = 0, AMEND = 1, PLACE = 2, OTHER = 3 };
+    static constexpr size_t PRIORITIES = 4;
+
+    struct Options {
+        bool coalesce = false;
+        bool prioritize = false;
+        size_t max_pending = 1024;       // queued places (and amends) before send() refuses more
+        size_t flush_batch = 64;         // frames written per loop task when prioritizing
+    };
+
+    using Writer = std::function<void(const std::string&)>;
+
+    SendQueue(hv::EventLoopPtr loop, const std::string& name, Writer writer, const Options& options);
+
+    // false when the frame was refused for backpressure
+    bool send(const std::string& frame, Priority priority = Priority::OTHER, bool urgent = false);
+    // True when a frame of this class would be refused
+    bool full(Priority priority) const;
+
+    bool queued() const { return options_.coalesce || options_.prioritize; }
+    const std::string& name() const { return name_; }
+    static const char* to_string(Priority priority);
+    nlohmann::json get_stats() const;
+
+private:
+    struct Entry {
+        std::string frame;
+        int64_t enqueued_ns = 0;
+        Priority priority = Priority::OTHER;
+    };
+
+    struct ClassStats {
+        std::atomic<uint64_t> frames{0};
+        std::atomic<uint64_t> refused{0};
+        std::atomic<size_t> depth{0};
+        size_t max_depth = 0;                // guarded by pending_mutex_
+        LatencyHistogram queue_ns;           // guarded by stats_mutex_
+    };
+
+    void flush(size_t limit);
+    void schedule_flush();
+
+    hv::EventLoopPtr loop_;
+    std::string name_;
+    Writer writer_;
+    Options options_;
+
+    std::mutex pending_mutex_;
+    std::array<std::deque<Entry>, PRIORITIES> lanes_;   // a single FIFO lane without prioritization
+    std::vector<Entry> flushing_;                        // touched by flush() only, on the socket's loop
+    bool flush_scheduled_ = false;
+
+    std::array<ClassStats, PRIORITIES> classes_;
+    std::atomic<uint64_t> frames_{0};
+    std::atomic<uint64_t> urgent_{0};
+    std::atomic<uint64_t> wakeups_{0};       // tasks queued onto the socket's loop
+    std::atomic<uint64_t> bursts_{0};        // flushes, or single frames without queueing
+    std::atomic<uint64_t> writes_{0};        // calls into the writer
+
+    mutable std::mutex stats_mutex_;
+    LatencyHistogram frames_per_burst_;
+};
+
+} // namespace gateio
+} // namespace gateway
+} // namespace singular
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace singular {
+namespace gateway {
+namespace gateio {
+
+// Sequence lock around a trivially copyable value. Readers never block writers and
+// retry when they overlap a write. Writers serialize on the odd sequence value, so a
+// symbol that moves between feed threads can still be written from either.
+template <typename T>
+class SeqLock {
+    static_assert(std::is_trivially_copyable<T>::value, "SeqLock needs a trivially copyable value");
+
+public:
+    // fn(T&) runs with the write side held; keep it short
+    template <typename Fn>
+    void write(Fn&& fn)
+    {
+        uint64_t sequence = sequence_.load(std::memory_order_relaxed);
+        while ((sequence & 1) || !sequence_.compare_exchange_weak(sequence, sequence + 1, std::memory_order_acquire)) {
+            sequence = sequence_.load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+        fn(value_);
+        sequence_.store(sequence + 2, std::memory_order_release);
+    }
+
+    // Holds the write side without publishing a new version, for writer-owned side state
+    template <typename Fn>
+    void inspect(Fn&& fn)
+    {
+        uint64_t sequence = sequence_.load(std::memory_order_relaxed);
+        while ((sequence & 1) || !sequence_.compare_exchange_weak(sequence, sequence + 1, std::memory_order_acquire)) {
+            sequence = sequence_.load(std::memory_order_relaxed);
+        }
+        fn(static_cast<const T&>(value_));
+        sequence_.store(sequence, std::memory_order_release);
+    }
+
+    T read() const
+    {
+        T copy;
+        uint64_t before;
+        uint64_t after;
+        do {
+            before = sequence_.load(std::memory_order_acquire);
+            std::memcpy(&copy, &value_, sizeof(T));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = sequence_.load(std::memory_order_relaxed);
+        } while ((before & 1) || before != after);
+        return copy;
+    }
+
+    // Number of completed writes
+    uint64_t version() const { return sequence_.load(std::memory_order_acquire) >> 1; }
+
+private:
+    alignas(64) std::atomic<uint64_t> sequence_{0};
+    T value_{};
+};
+
+} // namespace gateio
+} // namespace gateway
+} // namespace singular
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace singular {
+namespace gateway {
+namespace gateio {
+
+// Bounded single-producer/single-consumer ring. Capacity is rounded up to a power of two.
+// Slots are constructed once and reused, so pushing a T with heap members (strings,
+// vectors) reuses the slot's buffers instead of allocating.
+template <typename T>
+class SpscQueue {
+public:
+    explicit SpscQueue(size_t capacity)
+    {
+        size_t size = 2;
+        while (size < capacity)
+            size <<= 1;
+        mask_ = size - 1;
+        slots_.resize(size);
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // Lets fn fill the next free slot in place and publishes it afterwards
+    template <typename Fn>
+    bool produce_one(Fn&& fn)
+    {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_cache_ > mask_) {
+            head_cache_ = head_.load(std::memory_order_acquire);
+            if (tail - head_cache_ > mask_)
+                return false;
+        }
+        fn(slots_[tail & mask_]);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    template <typename U>
+    bool try_push(U&& value)
+    {
+        return produce_one([&value](T& slot) { slot = std::forward<U>(value); });
+    }
+
+    // Hands the front element to fn by reference and releases the slot afterwards
+    template <typename Fn>
+    bool consume_one(Fn&& fn)
+    {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_cache_) {
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+            if (head == tail_cache_)
+                return false;
+        }
+        fn(slots_[head & mask_]);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool try_pop(T& out)
+    {
+        return consume_one([&out](T& value) { out = std::move(value); });
+    }
+
+    bool empty() const
+    {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+
+    size_t size() const
+    {
+        return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+    }
+
+    size_t capacity() const { return mask_ + 1; }
+
+private:
+    static constexpr size_t CACHE_LINE = 64;
+
+    std::vector<T> slots_;
+    size_t mask_ = 0;
+
+    alignas(CACHE_LINE) std::atomic<size_t> head_{0};
+    size_t tail_cache_ = 0;   // consumer's view of tail_
+    alignas(CACHE_LINE) std::atomic<size_t> tail_{0};
+    size_t head_cache_ = 0;   // producer's view of head_
+};
+
+} // namespace gateio
+} // namespace gateway
+} // namespace singular
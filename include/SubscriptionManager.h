@@ -0,0 +1,116 @@
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#include <singular/network/network/include/WebsocketClient.h>
+
+namespace singular {
+namespace gateway {
+namespace gateio {
+
+// Owns the subscription traffic of one public socket.
+// Channels whose payload is a list of symbols (tickers, trades, book_ticker) are grouped into
+// multi-symbol frames, everything else (order books) goes out as one frame per symbol.
+// Frames are pre-serialized per (channel, symbol) and only the "time" field is spliced in at
+// send time. Outgoing frames are paced by a token bucket and held back while the socket is closed.
+// After a reconnect the queue is rebuilt from the active set, so the new socket gets exactly
+// the subscriptions that are wanted at that moment.
+// All state lives on the socket's event loop; public methods may be called from any thread.
+class SubscriptionManager {
+public:
+    using SendFunction = std::function<void(const std::string&)>;
+
+    SubscriptionManager(hv::EventLoopPtr loop, SendFunction send, double frames_per_second, size_t max_batch);
+    ~SubscriptionManager();
+
+    // Every subscribe, unsubscribe and transfer is repeated on mirror (the same slot on the
+    // next feed line); set before first use
+    void set_mirror(SubscriptionManager* mirror) { mirror_ = mirror; }
+
+    // Batchable channel, the payload is a list of symbols
+    void subscribe(const std::string& channel, const std::string& symbol);
+    void unsubscribe(const std::string& channel, const std::string& symbol);
+
+    // Single-symbol channel with a fixed payload, e.g. ["BTC_USDT","100ms"]
+    void subscribe(const std::string& channel, const std::string& symbol, const nlohmann::json& payload);
+    void unsubscribe(const std::string& channel, const std::string& symbol, const nlohmann::json& payload);
+
+    void on_connected();
+    void on_disconnected();
+
+    // Moves every active subscription of symbol to target (subscribe there first, then unsubscribe here)
+    void transfer(const std::string& symbol, SubscriptionManager& target);
+    bool has_symbol(const std::string& symbol) const;
+
+    nlohmann::json get_stats() const;
+
+private:
+    enum class Event { SUBSCRIBE, UNSUBSCRIBE };
+
+    struct CachedFrames {
+        std::string channel;
+        std::string symbol;
+        nlohmann::json payload;   // null for batchable channels
+        std::string token;        // serialized payload element(s)
+        std::string subscribe;    // frame tail after {"time":<t>
+        std::string unsubscribe;
+        bool batchable = false;
+    };
+
+    struct PendingFrame {
+        std::string channel;
+        Event event;
+        std::vector<const CachedFrames*> entries;
+    };
+
+    const CachedFrames& cached(const std::string& channel, const std::string& symbol, const nlohmann::json* payload);
+    void enqueue(const std::string& channel, const CachedFrames& frames, Event event);
+    void append_pending(const std::string& channel, const CachedFrames& frames, Event event);
+    void replay_active();
+    void pump();
+    void send_frame(const PendingFrame& frame);
+    bool take_token();
+    void track_symbol(const std::string& symbol, bool active);
+
+    hv::EventLoopPtr loop_;
+    SendFunction send_;
+    SubscriptionManager* mirror_ = nullptr;
+    double frames_per_second_;
+    double burst_;
+    size_t max_batch_;
+
+    bool connected_ = false;
+    bool was_connected_ = false;
+    double tokens_;
+    int64_t last_refill_ns_ = 0;
+    hv::TimerID pump_timer_ = INVALID_TIMER_ID;
+
+    std::unordered_map<std::string, CachedFrames> cache_;   // keyed by channel + '|' + symbol
+    std::deque<PendingFrame> pending_;
+    std::set<const CachedFrames*> active_;
+    std::string frame_buffer_;
+
+    mutable std::mutex symbols_mutex_;
+    std::unordered_map<std::string, size_t> symbol_refs_;   // active subscriptions per symbol
+
+    std::atomic<uint64_t> frames_sent_{0};
+    std::atomic<uint64_t> symbols_sent_{0};
+    std::atomic<uint64_t> replays_{0};
+    std::atomic<size_t> pending_frames_{0};
+    std::atomic<size_t> active_count_{0};
+    std::atomic<int64_t> first_request_ns_{0};
+    std::atomic<int64_t> last_drain_ns_{0};
+};
+
+} // namespace gateio
+} // namespace gateway
+} // namespace singular
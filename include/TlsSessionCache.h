@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <nlohmann/json.hpp>
+
+#include "LatencyHistogram.h"
+
+typedef struct ssl_st SSL;
+typedef struct ssl_session_st SSL_SESSION;
+
+namespace singular {
+namespace gateway {
+namespace gateio {
+
+// Process-wide TLS session tickets, one per endpoint ("host:port"). A client stores the
+// latest ticket the server issued and offers it on its next handshake to the same endpoint,
+// so a reconnect or a fresh socket to an exchange URL does an abbreviated handshake instead
+// of a full one. Full and resumed handshake times are kept per endpoint for comparison.
+// Public methods may be called from any thread.
+class TlsSessionCache {
+public:
+    static TlsSessionCache& shared();
+
+    ~TlsSessionCache();
+
+    // Keeps a copy of the session, replacing the endpoint's previous one
+    void store(const std::string& endpoint, SSL_SESSION* session);
+    // Offers the endpoint's session on the handshake; false when there is none to resume
+    bool apply(const std::string& endpoint, SSL* ssl);
+    void record(const std::string& endpoint, bool offered, bool resumed, int64_t handshake_ns);
+
+    nlohmann::json get_stats() const;
+
+private:
+    struct Endpoint {
+        SSL_SESSION* session = nullptr;
+        uint64_t stored = 0;
+        uint64_t offered = 0;
+        uint64_t resumed = 0;
+        uint64_t rejected = 0;           // offered, but the server did a full handshake
+        LatencyHistogram full_ns;
+        LatencyHistogram resumed_ns;
+    };
+
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, Endpoint> endpoints_;
+};
+
+} // namespace gateio
+} // namespace gateway
+} // namespace singular
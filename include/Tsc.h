@@ -0,0 +1,58 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace singular {
+namespace gateway {
+namespace gateio {
+
+// Cheap monotonic timestamps for the hot path. On x86 this is the invariant TSC,
+// elsewhere it falls back to steady_clock nanoseconds (one tick per ns).
+inline uint64_t read_tsc()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     std::chrono::steady_clock::now().time_since_epoch())
+                                     .count());
+#endif
+}
+
+inline int64_t wall_clock_ns()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+// TSC ticks per nanosecond, measured once against steady_clock over ~10ms
+inline double tsc_ticks_per_ns()
+{
+    static const double ticks_per_ns = []() {
+        auto start = std::chrono::steady_clock::now();
+        uint64_t tsc_start = read_tsc();
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        uint64_t tsc_end = read_tsc();
+        double elapsed_ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                                    std::chrono::steady_clock::now() - start)
+                                                    .count());
+        return elapsed_ns > 0.0 ? (tsc_end - tsc_start) / elapsed_ns : 1.0;
+    }();
+    return ticks_per_ns;
+}
+
+inline double tsc_to_ns(uint64_t ticks)
+{
+    return ticks / tsc_ticks_per_ns();
+}
+
+} // namespace gateio
+} // namespace gateway
+} // namespace singular
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <sys/socket.h>
+#include <nlohmann/json.hpp>
+
+#include "WsClient.h"
+
+typedef struct ssl_st SSL;
+typedef struct bio_st BIO;
+typedef struct hio_s hio_t;
+
+namespace singular {
+namespace gateway {
+namespace gateio {
+
+// Websocket client on io_uring, for the connections listed in GATEIO_URING_CONNECTIONS.
+// Each client owns a small ring with one registered read buffer and one registered write
+// buffer. Reads and writes use the fixed-buffer opcodes, and the ring signals completions
+// through an eventfd that the connection's hv loop watches. Callbacks therefore run on the
+// same loop as with the epoll client, and heartbeats, reconnects and send queues work
+// unchanged. Each wakeup drains every completion. All SQEs queued during one loop
+// iteration (the re-armed read, the next write) go to the kernel in one io_uring_enter.
+// TLS runs through OpenSSL memory BIOs, so the socket only ever sees ciphertext from the
+// fixed buffers. Session tickets are kept per endpoint in TlsSessionCache and offered on the
+// next handshake, so reconnects resume instead of doing a full handshake.
+// The address is resolved once, blocking, on the first run(); reconnects reuse it.
+// The destructor tears the socket down on the loop and waits for it, so the client may be
+// destroyed from any thread; callbacks stop once it returns.
+class UringWsClient : public WsClient {
+public:
+    struct Options {
+        unsigned ring_entries = 64;
+        size_t read_buffer = 256 << 10;
+        size_t write_buffer = 256 << 10;
+        bool verify_peer = true;         // certificate chain and host name
+        bool resume_sessions = true;     // store and offer TLS session tickets
+    };
+
+    UringWsClient(hv::EventLoopPtr loop, const char* url, const Options& options);
+    ~UringWsClient() override;
+
+    // True when built with liburing and the kernel accepts a ring
+    static bool available();
+
+    void run(OpenCallback on_open, CloseCallback on_close, MessageCallback on_message) override;
+    int send(const std::string& frame) override;
+    void close() override;
+    bool is_open() override { return open_.load(std::memory_order_acquire); }
+    const char* transport() const override { return "io_uring"; }
+    ConnectInfo last_connect() const override;
+    nlohmann::json get_stats() const override;
+
+private:
+    enum class State { IDLE, CONNECTING, TLS, UPGRADE, OPEN, CLOSING };
+    struct Ring;
+
+    static void on_ring_event(hio_t* io);
+    void start();
+    void fail(const std::string& reason);
+    void teardown();
+    void process_completions();
+    void on_connected(int result);
+    void on_read(int result);
+    void on_written(int result);
+    void continue_handshake();
+    void send_upgrade();
+    bool parse_upgrade();
+    void parse_frames();
+    void send_frame(uint8_t opcode, const char* data, size_t size);
+    void send_in_loop(const std::string& frame);
+    void write_plain(const char* data, size_t size);
+    void flush_tls();
+    // After SSL_write returned result <= 0: true when it is to be retried, otherwise the socket failed
+    bool tls_write_blocked(int result);
+    // Tears down once the reply to a close frame has been written
+    void finish_close();
+    void drain_tls_output();
+    void arm_read();
+    void arm_write();
+    void request_submit();
+    void submit();
+
+    hv::EventLoopPtr loop_;
+    Options options_;
+    bool tls_ = true;
+    std::string host_;
+    std::string port_;
+    std::string path_;
+    std::string endpoint_;               // host:port, the TLS session cache key
+    sockaddr_storage address_{};
+    socklen_t address_length_ = 0;
+    bool resolved_ = false;
+
+    std::unique_ptr<Ring> ring_;
+    // Checked by every task queued on the loop; cleared there by the destructor
+    std::shared_ptr<bool> alive_ = std::make_shared<bool>(true);
+    std::vector<char> read_buffer_;      // registered as buffer 0
+    std::vector<char> write_buffer_;     // registered as buffer 1
+
+    OpenCallback on_open_;
+    CloseCallback on_close_;
+    MessageCallback on_message_;
+
+    // Loop thread only. Buffers of a torn-down socket stay busy until its operations complete,
+    // so the in-flight flags survive a reconnect and the generation tells stale completions apart.
+    State state_ = State::IDLE;
+    std::atomic<bool> open_{false};
+    int fd_ = -1;
+    uint64_t generation_ = 0;
+    bool read_in_flight_ = false;
+    bool write_in_flight_ = false;
+    size_t write_length_ = 0;
+    size_t write_offset_ = 0;
+    std::string pending_out_;            // bytes for the socket not yet in the write buffer
+    std::string tls_out_;                // plaintext waiting for SSL_write to accept it
+    std::string plain_in_;               // received bytes not yet parsed
+    size_t plain_offset_ = 0;
+    std::string fragment_;               // fragmented message being reassembled
+    SSL* ssl_ = nullptr;
+    BIO* rbio_ = nullptr;
+    BIO* wbio_ = nullptr;
+    std::string upgrade_accept_;         // Sec-WebSocket-Accept the server must answer
+    bool session_offered_ = false;
+    bool in_completion_ = false;
+    bool submit_queued_ = false;
+    uint64_t mask_state_ = 0;
+    int64_t connect_start_ns_ = 0;
+    int64_t phase_start_ns_ = 0;
+
+    std::atomic<uint64_t> connects_{0};
+    std::atomic<uint64_t> failures_{0};
+    std::atomic<uint64_t> messages_{0};
+    std::atomic<uint64_t> bytes_in_{0};
+    std::atomic<uint64_t> frames_out_{0};
+    std::atomic<uint64_t> bytes_out_{0};
+    std::atomic<uint64_t> reads_{0};
+    std::atomic<uint64_t> writes_{0};
+    std::atomic<uint64_t> short_writes_{0};
+    std::atomic<uint64_t> tls_write_retries_{0};  // SSL_write calls that returned SSL_ERROR_WANT_*
+    std::atomic<uint64_t> submits_{0};       // io_uring_enter calls
+    std::atomic<uint64_t> wakeups_{0};       // eventfd wakeups of the loop
+    std::atomic<uint64_t> completions_{0};
+    // Phases of the last connect
+    std::atomic<int64_t> tcp_connect_ns_{0};
+    std::atomic<int64_t> tls_handshake_ns_{0};
+    std::atomic<int64_t> upgrade_ns_{0};
+    std::atomic<bool> tls_resumed_{false};
+    std::atomic<uint64_t> resumed_handshakes_{0};
+    std::atomic<uint64_t> full_handshakes_{0};
+};
+
+} // namespace gateio
+} // namespace gateway
+} // namespace singular
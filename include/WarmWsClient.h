@@ -0,0 +1,93 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#include "WsClient.h"
+
+namespace singular {
+namespace gateway {
+namespace gateio {
+
+// One connection backed by several sockets to the same URL: the active one, whose callbacks
+// reach the owner, and standbys that are connected, TLS-handshaked and upgraded ahead of
+// time. When the active socket closes or is dropped as stale, an open standby takes its
+// place at once: the owner sees the close immediately followed by an open, and logs in or
+// resubscribes on the new socket without waiting for backoff, connect and handshake. The old
+// socket reconnects in the background as a standby. If no standby is open, the close goes
+// through the owner's normal reconnect path, and whichever socket opens first becomes active.
+// Standbys send an application ping every keepalive_ms and are reconnected when they have
+// been silent for three intervals, so a promoted standby is known to be alive.
+// Callbacks run on the connection's loop; send, close, drop and stats may be called from any
+// thread, and so may the destructor: it stops the timers on the loop and waits for it.
+class WarmWsClient : public WsClient {
+public:
+    struct Options {
+        std::string ping_channel;        // e.g. "spot.ping"
+        int keepalive_ms = 5000;         // 0 disables standby pings and the silence check
+        int retry_ms = 1000;             // delay before a closed standby reconnects
+    };
+
+    WarmWsClient(hv::EventLoopPtr loop, const std::string& name, std::vector<std::unique_ptr<WsClient>> sockets,
+                 const Options& options);
+    ~WarmWsClient() override;
+
+    void run(OpenCallback on_open, CloseCallback on_close, MessageCallback on_message) override;
+    int send(const std::string& frame) override { return active_.load(std::memory_order_acquire)->send(frame); }
+    void close() override;
+    void drop() override;
+    bool is_open() override { return active_.load(std::memory_order_acquire)->is_open(); }
+    const char* transport() const override { return active_.load(std::memory_order_acquire)->transport(); }
+    ConnectInfo last_connect() const override { return active_.load(std::memory_order_acquire)->last_connect(); }
+    nlohmann::json get_stats() const override;
+
+private:
+    struct Socket {
+        std::unique_ptr<WsClient> client;
+        bool running = false;            // run() issued and no close seen since
+        bool open = false;
+        int64_t last_frame_ns = 0;       // standbys only
+        hv::TimerID retry_timer = INVALID_TIMER_ID;
+    };
+
+    void start(size_t index);
+    void schedule_retry(size_t index);
+    void on_socket_open(size_t index, const HttpResponsePtr& response);
+    void on_socket_close(size_t index);
+    void on_socket_message(size_t index, const std::string& frame);
+    // Makes an open standby the active socket; false when none is open
+    bool promote();
+    void keepalive();
+
+    hv::EventLoopPtr loop_;
+    std::string name_;
+    Options options_;
+    std::vector<Socket> sockets_;
+    std::atomic<WsClient*> active_;
+    hv::TimerID keepalive_timer_ = INVALID_TIMER_ID;
+    // Checked by every task queued on the loop; cleared there by the destructor
+    std::shared_ptr<bool> alive_ = std::make_shared<bool>(true);
+
+    OpenCallback on_open_;
+    CloseCallback on_close_;
+    MessageCallback on_message_;
+
+    // Loop thread only
+    size_t active_index_ = 0;
+    bool stopping_ = true;               // until run(), and after a deliberate close()
+
+    std::atomic<uint64_t> promotions_{0};
+    std::atomic<uint64_t> standby_connects_{0};
+    std::atomic<uint64_t> standby_closes_{0};
+    std::atomic<uint64_t> standby_silent_{0};     // standbys reconnected after missing keepalives
+    std::atomic<uint64_t> standby_frames_{0};
+    std::atomic<size_t> standbys_open_{0};
+};
+
+} // namespace gateio
+} // namespace gateway
+} // namespace singular
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <nlohmann/json.hpp>
+
+#include <singular/network/network/include/WebsocketClient.h>
+
+namespace singular {
+namespace gateway {
+namespace gateio {
+
+// One websocket connection as the gateway drives it: run() connects and reconnects are
+// driven by calling it again, callbacks run on the connection's loop, send() and close()
+// may be called from any thread. create() picks the transport per connection name:
+// the libhv epoll client by default, or the io_uring client for the connections listed
+// in GATEIO_URING_CONNECTIONS. Connections listed in GATEIO_WARM_STANDBY get warm standby
+// sockets, see WarmWsClient.
+class WsClient {
+public:
+    using OpenCallback = std::function<void(const HttpResponsePtr&)>;
+    using CloseCallback = std::function<void()>;
+    using MessageCallback = std::function<void(const std::string&)>;
+
+    // Phases of the last successful connect, -1 where the transport does not expose them
+    struct ConnectInfo {
+        int64_t tcp_ns = -1;
+        int64_t tls_ns = -1;
+        int64_t upgrade_ns = -1;
+        bool resumed = false;            // TLS session resumed from a cached ticket
+    };
+
+    virtual ~WsClient() = default;
+
+    virtual void run(OpenCallback on_open, CloseCallback on_close, MessageCallback on_message) = 0;
+    // Negative when the frame was not accepted, e.g. while disconnected
+    virtual int send(const std::string& frame) = 0;
+    virtual void close() = 0;
+    // Closes a socket found broken, e.g. stale. Unlike close(), a client with warm standbys
+    // puts one of them in its place instead of leaving the connection down.
+    virtual void drop() { close(); }
+    virtual bool is_open() = 0;
+    virtual const char* transport() const = 0;
+    virtual ConnectInfo last_connect() const { return ConnectInfo(); }
+    virtual nlohmann::json get_stats() const { return {{"transport", transport()}}; }
+
+    // True when list (comma separated) holds "all", the connection name, or its pool name
+    // such as GATEIO_SPOT for all of its sockets
+    static bool listed(const std::string& list, const std::string& name);
+    static bool uring_selected(const std::string& name);
+    // ping_channel keeps warm standby sockets alive, e.g. "futures.ping"
+    static std::unique_ptr<WsClient> create(hv::EventLoopPtr loop, const char* url, const std::string& name,
+                                            const std::string& ping_channel);
+};
+
+// libhv's epoll-based client
+class HvWsClient : public WsClient {
+public:
+    HvWsClient(hv::EventLoopPtr loop, const char* url) : client_(std::move(loop), url) {}
+
+    void run(OpenCallback on_open, CloseCallback on_close, MessageCallback on_message) override
+    {
+        client_.run(std::move(on_open), std::move(on_close), std::move(on_message));
+    }
+    int send(const std::string& frame) override { return client_.send(frame); }
+    void close() override { client_.close(); }
+    bool is_open() override { return client_.is_open(); }
+    const char* transport() const override { return "epoll"; }
+
+private:
+    singular::network::WebsocketClient client_;
+};
+
+} // namespace gateio
+} // namespace gateway
+} // namespace singular
@@ -0,0 +1,144 @@
+#include "gateio/include/BasisView.h"
+#include "gateio/include/InstrumentCatalog.h"
+
+namespace singular
+{
+  namespace gateway
+  {
+    namespace gateio
+    {
+
+      namespace
+      {
+        bool is_perpetual(const std::string &instrument_type)
+        {
+          return instrument_type == "LINEAR_PERPETUAL" || instrument_type == "INVERSE_PERPETUAL";
+        }
+      }
+
+      BasisView::Pair *BasisView::link(const std::string &symbol, bool &spot_leg)
+      {
+        size_t at = symbol.find('@');
+        if (at == std::string::npos)
+        {
+          return nullptr;
+        }
+        const std::string market = symbol.substr(at + 1);
+        if (market != "SPOT" && market != "FUTURE")
+        {
+          return nullptr;
+        }
+        spot_leg = market == "SPOT";
+
+        // The catalog knows base and quote; names like BTC_USDT are the fallback
+        std::string asset;
+        CatalogEntry instrument;
+        if (InstrumentCatalog::instance().find(symbol, instrument) && !instrument.base.empty() && !instrument.quote.empty())
+        {
+          if (!spot_leg && !is_perpetual(instrument.instrument_type))
+          {
+            return nullptr;
+          }
+          asset = instrument.base + "_" + instrument.quote;
+        }
+        else
+        {
+          asset = symbol.substr(0, at);
+        }
+
+        std::lock_guard<std::mutex> lock(pairs_mutex_);
+        auto &pair = pairs_[asset];
+        if (!pair)
+        {
+          pair = std::make_unique<Pair>();
+          pair->asset_ = asset;
+        }
+        return pair.get();
+      }
+
+      void BasisView::on_leg(Pair &pair, bool spot_leg, bool live, double bid, double ask, int64_t exchange_time_ms, int64_t receive_time_ns)
+      {
+        pair.record_.write([&](BasisRecord &record)
+                           {
+                             if (spot_leg)
+                             {
+                               record.spot_bid = bid;
+                               record.spot_ask = ask;
+                               record.spot_exchange_time_ms = exchange_time_ms;
+                               record.spot_receive_time_ns = receive_time_ns;
+                               record.spot_live = live;
+                             }
+                             else
+                             {
+                               record.perp_bid = bid;
+                               record.perp_ask = ask;
+                               record.perp_exchange_time_ms = exchange_time_ms;
+                               record.perp_receive_time_ns = receive_time_ns;
+                               record.perp_live = live;
+                             }
+                             record.complete = record.spot_live && record.perp_live;
+                             if (!record.complete)
+                             {
+                               // Nothing is derived from a leg that is not live
+                               record.basis = 0.0;
+                               record.basis_bps = 0.0;
+                               record.sell_perp_buy_spot = 0.0;
+                               record.buy_perp_sell_spot = 0.0;
+                               record.leg_skew_ns = 0;
+                               return;
+                             }
+                             const double spot_mid = (record.spot_bid + record.spot_ask) / 2.0;
+                             const double perp_mid = (record.perp_bid + record.perp_ask) / 2.0;
+                             record.basis = perp_mid - spot_mid;
+                             record.basis_bps = spot_mid > 0.0 ? record.basis / spot_mid * 1e4 : 0.0;
+                             record.sell_perp_buy_spot = record.perp_bid - record.spot_ask;
+                             record.buy_perp_sell_spot = record.perp_ask - record.spot_bid;
+                             record.leg_skew_ns = record.perp_receive_time_ns - record.spot_receive_time_ns;
+                           });
+      }
+
+      bool BasisView::read(const std::string &asset, BasisRecord &out) const
+      {
+        const Pair *pair = nullptr;
+        {
+          std::lock_guard<std::mutex> lock(pairs_mutex_);
+          auto it = pairs_.find(asset);
+          if (it != pairs_.end())
+          {
+            pair = it->second.get();
+          }
+        }
+        if (!pair || pair->version() == 0)
+        {
+          return false;
+        }
+        out = pair->read();
+        return out.complete;
+      }
+
+      nlohmann::json BasisView::get_stats() const
+      {
+        std::lock_guard<std::mutex> lock(pairs_mutex_);
+        nlohmann::json stats = nlohmann::json::array();
+        for (const auto &item : pairs_)
+        {
+          BasisRecord record = item.second->read();
+          stats.push_back({{"asset", item.first},
+                           {"complete", record.complete},
+                           {"spot_live", record.spot_live},
+                           {"perp_live", record.perp_live},
+                           {"updates", item.second->version()},
+                           {"spot_bid", record.spot_bid},
+                           {"spot_ask", record.spot_ask},
+                           {"perp_bid", record.perp_bid},
+                           {"perp_ask", record.perp_ask},
+                           {"basis", record.basis},
+                           {"basis_bps", record.basis_bps},
+                           {"leg_skew_ns", record.leg_skew_ns}});
+        }
+        return stats;
+      }
+
+    } // namespace gateio
+  } // namespace gateway
+} // namespace singular
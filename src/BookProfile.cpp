@@ -0,0 +1,237 @@
+#include <cstdlib>
+#include <initializer_list>
+#include <sstream>
+#include <vector>
+
+#include "gateio/include/BookProfile.h"
+#include <singular/utility/include/LatencyLogger.h>
+
+namespace singular
+{
+  namespace gateway
+  {
+    namespace gateio
+    {
+
+      namespace
+      {
+        // Returns the allowed value closest to wanted
+        int closest(int wanted, std::initializer_list<int> allowed)
+        {
+          int best = *allowed.begin();
+          for (int value : allowed)
+          {
+            if (std::abs(value - wanted) < std::abs(best - wanted))
+            {
+              best = value;
+            }
+          }
+          return best;
+        }
+
+        bool is_number(const std::string &text)
+        {
+          return !text.empty() && text.find_first_not_of("0123456789") == std::string::npos;
+        }
+      }
+
+      bool BookProfile::parse(const std::string &text, BookProfile &out)
+      {
+        std::vector<std::string> parts;
+        std::stringstream stream(text);
+        std::string part;
+        while (std::getline(stream, part, ':'))
+        {
+          parts.push_back(part);
+        }
+        if (parts.empty())
+        {
+          return false;
+        }
+
+        BookProfile profile;
+        if (parts[0] == "delta")
+        {
+          profile.kind = Kind::DELTA;
+        }
+        else if (parts[0] == "snapshot")
+        {
+          profile.kind = Kind::SNAPSHOT;
+        }
+        else if (parts[0] == "obu")
+        {
+          profile.kind = Kind::OBU;
+          profile.depth = 50;
+        }
+        else
+        {
+          return false;
+        }
+
+        for (size_t i = 1; i < parts.size(); ++i)
+        {
+          if (is_number(parts[i]))
+          {
+            profile.depth = std::atoi(parts[i].c_str());
+          }
+          else if (parts[i].size() > 2 && parts[i].compare(parts[i].size() - 2, 2, "ms") == 0)
+          {
+            profile.interval = parts[i];
+          }
+          else
+          {
+            return false;
+          }
+        }
+        out = profile;
+        return true;
+      }
+
+      std::string BookProfile::to_string() const
+      {
+        switch (kind)
+        {
+        case Kind::SNAPSHOT:
+          return "snapshot:" + interval + ":" + std::to_string(depth);
+        case Kind::OBU:
+          return "obu:" + std::to_string(depth);
+        default:
+          return "delta:" + interval + ":" + std::to_string(depth);
+        }
+      }
+
+      BookProfile BookProfile::normalized(const std::string &market) const
+      {
+        BookProfile profile = *this;
+        const bool spot = market == "SPOT";
+        switch (kind)
+        {
+        case Kind::DELTA:
+          if (spot)
+          {
+            // spot.order_book_update has no depth parameter; 20ms streams the top 20 only
+            profile.interval = interval == "20ms" ? "20ms" : "100ms";
+            profile.depth = interval == "20ms" ? 20 : 100;
+          }
+          else
+          {
+            profile.interval = interval == "20ms" ? "20ms" : "100ms";
+            profile.depth = profile.interval == "20ms" ? 20 : closest(depth, {20, 50, 100});
+          }
+          break;
+        case Kind::SNAPSHOT:
+          if (spot)
+          {
+            profile.interval = interval == "1000ms" ? "1000ms" : "100ms";
+            profile.depth = closest(depth, {5, 10, 20, 50, 100});
+          }
+          else
+          {
+            profile.interval = "0";
+            profile.depth = closest(depth, {1, 5, 10, 20, 50, 100});
+          }
+          break;
+        case Kind::OBU:
+          profile.interval.clear();
+          profile.depth = closest(depth, {50, 400});
+          break;
+        }
+        return profile;
+      }
+
+      std::string BookProfile::channel(const std::string &market) const
+      {
+        const std::string prefix = market == "SPOT" ? "spot." : "futures.";
+        switch (kind)
+        {
+        case Kind::SNAPSHOT:
+          return prefix + "order_book";
+        case Kind::OBU:
+          return prefix + "obu";
+        default:
+          return prefix + "order_book_update";
+        }
+      }
+
+      nlohmann::json BookProfile::payload(const std::string &pair, const std::string &market) const
+      {
+        const bool spot = market == "SPOT";
+        const std::string level = std::to_string(depth);
+        switch (kind)
+        {
+        case Kind::SNAPSHOT:
+          return nlohmann::json::array({pair, level, interval});
+        case Kind::OBU:
+          return nlohmann::json::array({"ob." + pair + "." + level});
+        default:
+          return spot ? nlohmann::json::array({pair, interval})
+                      : nlohmann::json::array({pair, interval, level});
+        }
+      }
+
+      BookProfileTable::BookProfileTable() = default;
+
+      void BookProfileTable::load(const std::string &default_profile, const std::string &overrides)
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!default_profile.empty() && !BookProfile::parse(default_profile, default_))
+        {
+          singular::utility::log_event(log_service_name, singular::utility::OEMSEvent::WS_CONNECTION_ERROR, "Invalid book profile " + default_profile + ", using " + default_.to_string());
+        }
+
+        std::stringstream stream(overrides);
+        std::string entry;
+        while (std::getline(stream, entry, ';'))
+        {
+          if (entry.empty())
+          {
+            continue;
+          }
+          size_t separator = entry.find('=');
+          BookProfile profile;
+          if (separator == std::string::npos || !BookProfile::parse(entry.substr(separator + 1), profile))
+          {
+            singular::utility::log_event(log_service_name, singular::utility::OEMSEvent::WS_CONNECTION_ERROR, "Invalid book profile entry " + entry);
+            continue;
+          }
+          overrides_[entry.substr(0, separator)] = profile;
+        }
+      }
+
+      BookProfile BookProfileTable::resolve(const std::string &symbol) const
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = overrides_.find(symbol);
+        BookProfile profile = it == overrides_.end() ? default_ : it->second;
+        size_t at = symbol.find('@');
+        return profile.normalized(at == std::string::npos ? "" : symbol.substr(at + 1));
+      }
+
+      void BookProfileTable::set(const std::string &symbol, const BookProfile &profile)
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        overrides_[symbol] = profile;
+      }
+
+      void BookProfileTable::reset(const std::string &symbol)
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        overrides_.erase(symbol);
+      }
+
+      nlohmann::json BookProfileTable::get_stats() const
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        nlohmann::json stats;
+        stats["default"] = default_.to_string();
+        stats["overrides"] = nlohmann::json::object();
+        for (const auto &entry : overrides_)
+        {
+          stats["overrides"][entry.first] = entry.second.to_string();
+        }
+        return stats;
+      }
+
+    } // namespace gateio
+  } // namespace gateway
+} // namespace singular
@@ -0,0 +1,305 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+#include "gateio/include/CaptureReplay.h"
+#include <singular/utility/include/LatencyLogger.h>
+
+namespace singular
+{
+  namespace gateway
+  {
+    namespace gateio
+    {
+
+      namespace
+      {
+        constexpr size_t RECORD_ALIGNMENT = 8;
+
+        size_t aligned(size_t size)
+        {
+          return (size + RECORD_ALIGNMENT - 1) & ~(RECORD_ALIGNMENT - 1);
+        }
+
+        int64_t now_ns()
+        {
+          return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                     std::chrono::steady_clock::now().time_since_epoch())
+              .count();
+        }
+      }
+
+      CaptureReader::CaptureReader(std::vector<std::string> paths)
+          : paths_(std::move(paths))
+      {
+      }
+
+      CaptureReader::~CaptureReader()
+      {
+        unmap();
+      }
+
+      void CaptureReader::unmap()
+      {
+        if (mapped_)
+        {
+          ::munmap(const_cast<char *>(mapped_), mapped_size_);
+          mapped_ = nullptr;
+          mapped_size_ = 0;
+        }
+      }
+
+      bool CaptureReader::open_next()
+      {
+        unmap();
+        while (next_path_ < paths_.size())
+        {
+          const std::string &path = paths_[next_path_++];
+          int fd = ::open(path.c_str(), O_RDONLY);
+          struct stat info;
+          if (fd < 0 || ::fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(CaptureFileHeader))
+          {
+            singular::utility::log_event(log_service_name, singular::utility::OEMSEvent::WS_CONNECTION_ERROR, "Skipping unreadable capture segment " + path);
+            if (fd >= 0)
+            {
+              ::close(fd);
+            }
+            continue;
+          }
+          void *mapped = ::mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+          ::close(fd);
+          if (mapped == MAP_FAILED)
+          {
+            singular::utility::log_event(log_service_name, singular::utility::OEMSEvent::WS_CONNECTION_ERROR, "Unable to map capture segment " + path);
+            continue;
+          }
+          ::madvise(mapped, info.st_size, MADV_SEQUENTIAL);
+
+          CaptureFileHeader header;
+          std::memcpy(&header, mapped, sizeof(header));
+          if (std::memcmp(header.magic, "GIOCAP1", 8) != 0 || header.version != 1)
+          {
+            singular::utility::log_event(log_service_name, singular::utility::OEMSEvent::WS_CONNECTION_ERROR, "Not a capture segment " + path);
+            ::munmap(mapped, info.st_size);
+            continue;
+          }
+
+          mapped_ = static_cast<const char *>(mapped);
+          mapped_size_ = info.st_size;
+          offset_ = aligned(header.header_size);
+          tsc_ticks_per_ns_ = header.tsc_ticks_per_ns > 0.0 ? header.tsc_ticks_per_ns : 1.0;
+          ++segments_read_;
+          return true;
+        }
+        return false;
+      }
+
+      bool CaptureReader::read_record(Pending &frame)
+      {
+        while (true)
+        {
+          // A segment still being written is zero filled past its last record
+          if (!mapped_ || offset_ + sizeof(CaptureRecordHeader) > mapped_size_)
+          {
+            if (!open_next())
+            {
+              return false;
+            }
+            continue;
+          }
+
+          CaptureRecordHeader header;
+          std::memcpy(&header, mapped_ + offset_, sizeof(header));
+          const size_t size = aligned(sizeof(header) + header.length);
+          if ((header.length == 0 && header.tsc == 0) || offset_ + sizeof(header) + header.length > mapped_size_)
+          {
+            offset_ = mapped_size_;
+            continue;
+          }
+
+          const char *payload = mapped_ + offset_ + sizeof(header);
+          offset_ += size;
+          bytes_read_ += size;
+
+          if (header.kind == CaptureRecordHeader::CONNECTION)
+          {
+            connections_[header.connection].assign(payload, header.length);
+            continue;
+          }
+
+          frame.sequence = sequence_++;
+          frame.connection_id = header.connection;
+          frame.tsc = header.tsc;
+          frame.wall_ns = header.wall_ns;
+          frame.payload.assign(payload, header.length);
+          return true;
+        }
+      }
+
+      bool CaptureReader::next(Frame &frame)
+      {
+        const auto later = [](const Pending &a, const Pending &b)
+        {
+          return a.wall_ns != b.wall_ns ? a.wall_ns > b.wall_ns : a.sequence > b.sequence;
+        };
+
+        // Keep a full window buffered, so a frame the writer stored a batch late still
+        // comes out ahead of the frames of other connections it was received before
+        while (!exhausted_ && window_.size() < std::max<size_t>(connections_.size(), 1) * FeedCapture::WRITE_BATCH)
+        {
+          window_.emplace_back();
+          window_.back().payload.swap(current_.payload); // reuse the buffer of the frame handed out last
+          if (!read_record(window_.back()))
+          {
+            window_.pop_back();
+            exhausted_ = true;
+            break;
+          }
+          const int64_t wall_ns = window_.back().wall_ns;
+          if (wall_ns < newest_wall_ns_)
+          {
+            ++frames_reordered_;
+          }
+          newest_wall_ns_ = std::max(newest_wall_ns_, wall_ns);
+          std::push_heap(window_.begin(), window_.end(), later);
+        }
+        if (window_.empty())
+        {
+          return false;
+        }
+
+        std::pop_heap(window_.begin(), window_.end(), later);
+        current_ = std::move(window_.back());
+        window_.pop_back();
+        if (current_.wall_ns < released_wall_ns_)
+        {
+          ++frames_late_;
+        }
+        released_wall_ns_ = std::max(released_wall_ns_, current_.wall_ns);
+
+        auto name = connections_.find(current_.connection_id);
+        frame.connection = name == connections_.end() ? &unknown_connection_ : &name->second;
+        frame.connection_id = current_.connection_id;
+        frame.tsc = current_.tsc;
+        frame.wall_ns = current_.wall_ns;
+        frame.data = current_.payload.data();
+        frame.size = current_.payload.size();
+        return true;
+      }
+
+      CaptureReplayer::CaptureReplayer(Mode mode, double speed)
+          : mode_(mode),
+            speed_(mode == Mode::SCALED && speed > 0.0 ? speed : 1.0)
+      {
+      }
+
+      bool CaptureReplayer::parse_mode(const std::string &text, Mode &mode)
+      {
+        if (text == "fast")
+        {
+          mode = Mode::FAST;
+        }
+        else if (text == "realtime")
+        {
+          mode = Mode::REAL_TIME;
+        }
+        else if (text == "scaled")
+        {
+          mode = Mode::SCALED;
+        }
+        else
+        {
+          return false;
+        }
+        return true;
+      }
+
+      void CaptureReplayer::pace(int64_t recorded_offset_ns, int64_t replay_start_ns)
+      {
+        const int64_t due_ns = replay_start_ns + static_cast<int64_t>(recorded_offset_ns / speed_);
+        int64_t now = now_ns();
+        // Sleep for the bulk of long gaps, spin the last stretch to keep the schedule tight
+        if (due_ns - now > 200000)
+        {
+          std::this_thread::sleep_for(std::chrono::nanoseconds(due_ns - now - 100000));
+        }
+        while ((now = now_ns()) < due_ns)
+        {
+        }
+        stages_["lateness"].record(static_cast<uint64_t>(now - due_ns));
+      }
+
+      uint64_t CaptureReplayer::run(CaptureReader &reader, const Handler &handler)
+      {
+        LatencyHistogram &read_stage = stages_["read"];
+        LatencyHistogram &handle_stage = stages_["handle"];
+        std::string payload;
+        CaptureReader::Frame frame;
+
+        const int64_t start_ns = now_ns();
+        int64_t first_wall_ns = 0;
+        int64_t last_wall_ns = 0;
+
+        int64_t read_start = now_ns();
+        while (reader.next(frame))
+        {
+          payload.assign(frame.data, frame.size);
+          int64_t read_end = now_ns();
+          read_stage.record(static_cast<uint64_t>(read_end - read_start));
+
+          // A frame stamped behind one already replayed is due at once
+          if (frames_ == 0)
+          {
+            first_wall_ns = frame.wall_ns;
+          }
+          last_wall_ns = std::max(last_wall_ns, frame.wall_ns);
+          if (mode_ != Mode::FAST)
+          {
+            pace(last_wall_ns - first_wall_ns, start_ns);
+          }
+
+          int64_t handle_start = now_ns();
+          handler(*frame.connection, payload);
+          read_start = now_ns();
+          handle_stage.record(static_cast<uint64_t>(read_start - handle_start));
+
+          ++frames_;
+          bytes_ += frame.size;
+          ++frames_per_connection_[*frame.connection];
+        }
+
+        elapsed_ns_ = now_ns() - start_ns;
+        recorded_span_ns_ = last_wall_ns - first_wall_ns;
+        return frames_;
+      }
+
+      nlohmann::json CaptureReplayer::get_stats() const
+      {
+        nlohmann::json stats;
+        const double seconds = elapsed_ns_ / 1e9;
+        stats["mode"] = mode_ == Mode::FAST ? "fast" : mode_ == Mode::REAL_TIME ? "realtime"
+                                                                                 : "scaled";
+        stats["speed"] = speed_;
+        stats["frames"] = frames_;
+        stats["bytes"] = bytes_;
+        stats["elapsed_s"] = seconds;
+        stats["recorded_span_s"] = recorded_span_ns_ / 1e9;
+        stats["frames_per_s"] = seconds > 0.0 ? frames_ / seconds : 0.0;
+        stats["mb_per_s"] = seconds > 0.0 ? bytes_ / seconds / 1e6 : 0.0;
+        stats["connections"] = frames_per_connection_;
+        stats["stages_ns"] = nlohmann::json::object();
+        for (const auto &entry : stages_)
+        {
+          stats["stages_ns"][entry.first] = entry.second.to_json();
+        }
+        return stats;
+      }
+
+    } // namespace gateio
+  } // namespace gateway
+} // namespace singular
@@ -0,0 +1,130 @@
+#include <algorithm>
+#include <limits>
+
+#include "gateio/include/ClockEstimator.h"
+
+namespace singular
+{
+  namespace gateway
+  {
+    namespace gateio
+    {
+
+      namespace
+      {
+        constexpr double LATENCY_SMOOTHING = 0.05;
+      }
+
+      ClockEstimator::ClockEstimator(const std::string &name)
+          : name_(name)
+      {
+        bucket_min_delay_.fill(std::numeric_limits<int64_t>::max());
+      }
+
+      int64_t ClockEstimator::window_min_delay() const
+      {
+        int64_t minimum = std::numeric_limits<int64_t>::max();
+        for (int64_t delay : bucket_min_delay_)
+        {
+          minimum = std::min(minimum, delay);
+        }
+        return minimum;
+      }
+
+      int64_t ClockEstimator::on_message(int64_t exchange_time_ms, int64_t receive_wall_ns)
+      {
+        if (exchange_time_ms <= 0)
+        {
+          return 0;
+        }
+        const int64_t raw_delay = receive_wall_ns - exchange_time_ms * 1000000;
+
+        // Rolling minimum of the raw delay, bucketed so old minima age out
+        const size_t bucket = static_cast<size_t>((receive_wall_ns / DELAY_BUCKET_NS) % DELAY_BUCKETS);
+        const int64_t bucket_start = receive_wall_ns - receive_wall_ns % DELAY_BUCKET_NS;
+        if (bucket_start_ns_[bucket] != bucket_start)
+        {
+          bucket_start_ns_[bucket] = bucket_start;
+          bucket_min_delay_[bucket] = raw_delay;
+        }
+        else
+        {
+          bucket_min_delay_[bucket] = std::min(bucket_min_delay_[bucket], raw_delay);
+        }
+
+        int64_t latency = 0;
+        snapshot_.write([&](ClockSnapshot &snapshot)
+                        {
+                          if (!snapshot.offset_from_ping)
+                          {
+                            snapshot.offset_ns = -window_min_delay();
+                          }
+                          // Timestamps are whole milliseconds, so small negatives are rounding
+                          latency = std::max<int64_t>(raw_delay + snapshot.offset_ns, 0);
+                          snapshot.last_latency_ns = latency;
+                          snapshot.latency_ewma_ns = snapshot.samples == 0 ? latency
+                                                                           : snapshot.latency_ewma_ns + LATENCY_SMOOTHING * (latency - snapshot.latency_ewma_ns);
+                          snapshot.last_sample_wall_ns = receive_wall_ns;
+                          ++snapshot.samples;
+                          latency_.record(static_cast<uint64_t>(latency));
+                        });
+        return latency;
+      }
+
+      void ClockEstimator::on_pong(int64_t send_wall_ns, int64_t receive_wall_ns, int64_t server_time_ms)
+      {
+        const int64_t rtt = receive_wall_ns - send_wall_ns;
+        if (rtt < 0 || server_time_ms <= 0)
+        {
+          return;
+        }
+        PingSample sample;
+        sample.rtt_ns = rtt;
+        sample.offset_ns = server_time_ms * 1000000 - (send_wall_ns + receive_wall_ns) / 2;
+        pings_[ping_count_++ % PING_WINDOW] = sample;
+
+        // The exchange with the lowest RTT bounds the offset error best
+        const size_t filled = std::min(ping_count_, PING_WINDOW);
+        const PingSample *best = &pings_[0];
+        for (size_t i = 1; i < filled; ++i)
+        {
+          if (pings_[i].rtt_ns < best->rtt_ns)
+          {
+            best = &pings_[i];
+          }
+        }
+
+        snapshot_.write([&](ClockSnapshot &snapshot)
+                        {
+                          snapshot.offset_ns = best->offset_ns;
+                          snapshot.offset_from_ping = true;
+                          snapshot.min_rtt_ns = best->rtt_ns;
+                          snapshot.last_rtt_ns = rtt;
+                          ++snapshot.pings;
+                        });
+      }
+
+      nlohmann::json ClockEstimator::get_stats()
+      {
+        nlohmann::json latency;
+        ClockSnapshot snapshot;
+        snapshot_.inspect([&](const ClockSnapshot &current)
+                          {
+                            snapshot = current;
+                            latency = latency_.to_json();
+                          });
+        return {{"name", name_},
+                {"offset_ms", snapshot.offset_ns / 1e6},
+                {"offset_source", snapshot.offset_from_ping ? "ping" : "min_delay"},
+                {"min_rtt_ms", snapshot.min_rtt_ns / 1e6},
+                {"last_rtt_ms", snapshot.last_rtt_ns / 1e6},
+                {"latency_ms", snapshot.last_latency_ns / 1e6},
+                {"latency_ewma_ms", snapshot.latency_ewma_ns / 1e6},
+                {"latency_ns", latency},
+                {"samples", snapshot.samples},
+                {"pings", snapshot.pings}};
+      }
+
+    } // namespace gateio
+  } // namespace gateway
+} // namespace singular
@@ -0,0 +1,182 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+
+#include "gateio/include/FeedArbiter.h"
+
+namespace singular
+{
+  namespace gateway
+  {
+    namespace gateio
+    {
+
+      namespace
+      {
+        int64_t now_ns()
+        {
+          return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                     std::chrono::steady_clock::now().time_since_epoch())
+              .count();
+        }
+
+        // Position just after key, searched from start, npos when missing
+        size_t value_at(const std::string &frame, const char *key, size_t start)
+        {
+          size_t at = frame.find(key, start);
+          return at == std::string::npos ? at : at + std::strlen(key);
+        }
+
+        uint64_t integer_at(const std::string &frame, size_t at)
+        {
+          return std::strtoull(frame.c_str() + at, nullptr, 10);
+        }
+      }
+
+      FeedArbiter::FeedArbiter(const std::string &name, size_t lines)
+          : name_(name),
+            lines_(std::min(std::max<size_t>(lines, 1), MAX_LINES))
+      {
+        for (Key &key : keys_)
+        {
+          key.stream.reserve(64);
+        }
+      }
+
+      bool FeedArbiter::read_key(const std::string &frame, Key &key)
+      {
+        size_t channel = value_at(frame, "\"channel\":\"", 0);
+        size_t result = value_at(frame, "\"result\":", 0);
+        if (channel == std::string::npos || result == std::string::npos || frame.find("\"event\":\"update\"") == std::string::npos)
+        {
+          return false;
+        }
+
+        // Books and book tickers name the symbol "s", snapshots and futures trades "contract", spot trades "currency_pair"
+        size_t symbol = value_at(frame, "\"s\":\"", result);
+        if (symbol == std::string::npos)
+        {
+          symbol = value_at(frame, "\"contract\":\"", result);
+        }
+        if (symbol == std::string::npos)
+        {
+          symbol = value_at(frame, "\"currency_pair\":\"", result);
+        }
+        if (symbol == std::string::npos)
+        {
+          return false;
+        }
+
+        key.first = 0;
+        size_t id = value_at(frame, "\"u\":", result);
+        if (id != std::string::npos)
+        {
+          size_t first = value_at(frame, "\"U\":", result);
+          key.first = first == std::string::npos ? 0 : integer_at(frame, first);
+        }
+        else if ((id = value_at(frame, "\"lastUpdateId\":", result)) == std::string::npos)
+        {
+          id = value_at(frame, "\"id\":", result);
+        }
+        if (id == std::string::npos)
+        {
+          return false;
+        }
+        key.last = integer_at(frame, id);
+
+        key.stream.assign(frame, channel, frame.find('"', channel) - channel);
+        key.stream.push_back('|');
+        key.stream.append(frame, symbol, frame.find('"', symbol) - symbol);
+        return key.last != 0;
+      }
+
+      bool FeedArbiter::admit(size_t line, bool keyed, const Key &key)
+      {
+        Line &stats = line_stats_[line];
+        ++stats.frames;
+        if (!keyed)
+        {
+          // No id to order by: follow the lowest open line, line 0 while none is open
+          size_t preferred = 0;
+          while (preferred < lines_ && !line_stats_[preferred].open)
+          {
+            ++preferred;
+          }
+          if (line != (preferred == lines_ ? 0 : preferred))
+          {
+            return false;
+          }
+          ++stats.untracked;
+          return true;
+        }
+
+        Stream &stream = streams_[key.stream];
+        uint64_t &line_last = stream.line_last[line];
+        // This line skipped ids, but nothing is missing from what was applied
+        if (key.first != 0 && line_last != 0 && key.first > line_last + 1 && key.first <= stream.last + 1)
+        {
+          ++stats.gap_fills;
+        }
+        line_last = std::max(line_last, key.last);
+
+        if (key.last <= stream.last)
+        {
+          ++stats.duplicates;
+          if (key.last == stream.last)
+          {
+            lead_.record(static_cast<uint64_t>(std::max<int64_t>(now_ns() - stream.last_ns, 0)));
+          }
+          return false;
+        }
+        if (key.first != 0 && stream.last != 0 && key.first > stream.last + 1)
+        {
+          ++gaps_;
+        }
+        stream.last = key.last;
+        stream.last_ns = now_ns();
+        ++stats.wins;
+        return true;
+      }
+
+      void FeedArbiter::set_line_open(size_t line, bool open)
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (line < lines_)
+        {
+          line_stats_[line].open = open;
+        }
+      }
+
+      nlohmann::json FeedArbiter::get_stats() const
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        nlohmann::json stats;
+        stats["name"] = name_;
+        stats["streams"] = streams_.size();
+        stats["gaps"] = gaps_;
+        stats["lead_ns"] = lead_.to_json();
+        stats["lines"] = nlohmann::json::array();
+        uint64_t keyed = 0;
+        for (size_t i = 0; i < lines_; ++i)
+        {
+          keyed += line_stats_[i].wins;
+        }
+        for (size_t i = 0; i < lines_; ++i)
+        {
+          const Line &line = line_stats_[i];
+          stats["lines"].push_back({{"line", i},
+                                    {"open", line.open},
+                                    {"frames", line.frames},
+                                    {"wins", line.wins},
+                                    {"duplicates", line.duplicates},
+                                    {"win_rate", keyed ? static_cast<double>(line.wins) / keyed : 0.0},
+                                    {"gap_fills", line.gap_fills},
+                                    {"untracked", line.untracked}});
+        }
+        return stats;
+      }
+
+    } // namespace gateio
+  } // namespace gateway
+} // namespace singular
@@ -0,0 +1,251 @@
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "gateio/include/FeedCapture.h"
+#include "gateio/include/Tsc.h"
+#include <singular/utility/include/LatencyLogger.h>
+
+namespace singular
+{
+  namespace gateway
+  {
+    namespace gateio
+    {
+
+      namespace
+      {
+        constexpr size_t RECORD_ALIGNMENT = 8;
+
+        size_t aligned(size_t size)
+        {
+          return (size + RECORD_ALIGNMENT - 1) & ~(RECORD_ALIGNMENT - 1);
+        }
+      }
+
+      FeedCapture::FeedCapture(const std::string &directory, size_t segment_bytes, size_t queue_capacity)
+          : directory_(directory),
+            segment_bytes_(std::max<size_t>(segment_bytes, 1 << 20)),
+            queue_capacity_(queue_capacity)
+      {
+        tsc_ticks_per_ns(); // calibrate before the first frame, not on a socket thread
+        if (!open_segment())
+        {
+          enabled_ = false;
+          return;
+        }
+        writer_ = std::thread([this]()
+                              { writer_loop(); });
+      }
+
+      FeedCapture::~FeedCapture()
+      {
+        running_ = false;
+        if (writer_.joinable())
+        {
+          writer_.join();
+        }
+        close_segment();
+      }
+
+      uint16_t FeedCapture::add_connection(const std::string &name)
+      {
+        std::lock_guard<std::mutex> lock(add_mutex_);
+        size_t id = connection_count_.load(std::memory_order_relaxed);
+        if (id >= MAX_CONNECTIONS)
+        {
+          singular::utility::log_event(log_service_name, singular::utility::OEMSEvent::WS_CONNECTION_ERROR, "Feed capture connection limit reached, " + name + " is not captured");
+          return MAX_CONNECTIONS;
+        }
+        connections_[id] = std::make_unique<Connection>(name, queue_capacity_);
+        connection_count_.store(id + 1, std::memory_order_release);
+        return static_cast<uint16_t>(id);
+      }
+
+      void FeedCapture::record(uint16_t connection, const std::string &frame)
+      {
+        if (connection >= MAX_CONNECTIONS || !enabled_.load(std::memory_order_relaxed))
+        {
+          return;
+        }
+        Connection &owner = *connections_[connection];
+        const uint64_t tsc = read_tsc();
+        const bool queued = owner.queue.produce_one([&](PendingFrame &slot)
+                                                    {
+                                                      slot.tsc = tsc;
+                                                      slot.wall_ns = wall_clock_ns();
+                                                      slot.payload.assign(frame);
+                                                    });
+        if (queued)
+        {
+          owner.captured.fetch_add(1, std::memory_order_relaxed);
+        }
+        else
+        {
+          owner.dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+      }
+
+      void FeedCapture::writer_loop()
+      {
+        size_t announced = 0;
+        while (true)
+        {
+          const bool stopping = !running_.load();
+          const size_t count = connection_count_.load(std::memory_order_acquire);
+          for (; announced < count; ++announced)
+          {
+            append(static_cast<uint16_t>(announced), CaptureRecordHeader::CONNECTION, read_tsc(), wall_clock_ns(), connections_[announced]->name);
+          }
+
+          size_t written = 0;
+          for (size_t i = 0; i < count; ++i)
+          {
+            // Bounded per pass so one busy connection cannot starve the others
+            for (size_t n = 0; n < WRITE_BATCH; ++n)
+            {
+              bool took = connections_[i]->queue.consume_one([&](PendingFrame &frame)
+                                                             { append(static_cast<uint16_t>(i), CaptureRecordHeader::FRAME, frame.tsc, frame.wall_ns, frame.payload); });
+              if (!took)
+              {
+                break;
+              }
+              ++written;
+            }
+          }
+
+          if (written == 0)
+          {
+            if (stopping)
+            {
+              return;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+          }
+        }
+      }
+
+      bool FeedCapture::open_segment()
+      {
+        segment_path_ = directory_ + "/gateio-" + std::to_string(wall_clock_ns()) + "-" + std::to_string(segment_index_++) + ".cap";
+        fd_ = ::open(segment_path_.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd_ < 0 || ::ftruncate(fd_, static_cast<off_t>(segment_bytes_)) != 0)
+        {
+          singular::utility::log_event(log_service_name, singular::utility::OEMSEvent::WS_CONNECTION_ERROR, "Unable to create capture segment " + segment_path_ + ": " + std::strerror(errno));
+          if (fd_ >= 0)
+          {
+            ::close(fd_);
+            fd_ = -1;
+          }
+          return false;
+        }
+        void *mapped = ::mmap(nullptr, segment_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        if (mapped == MAP_FAILED)
+        {
+          singular::utility::log_event(log_service_name, singular::utility::OEMSEvent::WS_CONNECTION_ERROR, "Unable to map capture segment " + segment_path_ + ": " + std::strerror(errno));
+          ::close(fd_);
+          fd_ = -1;
+          return false;
+        }
+        mapped_ = static_cast<char *>(mapped);
+
+        CaptureFileHeader header{};
+        std::memcpy(header.magic, "GIOCAP1", 8);
+        header.version = 1;
+        header.header_size = sizeof(CaptureFileHeader);
+        header.start_wall_ns = wall_clock_ns();
+        header.start_tsc = read_tsc();
+        header.tsc_ticks_per_ns = tsc_ticks_per_ns();
+        std::memcpy(mapped_, &header, sizeof(header));
+        offset_ = aligned(sizeof(header));
+        ++segments_;
+
+        // Repeat the connection names so the segment stands alone
+        const size_t count = connection_count_.load(std::memory_order_acquire);
+        for (size_t i = 0; i < count; ++i)
+        {
+          append(static_cast<uint16_t>(i), CaptureRecordHeader::CONNECTION, header.start_tsc, header.start_wall_ns, connections_[i]->name);
+        }
+        return true;
+      }
+
+      void FeedCapture::close_segment()
+      {
+        if (!mapped_)
+        {
+          return;
+        }
+        ::msync(mapped_, offset_, MS_ASYNC);
+        ::munmap(mapped_, segment_bytes_);
+        mapped_ = nullptr;
+        // Trim the preallocated tail so readers see only written records
+        if (::ftruncate(fd_, static_cast<off_t>(offset_)) != 0)
+        {
+          singular::utility::log_event(log_service_name, singular::utility::OEMSEvent::WS_CONNECTION_ERROR, "Unable to trim capture segment " + segment_path_);
+        }
+        ::close(fd_);
+        fd_ = -1;
+      }
+
+      bool FeedCapture::append(uint16_t connection, uint8_t kind, uint64_t tsc, int64_t wall_ns, const std::string &payload)
+      {
+        const size_t size = aligned(sizeof(CaptureRecordHeader) + payload.size());
+        if (!enabled_.load(std::memory_order_relaxed) && !mapped_)
+        {
+          return false;
+        }
+        if (size > segment_bytes_ - aligned(sizeof(CaptureFileHeader)))
+        {
+          return false; // larger than a whole segment
+        }
+        if (!mapped_ || offset_ + size > segment_bytes_)
+        {
+          close_segment();
+          if (!open_segment())
+          {
+            enabled_ = false;
+            return false;
+          }
+        }
+
+        CaptureRecordHeader header{};
+        header.length = static_cast<uint32_t>(payload.size());
+        header.connection = connection;
+        header.kind = kind;
+        header.tsc = tsc;
+        header.wall_ns = wall_ns;
+        std::memcpy(mapped_ + offset_, &header, sizeof(header));
+        std::memcpy(mapped_ + offset_ + sizeof(header), payload.data(), payload.size());
+        offset_ += size;
+        bytes_written_.fetch_add(size, std::memory_order_relaxed);
+        return true;
+      }
+
+      nlohmann::json FeedCapture::get_stats() const
+      {
+        nlohmann::json stats;
+        stats["enabled"] = enabled_.load();
+        stats["directory"] = directory_;
+        stats["segments"] = segments_.load();
+        stats["bytes_written"] = bytes_written_.load();
+        stats["connections"] = nlohmann::json::array();
+        const size_t count = connection_count_.load(std::memory_order_acquire);
+        for (size_t i = 0; i < count; ++i)
+        {
+          const Connection &connection = *connections_[i];
+          stats["connections"].push_back({{"id", i},
+                                          {"name", connection.name},
+                                          {"captured", connection.captured.load()},
+                                          {"dropped", connection.dropped.load()},
+                                          {"queued", connection.queue.size()}});
+        }
+        return stats;
+      }
+
+    } // namespace gateio
+  } // namespace gateway
+} // namespace singular
@@ -0,0 +1,81 @@
+#include <algorithm>
+#include <future>
+#include <pthread.h>
+#include <sched.h>
+
+#include "gateio/include/FeedLoop.h"
+#include "gateio/include/Config.h"
+#include <singular/utility/include/LatencyLogger.h>
+
+namespace singular
+{
+  namespace gateway
+  {
+    namespace gateio
+    {
+
+      FeedLoop::FeedLoop(const std::string &name, int cpu)
+          : name_(name),
+            cpu_(cpu)
+      {
+        thread_.start(true, [this]()
+                      {
+                        // Thread names are limited to 15 characters
+                        pthread_setname_np(pthread_self(), name_.substr(0, 15).c_str());
+                        if (cpu_ < 0)
+                        {
+                          return 0;
+                        }
+                        cpu_set_t cpu_set;
+                        CPU_ZERO(&cpu_set);
+                        CPU_SET(cpu_, &cpu_set);
+                        if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpu_set) != 0)
+                        {
+                          singular::utility::log_event("GATEIO", singular::utility::OEMSEvent::WS_CONNECTION_ERROR, "Failed to pin " + name_ + " to CPU " + std::to_string(cpu_));
+                        }
+                        return 0; });
+      }
+
+      FeedLoop::~FeedLoop()
+      {
+        thread_.stop(true);
+      }
+
+      void run_in_loop_and_wait(const hv::EventLoopPtr &loop, const std::function<void()> &fn)
+      {
+        if (loop->isInLoopThread() || !loop->isRunning())
+        {
+          fn();
+          return;
+        }
+        std::promise<void> done;
+        std::future<void> finished = done.get_future();
+        loop->queueInLoop([&fn, &done]()
+                          {
+                            fn();
+                            done.set_value(); });
+        finished.wait();
+      }
+
+      std::vector<hv::EventLoopPtr> make_feed_loops(std::vector<std::unique_ptr<FeedLoop>> &owner, bool dedicated,
+                                                    const std::string &group, size_t count, const char *cpu_env,
+                                                    hv::EventLoopPtr &executor)
+      {
+        if (!dedicated)
+        {
+          return {executor};
+        }
+        std::vector<long> cpus = env_long_list(cpu_env);
+        std::vector<hv::EventLoopPtr> loops;
+        for (size_t i = 0; i < std::max<size_t>(count, 1); ++i)
+        {
+          int cpu = i < cpus.size() ? static_cast<int>(cpus[i]) : -1;
+          owner.push_back(std::make_unique<FeedLoop>("gio-" + group + std::to_string(i), cpu));
+          loops.push_back(owner.back()->loop());
+        }
+        return loops;
+      }
+
+    } // namespace gateio
+  } // namespace gateway
+} // namespace singular
@@ -0,0 +1,162 @@
+#include <chrono>
+
+#include "gateio/include/FundingTable.h"
+#include "gateio/include/InstrumentCatalog.h"
+
+namespace singular
+{
+  namespace gateway
+  {
+    namespace gateio
+    {
+
+      namespace
+      {
+        // Gate.io funds perpetuals every 8 hours unless the contract says otherwise
+        constexpr int64_t DEFAULT_FUNDING_INTERVAL_MS = 8 * 3600 * 1000LL;
+
+        // Ticker numbers arrive as strings; empty strings mean "not applicable"
+        bool read_number(const nlohmann::json &ticker, const char *field, double &out)
+        {
+          auto it = ticker.find(field);
+          if (it == ticker.end() || it->is_null())
+          {
+            return false;
+          }
+          if (it->is_string())
+          {
+            const std::string &text = it->get_ref<const std::string &>();
+            if (text.empty())
+            {
+              return false;
+            }
+            out = std::stod(text);
+            return true;
+          }
+          out = it->get<double>();
+          return true;
+        }
+      }
+
+      FundingTable::Entry *FundingTable::entry(const std::string &symbol)
+      {
+        std::lock_guard<std::mutex> lock(entries_mutex_);
+        auto &entry = entries_[symbol];
+        if (!entry)
+        {
+          entry = std::make_unique<Entry>();
+          entry->symbol_ = symbol;
+          CatalogEntry instrument;
+          if (InstrumentCatalog::instance().find(symbol, instrument))
+          {
+            entry->funding_interval_ms_ = instrument.funding_interval_s * 1000;
+            entry->funding_anchor_ms_ = instrument.funding_next_apply_s * 1000;
+          }
+          if (entry->funding_interval_ms_ <= 0)
+          {
+            entry->funding_interval_ms_ = DEFAULT_FUNDING_INTERVAL_MS;
+          }
+        }
+        return entry.get();
+      }
+
+      bool FundingTable::read(const std::string &symbol, FundingRecord &out) const
+      {
+        const Entry *entry = nullptr;
+        {
+          std::lock_guard<std::mutex> lock(entries_mutex_);
+          auto it = entries_.find(symbol);
+          if (it != entries_.end())
+          {
+            entry = it->second.get();
+          }
+        }
+        if (!entry || entry->version() == 0)
+        {
+          return false;
+        }
+        out = entry->read();
+        return true;
+      }
+
+      int64_t FundingTable::next_funding_time(const Entry &entry, int64_t now_ms) const
+      {
+        const int64_t interval = entry.funding_interval_ms_;
+        // Step forward from the catalog's next apply time; without one, funding falls on
+        // multiples of the interval since the epoch (00:00, 08:00, 16:00 UTC)
+        const int64_t anchor = entry.funding_anchor_ms_ > 0 ? entry.funding_anchor_ms_ : 0;
+        if (now_ms < anchor)
+        {
+          return anchor;
+        }
+        return anchor + ((now_ms - anchor) / interval + 1) * interval;
+      }
+
+      void FundingTable::on_ticker(Entry &entry, const nlohmann::json &ticker, int64_t exchange_time_ms, int64_t receive_time_ns)
+      {
+        entry.pushes_.fetch_add(1, std::memory_order_relaxed);
+        if (exchange_time_ms <= 0)
+        {
+          exchange_time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                 std::chrono::system_clock::now().time_since_epoch())
+                                 .count();
+        }
+        const FundingRecord current = entry.record_.read();
+        FundingRecord next = current;
+        read_number(ticker, "funding_rate", next.funding_rate);
+        read_number(ticker, "funding_rate_indicative", next.funding_rate_indicative);
+        read_number(ticker, "mark_price", next.mark_price);
+        read_number(ticker, "index_price", next.index_price);
+        read_number(ticker, "last", next.last_price);
+        read_number(ticker, "total_size", next.open_interest);
+        next.next_funding_time_ms = next_funding_time(entry, exchange_time_ms);
+
+        const bool changed = entry.version() == 0 ||
+                             next.funding_rate != current.funding_rate ||
+                             next.funding_rate_indicative != current.funding_rate_indicative ||
+                             next.mark_price != current.mark_price ||
+                             next.index_price != current.index_price ||
+                             next.last_price != current.last_price ||
+                             next.open_interest != current.open_interest ||
+                             next.next_funding_time_ms != current.next_funding_time_ms;
+        if (!changed)
+        {
+          return;
+        }
+
+        next.exchange_time_ms = exchange_time_ms;
+        next.receive_time_ns = receive_time_ns;
+        entry.record_.write([&next](FundingRecord &record)
+                            { record = next; });
+        entry.changes_.fetch_add(1, std::memory_order_relaxed);
+        if (on_change_)
+        {
+          on_change_(entry.symbol_, next);
+        }
+      }
+
+      nlohmann::json FundingTable::get_stats() const
+      {
+        std::lock_guard<std::mutex> lock(entries_mutex_);
+        nlohmann::json stats = nlohmann::json::array();
+        for (const auto &item : entries_)
+        {
+          const Entry &entry = *item.second;
+          FundingRecord record = entry.read();
+          stats.push_back({{"symbol", item.first},
+                           {"funding_rate", record.funding_rate},
+                           {"funding_rate_indicative", record.funding_rate_indicative},
+                           {"mark_price", record.mark_price},
+                           {"index_price", record.index_price},
+                           {"open_interest", record.open_interest},
+                           {"next_funding_time_ms", record.next_funding_time_ms},
+                           {"funding_interval_ms", entry.funding_interval_ms_},
+                           {"pushes", entry.pushes_.load()},
+                           {"changes", entry.changes_.load()}});
+        }
+        return stats;
+      }
+
+    } // namespace gateio
+  } // namespace gateway
+} // namespace singular
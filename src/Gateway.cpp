@@ -1,9 +1,18 @@
+#include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
 #include <iomanip>
 #include <sstream>
+#include <unistd.h>
 #include <cstdio>
+#include <cstring>
+#include <deque>
 
 #include "gateio/include/Gateway.h"
+#include "gateio/include/Tsc.h"
+#include "gateio/include/TlsSessionCache.h"
 #include <gateway/include/GatewayFactoryManager.h>
 
 namespace singular
@@ -35,6 +44,56 @@ namespace singular
           }
         };
         Registrar registrar;
+
+        // Private frames are decoded on the engine loop; the clock is fed on arrival
+        void sample_private_clock(ClockEstimator &clock, const std::string &frame)
+        {
+          static const char key[] = "\"time_ms\":";
+          size_t at = frame.find(key);
+          if (at != std::string::npos)
+          {
+            clock.on_message(std::strtoll(frame.c_str() + at + sizeof(key) - 1, nullptr, 10), wall_clock_ns());
+          }
+        }
+
+        // Gate.io sends futures ids as numbers and spot ids as strings
+        std::string id_string(const nlohmann::json &id)
+        {
+          if (id.is_string())
+          {
+            return id.get<std::string>();
+          }
+          return id.is_null() ? std::string() : id.dump();
+        }
+
+        int64_t steady_ns()
+        {
+          return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                     std::chrono::steady_clock::now().time_since_epoch())
+              .count();
+        }
+
+        // Resident set size of the process from /proc/self/statm, 0 where it is not available
+        int64_t resident_bytes()
+        {
+          std::ifstream statm("/proc/self/statm");
+          int64_t size = 0;
+          int64_t resident = 0;
+          if (!(statm >> size >> resident))
+          {
+            return 0;
+          }
+          return resident * sysconf(_SC_PAGESIZE);
+        }
+
+        double json_number(const nlohmann::json &value)
+        {
+          if (value.is_number())
+          {
+            return value.get<double>();
+          }
+          return value.is_string() ? std::strtod(value.get<std::string>().c_str(), nullptr) : 0.0;
+        }
       }
 
             Gateway::Gateway(hv::EventLoopPtr &executor,
@@ -52,6 +111,8 @@ namespace singular
             passphrase_(passphrase),
             mode_(mode)
       {
+        const int64_t construct_start_ns = steady_ns();
+        rss_before_bytes_ = resident_bytes();
         loadEnvFile(".env");
         private_spot_url=getExchangeUrl("GATEIO_ENV_MODE", "DEV_GATEIO_PRIVATE_SPOT_URL", "PROD_GATEIO_PRIVATE_SPOT_URL");
         public_spot_url=getExchangeUrl("GATEIO_ENV_MODE", "DEV_GATEIO_PUBLIC_SPOT_URL", "PROD_GATEIO_PUBLIC_SPOT_URL");
@@ -82,21 +143,127 @@ namespace singular
         }
         
 
-        public_client_spot = std::make_unique<singular::network::WebsocketClient>(
-            executor, public_spot_url);
-
-        public_client_futures_usdt = std::make_unique<singular::network::WebsocketClient>(
-            executor, public_futures_usdt_url);
-
-        public_client_futures_btc = std::make_unique<singular::network::WebsocketClient>(
-            executor, public_futures_btc_url);
+        engine_loop_ = executor;
+        // GATEIO_DEDICATED_LOOPS=0 puts every socket back on the shared executor
+        dedicated_loops_ = env_flag("GATEIO_DEDICATED_LOOPS", true);
+        // GATEIO_LAZY_CONNECT=1 connects each socket on first use and closes it after GATEIO_IDLE_TIMEOUT_MS unused
+        lazy_connect_ = env_flag("GATEIO_LAZY_CONNECT", false);
+        idle_timeout_ns_ = env_long("GATEIO_IDLE_TIMEOUT_MS", 60000) * 1000000;
+
+        // GATEIO_MD_CONFLATION=1 keeps only the latest book per symbol for slow consumers
+        md_conflator_ = std::make_shared<MarketDataConflator>(env_flag("GATEIO_MD_CONFLATION", false));
+
+        // Public sockets, decoders, snapshots and funding are shared by every gateway in the process
+        hub_ = MarketDataHub::acquire(executor, public_spot_url, public_futures_usdt_url, public_futures_btc_url, md_conflator_, hub_id_);
+        capture_ = hub_->capture();
+
+        // Private sessions ping on their own loop and are closed once pongs or frames stop coming back in time
+        Heartbeat::Options heartbeat_options;
+        heartbeat_options.interval_ms = static_cast<int>(env_long("GATEIO_PING_INTERVAL_MS", 5000));
+        heartbeat_options.stale_rtt_ms = static_cast<int>(env_long("GATEIO_STALE_RTT_MS", 2000));
+        heartbeat_options.stale_silence_ms = static_cast<int>(env_long("GATEIO_STALE_SILENCE_MS", 15000));
+
+        // Closed sessions are reopened with jittered exponential backoff, then logged in again
+        Reconnector::Options reconnect_options;
+        reconnect_options.initial_backoff_ms = static_cast<int>(env_long("GATEIO_RECONNECT_INITIAL_MS", 100));
+        reconnect_options.max_backoff_ms = static_cast<int>(env_long("GATEIO_RECONNECT_MAX_MS", 30000));
+
+        // GATEIO_SEND_COALESCING=1 writes the frames of one loop iteration in a single flush,
+        // GATEIO_SEND_PRIORITY=1 queues them per class so cancels go out ahead of pending places
+        SendQueue::Options send_options;
+        send_options.coalesce = env_flag("GATEIO_SEND_COALESCING", false);
+        send_options.prioritize = env_flag("GATEIO_SEND_PRIORITY", false);
+        send_options.max_pending = static_cast<size_t>(std::max<long>(env_long("GATEIO_SEND_MAX_PENDING", 1024), 1));
+        send_options.flush_batch = static_cast<size_t>(std::max<long>(env_long("GATEIO_SEND_FLUSH_BATCH", 64), 1));
 
         if (authenticate)
         {
-          private_spot_client_ = std::make_unique<singular::network::WebsocketClient>(
-              executor, private_spot_url);
-          private_futures_client_ = std::make_unique<singular::network::WebsocketClient>(
-              executor, private_futures_url);
+          hv::EventLoopPtr spot_loop = make_feed_loops("pspot", 1, "GATEIO_CPU_PRIVATE_SPOT", executor).front();
+          hv::EventLoopPtr futures_loop = make_feed_loops("pfut", 1, "GATEIO_CPU_PRIVATE_FUTURES", executor).front();
+          private_spot_loop_ = spot_loop;
+          private_futures_loop_ = futures_loop;
+          private_spot_client_ = WsClient::create(spot_loop, private_spot_url, PRIVATE_SPOT_CONNECTION, "spot.ping");
+          private_futures_client_ = WsClient::create(futures_loop, private_futures_url, PRIVATE_FUTURES_CONNECTION, "futures.ping");
+          private_spot_send_ = std::make_unique<SendQueue>(
+              spot_loop, PRIVATE_SPOT_CONNECTION, [this](const std::string &frame) { private_spot_client_->send(frame); }, send_options);
+          private_futures_send_ = std::make_unique<SendQueue>(
+              futures_loop, PRIVATE_FUTURES_CONNECTION, [this](const std::string &frame) { private_futures_client_->send(frame); }, send_options);
+          // Spot has no testnet, so GATEIO_PRIVATE_SPOT defaults off in DEV
+          private_spot_enabled_ = env_flag("GATEIO_PRIVATE_SPOT", !sim_trading);
+          order_routes_.set_senders(private_spot_enabled_ ? private_spot_send_.get() : nullptr, private_futures_send_.get());
+          private_spot_heartbeat_ = std::make_unique<Heartbeat>(
+              spot_loop, PRIVATE_SPOT_CONNECTION, "spot.ping",
+              [this](const std::string &frame) { private_spot_client_->send(frame); }, heartbeat_options);
+          private_futures_heartbeat_ = std::make_unique<Heartbeat>(
+              futures_loop, PRIVATE_FUTURES_CONNECTION, "futures.ping",
+              [this](const std::string &frame) { private_futures_client_->send(frame); }, heartbeat_options);
+          private_spot_heartbeat_->set_clock(&private_spot_clock_);
+          private_futures_heartbeat_->set_clock(&private_futures_clock_);
+          private_spot_heartbeat_->set_stale_callback([this](const std::string &reason)
+                                                      {
+                                                        health_.set_fault(GatewayHealth::PRIVATE_SPOT, true, "stale: " + reason);
+                                                        private_spot_client_->drop(); });
+          private_futures_heartbeat_->set_stale_callback([this](const std::string &reason)
+                                                         {
+                                                           health_.set_fault(GatewayHealth::PRIVATE_FUTURES, true, "stale: " + reason);
+                                                           private_futures_client_->drop(); });
+          // GATEIO_FUTURES_SESSIONS > 1 keeps that many futures order sessions logged in
+          size_t futures_sessions = static_cast<size_t>(std::max<long>(env_long("GATEIO_FUTURES_SESSIONS", 1), 1));
+          if (futures_sessions > 1)
+          {
+            std::vector<hv::EventLoopPtr> loops = make_feed_loops("pfsb", futures_sessions - 1, "GATEIO_CPU_PRIVATE_FUTURES_STANDBY", executor);
+            std::vector<hv::EventLoopPtr> standby_loops;
+            for (size_t i = 0; i < futures_sessions - 1; ++i)
+            {
+              standby_loops.push_back(loops[i % loops.size()]);
+            }
+            futures_standby_ = std::make_unique<RedundantSessions>(
+                standby_loops, private_futures_url, "futures.login", heartbeat_options, reconnect_options, send_options,
+                [this]() { return futures_login_frame(name_); },
+                [this](size_t source, SpscQueue<std::string> &inbox, const std::string &frame) { enqueue_private(source, inbox, frame); });
+            // A failure held for a copy that never comes is handed to the engine like any response
+            futures_standby_->set_release_callback([this]()
+                                                   { schedule_private_drain(); });
+          }
+          private_spot_reconnect_ = std::make_unique<Reconnector>(
+              spot_loop, PRIVATE_SPOT_CONNECTION, [this]() { connect_private_spot(); }, reconnect_options);
+          private_futures_reconnect_ = std::make_unique<Reconnector>(
+              futures_loop, PRIVATE_FUTURES_CONNECTION, [this]() { connect_private_futures(); }, reconnect_options);
+          // GATEIO_PRIVATE_STREAM_SESSION=1 moves the futures order and usertrade pushes to their
+          // own logged-in socket and loop, so a burst of fills never delays an order ack
+          if (env_flag("GATEIO_PRIVATE_STREAM_SESSION", false))
+          {
+            hv::EventLoopPtr stream_loop = make_feed_loops("pstr", 1, "GATEIO_CPU_PRIVATE_STREAM", executor).front();
+            private_stream_loop_ = stream_loop;
+            stream_login_id_ = name_ + "#stream";
+            private_stream_client_ = WsClient::create(stream_loop, private_futures_url, PRIVATE_FUTURES_STREAM_CONNECTION, "futures.ping");
+            private_stream_send_ = std::make_unique<SendQueue>(
+                stream_loop, PRIVATE_FUTURES_STREAM_CONNECTION, [this](const std::string &frame) { private_stream_client_->send(frame); }, send_options);
+            private_stream_heartbeat_ = std::make_unique<Heartbeat>(
+                stream_loop, PRIVATE_FUTURES_STREAM_CONNECTION, "futures.ping",
+                [this](const std::string &frame) { private_stream_client_->send(frame); }, heartbeat_options);
+            private_stream_heartbeat_->set_clock(&private_stream_clock_);
+            private_stream_heartbeat_->set_stale_callback([this](const std::string &reason)
+                                                          {
+                                                            health_.set_fault(GatewayHealth::PRIVATE_FUTURES_STREAM, true, "stale: " + reason);
+                                                            private_stream_client_->drop(); });
+            private_stream_reconnect_ = std::make_unique<Reconnector>(
+                stream_loop, PRIVATE_FUTURES_STREAM_CONNECTION, [this]() { connect_private_stream(); }, reconnect_options);
+          }
+          if (capture_)
+          {
+            private_spot_capture_id_ = capture_->add_connection(capture_name(PRIVATE_SPOT_CONNECTION));
+            private_futures_capture_id_ = capture_->add_connection(capture_name(PRIVATE_FUTURES_CONNECTION));
+            if (private_stream_client_)
+            {
+              private_stream_capture_id_ = capture_->add_connection(capture_name(PRIVATE_FUTURES_STREAM_CONNECTION));
+            }
+            if (futures_standby_)
+            {
+              futures_standby_->set_capture(capture_, [this](const std::string &session)
+                                            { return capture_name(session.c_str()); });
+            }
+          }
         }
         // Function to initialize maps with LOAD FACTOR and INITIALIZE MAP SIZE
         initializeMaps();
@@ -104,28 +271,176 @@ namespace singular
         spot_login_status = true;
         futures_login_status = true;
         latency_measure = singular::utility::LatencyManager::get();
+        construct_ns_ = steady_ns() - construct_start_ns;
+        rss_after_bytes_ = resident_bytes();
+      }
+
+      Gateway::~Gateway()
+      {
+        if (idle_timer_ != INVALID_TIMER_ID)
+        {
+          engine_loop_->killTimer(idle_timer_);
+        }
+        // Drops this gateway's subscriptions and the hub callbacks that point back at it
+        hub_->detach(hub_id_);
+        // Socket, heartbeat and reconnect callbacks run on the session loops and reach into
+        // most members, so the loops stop before the first member is destroyed
+        shutdown_sessions();
+        feed_loops_.clear();
+      }
+
+      void Gateway::shutdown_sessions()
+      {
+        if (futures_standby_)
+        {
+          futures_standby_->close();
+        }
+        auto shutdown = [](const hv::EventLoopPtr &loop, WsClient *client, Heartbeat *heartbeat, Reconnector *reconnect)
+        {
+          if (!client)
+          {
+            return;
+          }
+          run_in_loop_and_wait(loop, [client, heartbeat, reconnect]()
+                               {
+                                 reconnect->stop();
+                                 heartbeat->stop();
+                                 client->close(); });
+        };
+        shutdown(private_spot_loop_, private_spot_client_.get(), private_spot_heartbeat_.get(), private_spot_reconnect_.get());
+        shutdown(private_futures_loop_, private_futures_client_.get(), private_futures_heartbeat_.get(), private_futures_reconnect_.get());
+        shutdown(private_stream_loop_, private_stream_client_.get(), private_stream_heartbeat_.get(), private_stream_reconnect_.get());
+      }
+
+      std::vector<hv::EventLoopPtr> Gateway::make_feed_loops(const std::string &group, size_t count, const char *cpu_env, hv::EventLoopPtr &executor)
+      {
+        return gateio::make_feed_loops(feed_loops_, dedicated_loops_, group, count, cpu_env, executor);
+      }
+
+      bool Gateway::accept_private(size_t source, const std::string &message)
+      {
+        return !futures_standby_ || futures_standby_->accept(source, message);
+      }
+
+      void Gateway::enqueue_private(size_t source, SpscQueue<std::string> &inbox, const std::string &message)
+      {
+        if (!dedicated_loops_)
+        {
+          if (accept_private(source, message))
+          {
+            parse_websocket_private(message);
+          }
+          return;
+        }
+        // Order responses must not be dropped, and the socket loop must not wait for the engine:
+        // a full inbox spills into the overflow list. Once anything has spilled, later frames
+        // follow it there until the engine has caught up, so each session stays in order.
+        if (private_overflow_pending_.load(std::memory_order_acquire) || !inbox.try_push(message))
+        {
+          std::lock_guard<std::mutex> lock(private_overflow_mutex_);
+          private_overflow_.emplace_back(source, message);
+          private_overflow_pending_.store(true, std::memory_order_release);
+          ++private_overflows_;
+        }
+        schedule_private_drain();
+      }
+
+      void Gateway::schedule_private_drain()
+      {
+        if (!private_drain_scheduled_.exchange(true))
+        {
+          engine_loop_->queueInLoop([this]()
+                                    { drain_private_inbox(); });
+        }
       }
+
+      void Gateway::drain_private_inbox()
+      {
+        // Re-arm first so a frame pushed while draining schedules another pass
+        private_drain_scheduled_ = false;
+        auto parse = [this](std::string &message)
+        {
+          if (accept_private(PRIMARY_SOURCE, message))
+          {
+            parse_websocket_private(message);
+          }
+        };
+        // Acks before pushes when both are waiting; the order table copes with either order
+        while (private_futures_inbox_.consume_one(parse))
+        {
+        }
+        while (private_spot_inbox_.consume_one(parse))
+        {
+        }
+        while (private_stream_inbox_.consume_one(parse))
+        {
+        }
+        if (futures_standby_)
+        {
+          futures_standby_->drain([this](size_t source, std::string &message)
+                                  {
+                                    if (accept_private(source, message))
+                                    {
+                                      parse_websocket_private(message);
+                                    } });
+          futures_standby_->drain_released([this](std::string &message)
+                                           { parse_websocket_private(message); });
+        }
+        // Spilled frames are newer than everything still in the inboxes
+        if (private_overflow_pending_.load(std::memory_order_acquire))
+        {
+          std::deque<std::pair<size_t, std::string>> overflow;
+          {
+            std::lock_guard<std::mutex> lock(private_overflow_mutex_);
+            overflow.swap(private_overflow_);
+            private_overflow_pending_.store(false, std::memory_order_release);
+          }
+          for (auto &[source, message] : overflow)
+          {
+            if (accept_private(source, message))
+            {
+              parse_websocket_private(message);
+            }
+          }
+        }
+      }
+
       void Gateway::close_private_socket()
       {
+        if (futures_standby_)
+        {
+          futures_standby_->close();
+        }
+        if (private_spot_reconnect_)
+        {
+          private_spot_reconnect_->stop();
+          private_futures_reconnect_->stop();
+        }
         private_spot_client_->close();
-        private_spot_status_ = singular::types::GatewayStatus::OFFLINE;
+        health_.set_fault(GatewayHealth::PRIVATE_SPOT, true, "closed");
         private_futures_client_->close();
-        private_futures_status_ = singular::types::GatewayStatus::OFFLINE;
+        health_.set_fault(GatewayHealth::PRIVATE_FUTURES, true, "closed");
+        if (private_stream_client_)
+        {
+          private_stream_reconnect_->stop();
+          private_stream_client_->close();
+          health_.set_fault(GatewayHealth::PRIVATE_FUTURES_STREAM, true, "closed");
+        }
       }
 
       void Gateway::close_public_socket()
       {
-        public_client_spot->close();
-        public_client_futures_btc->close();
-        public_client_futures_usdt->close();
-        public_status_ = singular::types::GatewayStatus::OFFLINE;
+        // The hub closes the public sockets once no gateway is attached
+        hub_->detach(hub_id_);
       }
 
       void Gateway::purge()
       {
         close_public_socket();
         close_private_socket();
-        authenticated_ = false;
+        spot_authenticated_ = false;
+        futures_authenticated_ = false;
+        stream_authenticated_ = false;
         spot_login_status = false;
         futures_login_status = false;
         is_purged_ = true;
@@ -136,11 +451,13 @@ namespace singular
         internal_to_client_id_map_.max_load_factor(LOAD_FACTOR);
         internal_id_symbol_map_.max_load_factor(LOAD_FACTOR);
         internal_to_credential_id_map_.max_load_factor(LOAD_FACTOR);
+        internal_to_route_map_.max_load_factor(LOAD_FACTOR);
         symbol_volume_map_.max_load_factor(LOAD_FACTOR);
 
         internal_to_client_id_map_.reserve(INITIAL_MAP_SIZE);
         internal_id_symbol_map_.reserve(INITIAL_MAP_SIZE);
         internal_to_credential_id_map_.reserve(INITIAL_MAP_SIZE);
+        internal_to_route_map_.reserve(INITIAL_MAP_SIZE);
         symbol_volume_map_.reserve(INITIAL_MAP_SIZE);
       }
 
@@ -148,7 +465,44 @@ namespace singular
       {
         try
         {
-            //add_callback(std::bind(&Gateway::run_private_spot_ws,this));//commented as Testnet is not available for spot.
+            const bool spot_session = authenticate_ && private_spot_enabled_;
+            if (lazy_connect_)
+            {
+              // Nothing connects before it is used: public markets open with their first subscription
+              // and order sessions with their first request, so there is nothing to wait for here
+              health_.watch(0, 0);
+              if (authenticate_ && idle_timeout_ns_ > 0)
+              {
+                const int check_ms = static_cast<int>(std::max<int64_t>(idle_timeout_ns_ / 4000000, 100));
+                idle_timer_ = engine_loop_->setInterval(check_ms, [this](hv::TimerID)
+                                                        { reap_idle_sessions(); });
+              }
+              expect_ready(0);
+              if (!ready_.exchange(true))
+              {
+                announce_ready();
+              }
+              return;
+            }
+            // Every socket starts connecting at once; readiness is reported when all of these are up
+            const bool stream_session = authenticate_ && private_stream_client_;
+            expect_ready(READY_PUBLIC_SPOT | READY_PUBLIC_FUTURES_USDT | READY_PUBLIC_FUTURES_BTC |
+                         (authenticate_ ? READY_PRIVATE_FUTURES : 0) | (spot_session ? READY_PRIVATE_SPOT : 0) |
+                         (stream_session ? READY_PRIVATE_STREAM : 0));
+            // Only a dead futures order session stops trading; a dead spot or stream session or feed problems degrade
+            health_.watch((authenticate_ ? GatewayHealth::PRIVATE_FUTURES : 0) | (spot_session ? GatewayHealth::PRIVATE_SPOT : 0) |
+                              (stream_session ? GatewayHealth::PRIVATE_FUTURES_STREAM : 0),
+                          authenticate_ ? GatewayHealth::PRIVATE_FUTURES : 0);
+            add_callback(std::bind(&Gateway::run_public_ws_spot,this));
+            add_callback(std::bind(&Gateway::run_public_ws_futures_usdt,this));
+            add_callback(std::bind(&Gateway::run_public_ws_futures_btc,this));
+            // Both order sessions run side by side, each on its own loop
+            if (spot_session)
+            {
+              session_started_[SPOT_SESSION] = true;
+              add_callback(std::bind(&Gateway::run_private_spot_ws,this));
+            }
+            session_started_[FUTURES_SESSION] = authenticate_;
             add_callback(std::bind(&Gateway::run_private_futures_ws,this));
         }
         catch(std::exception &e)
@@ -162,31 +516,33 @@ namespace singular
                              singular::types::Side side, double price, double quantity, singular::types::RequestSource source,
                              std::string credential_id, std::string td_mode)
       {
-        std::string channel=type==singular::types::InstrumentType::SPOT?"spot.order_place":"futures.order_place";
+        // Channel, contract string and session are resolved once per symbol
+        const OrderRoute &route = order_routes_.resolve(symbol, type);
+        if (!route.sender)
+        {
+          singular::utility::log_event(log_service_name, singular::utility::OEMSEvent::PLACE_ORDER_ERROR, "No private session for " + symbol + ", order not sent");
+          return;
+        }
         auto client_id = get_client_id(order_id);
         std::string type_string = singular::types::get_order_type_string[order_type];
-        std::string contract=symbol;
-        std::string contract_symbol;
         std::string tif;//added if needed for future
         std::string text="t-Z-"+std::to_string(client_id);//custom string(to match gateio set rules)
         const std::string side_string = side == singular::types::Side::BUY ? "buy" : "sell";
-        std::size_t pos = contract.find('@');//Symbol is BTC-USD@FUTURE
-          contract_symbol = contract.substr(0, pos);//Contract symbol=BTC-USD
         std::string orderid_string=std::to_string(order_id);
         std::string price_string=std::to_string(price);
 
         nlohmann::json message;
       
-        message["channel"] = channel;
+        message["channel"] = route.place_channel;
         message["event"] = "api";
         message["payload"]["req_id"] = orderid_string;
         message["payload"]["req_param"]["price"] = price_string;
         message["payload"]["req_param"]["text"] = text;  
+        message["payload"]["req_param"][route.symbol_key] = route.contract;
 
-        if(type==singular::types::InstrumentType::LINEAR_PERPETUAL||type==singular::types::InstrumentType::INVERSE_PERPETUAL)      
+        if(route.perpetual)
         {
           message["payload"]["req_param"]["size"] = quantity;
-          message["payload"]["req_param"]["contract"] = contract_symbol;
         }
         
         // if(tif.size()>0)//commented for now as tif is not used 
@@ -194,9 +550,8 @@ namespace singular
         //    message["payload"]["req_param"]["tif"] = tif;
         // }
 
-        if(type==singular::types::InstrumentType::SPOT)      
+        if(route.spot)
         {
-          message["payload"]["req_param"]["currency_pair"] = contract_symbol;
           message["payload"]["req_param"]["type"] = type_string;
           message["payload"]["req_param"]["account"] = "spot";
           message["payload"]["req_param"]["side"] = side_string;
@@ -217,21 +572,13 @@ namespace singular
         auto end_time_rtsc = singular::utility::LatencyMeasure::captureTimestamp();
         latency_measure->stopMeasurement(order_id, end_time_rtsc);
         
-        if(type!=singular::types::InstrumentType::SPOT)
-        {
-          private_futures_client_->send(message.dump());
-        }
-        else
-        {
-          private_spot_client_->send(message.dump());
-        }
-
         client_id_to_side_map_[client_id] = side;
         client_id_to_price_map_[client_id] = price;
         client_id_to_qty_map_[client_id] = quantity;
         client_id_to_symbol_map_[client_id] = symbol;
         client_to_internal_id_map_[client_id] = order_id;
         internal_to_client_id_map_[order_id] = client_id;
+        internal_to_route_map_[order_id] = &route;
         client_id_to_source_map_[client_id] = source;
 
         if (credential_id != "")
@@ -239,6 +586,14 @@ namespace singular
           internal_to_credential_id_map_[order_id] = credential_id;
         }
 
+        if (!send_order_request(route, route.place_channel, orderid_string, message.dump(), SendQueue::Priority::PLACE))
+        {
+          // The session already holds GATEIO_SEND_MAX_PENDING places; refuse rather than queue behind them
+          reject_place(order_id, "SEND_QUEUE_FULL");
+          return;
+        }
+        private_orders_.on_sent(client_id, route.spot ? SPOT_SESSION : FUTURES_SESSION);
+
         std::string source_string = singular::types::get_request_source_string[source];
         if ((source_string == "market") || (source_string == "limit"))
         {
@@ -341,32 +696,28 @@ namespace singular
           return;
         }
         auto client_id = it->second;
+        // The route the order was placed on
+        auto route_it = internal_to_route_map_.find(order_id);
+        if (route_it == internal_to_route_map_.end())
+        {
+          singular::utility::log_event(log_service_name, singular::utility::OEMSEvent::CANCEL_ORDER_ERROR, "Order ID not found in internal_to_route_map.");
+          return;
+        }
+        const OrderRoute &route = *route_it->second;
 
-        auto symbol = internal_id_symbol_map_[order_id];
-        std::string contract_symbol;
-        std::size_t pos = symbol.find('@');//Symbol is BTC-USD@FUTURE
-          contract_symbol = symbol.substr(0, pos);
         std::string new_client_id = source + "-" + std::to_string(client_id);
         const std::string instrument = client_id_to_symbol_map_[client_id];
-        singular::types::InstrumentType type= internal_to_type_map_[order_id];
-        std::string channel_cancel;
-        if(type==singular::types::InstrumentType::SPOT)
-        {
-          channel_cancel="spot.order_cancel";        
-        }
-        else
-        {
-          channel_cancel="futures.order_cancel";    
-        }
         nlohmann::json message;
         
-        message["channel"] = channel_cancel;
+        message["channel"] = route.cancel_channel;
         message["payload"]["req_id"] = std::to_string(order_id);
-        message["payload"]["req_param"]["order_id"] =order_id;
+        // Exchange id from whichever session reported it first, else the order's text, which Gate.io also accepts
+        const PrivateOrderTable::Entry *order = private_orders_.find(client_id);
+        message["payload"]["req_param"]["order_id"] = order && !order->exchange_id.empty() ? order->exchange_id : "t-Z-" + std::to_string(client_id);
 
-         if(type==singular::types::InstrumentType::SPOT)      
+        if(route.spot)
         {
-          message["payload"]["req_param"]["currency_pair"] =contract_symbol;  
+          message["payload"]["req_param"]["currency_pair"] = route.contract;
         }
       
         auto timestamp = std::chrono::duration_cast<std::chrono::seconds>(
@@ -374,14 +725,7 @@ namespace singular
                              .count();
         message["time"] = timestamp;
 
-        if(type!=singular::types::InstrumentType::SPOT)
-        {
-          private_futures_client_->send(message.dump());
-        }
-        else
-        {
-          private_spot_client_->send(message.dump());
-        }
+        send_order_request(route, route.cancel_channel, message["payload"]["req_id"].get<std::string>(), message.dump(), SendQueue::Priority::CANCEL);
 
         // Enable Log in Debug mode
         std::string log_message = "Sent a cancel order request for symbol ";
@@ -392,30 +736,21 @@ namespace singular
 
       void Gateway::do_cancel(std::string exchange_order_id, singular::types::Instrument *instrument, singular::types::RequestSource source)
       {
-        auto symbol = instrument->symbol_;
-         std::string contract_symbol;
-         std::size_t pos = symbol.find('@');//Symbol is BTC-USD@FUTURE
-          contract_symbol = symbol.substr(0, pos);
-
-        singular::types::InstrumentType type= instrument->type_;
-        std::string channel_cancel;
-        if(type==singular::types::InstrumentType::SPOT)
+        const OrderRoute &route = order_routes_.resolve(instrument->symbol_, instrument->type_);
+        if (!route.sender)
         {
-          channel_cancel="spot.order_cancel";        
-        }
-        else
-        {
-          channel_cancel="futures.order_cancel";    
+          singular::utility::log_event(log_service_name, singular::utility::OEMSEvent::CANCEL_ORDER_ERROR, "No private session for " + instrument->symbol_ + ", cancel not sent");
+          return;
         }
         nlohmann::json message;
         
-        message["channel"] = channel_cancel;
+        message["channel"] = route.cancel_channel;
         message["payload"]["req_id"] = exchange_order_id;
         message["payload"]["req_param"]["order_id"] =exchange_order_id;
 
-         if(type==singular::types::InstrumentType::SPOT)      
+        if(route.spot)
         {
-          message["payload"]["req_param"]["currency_pair"] =contract_symbol;  
+          message["payload"]["req_param"]["currency_pair"] = route.contract;
         }
       
         auto timestamp = std::chrono::duration_cast<std::chrono::seconds>(
@@ -423,14 +758,7 @@ namespace singular
                              .count();
         message["time"] = timestamp;
 
-        if(type!=singular::types::InstrumentType::SPOT)
-        {
-          private_futures_client_->send(message.dump());
-        }
-        else
-        {
-          private_spot_client_->send(message.dump());
-        }
+        send_order_request(route, route.cancel_channel, message["payload"]["req_id"].get<std::string>(), message.dump(), SendQueue::Priority::CANCEL);
 
         // Enable Log in Debug mode
         std::string log_message = "Sent a cancel order request for clOrdId: ";
@@ -470,346 +798,349 @@ namespace singular
 
       void Gateway::do_subscribe_orderbooks(std::vector<singular::types::Symbol> &symbols)
       {
-        nlohmann::json message;
-        auto split_symbols = splitSymbols(symbols);
-        auto now = std::chrono::system_clock::now();
-        auto time_int = std::chrono::duration_cast<std::chrono::seconds>(now.time_since_epoch()).count();
-        for (auto &split_symbol : split_symbols)
-        {
-          nlohmann::json payload;
-          std::string channel;
-          if(split_symbol.second == "SPOT"){
-            channel = "spot.order_book_update";
-            payload = {split_symbol.first, "100ms"};
+        hub_->subscribe(hub_id_, MarketDataHub::Stream::BOOK, splitSymbols(symbols));
+        singular::utility::log_event(log_service_name, singular::utility::OEMSEvent::ORDERBOOK_SUBSCRIBE_SUCCESS, "Sent a subscribe message for orderbooks channel");
+      }
 
-            message = {
-            {"time", time_int},
-            {"channel", channel},
-            {"event", "subscribe"},
-            {"payload", payload}};
+      void Gateway::do_unsubscribe_orderbooks(std::vector<singular::types::Symbol> &symbols)
+      {
+        hub_->unsubscribe(hub_id_, MarketDataHub::Stream::BOOK, splitSymbols(symbols));
+        singular::utility::log_event(log_service_name, singular::utility::OEMSEvent::ORDERBOOK_SUBSCRIBE_SUCCESS, "Sent a unsubscribe message for orderbooks channel");
+      }
 
-            public_client_spot->send(message.dump());
-          }
-          else if(split_symbol.second == "FUTURE"){
-            channel = "futures.order_book_update";
-            payload = {split_symbol.first,"100ms","20"};
+      bool Gateway::set_book_profile(const std::string &symbol, const std::string &profile_text)
+      {
+        return hub_->set_book_profile(symbol, profile_text);
+      }
 
-            message = {
-            {"time", time_int},
-            {"channel", channel},
-            {"event", "subscribe"},
-            {"payload", payload}};
+      std::string Gateway::capture_name(const char *connection) const
+      {
+        return std::string(connection) + "@" + name_;
+      }
 
-            if(is_btc(split_symbol.first))
-            {
-              public_client_futures_btc->send(message.dump());
-            }
-            else
-            {
-              public_client_futures_usdt->send(message.dump());
-            }
-          }
+      void Gateway::dispatch_frame(const std::string &connection, const std::string &frame)
+      {
+        if (connection == capture_name(PRIVATE_SPOT_CONNECTION) || connection == capture_name(PRIVATE_FUTURES_CONNECTION) ||
+            connection == capture_name(PRIVATE_FUTURES_STREAM_CONNECTION))
+        {
+          parse_websocket_private(frame);
+          return;
         }
-        singular::utility::log_event(log_service_name, singular::utility::OEMSEvent::ORDERBOOK_SUBSCRIBE_SUCCESS, "Sent a subscribe message for orderbooks channel");
+        // Standby responses are recorded for inspection only: without the live deduplication
+        // state they would repeat the primary's
+        if (connection.compare(0, std::strlen(RedundantSessions::STANDBY_PREFIX), RedundantSessions::STANDBY_PREFIX) == 0)
+        {
+          return;
+        }
+        hub_->dispatch_frame(connection, frame);
       }
 
-      void Gateway::do_unsubscribe_orderbooks(std::vector<singular::types::Symbol> &symbols)
+      bool Gateway::read_market_snapshot(const std::string &symbol, MarketSnapshot &snapshot)
       {
-        nlohmann::json message;
-        auto split_symbols = splitSymbols(symbols);
-        auto now = std::chrono::system_clock::now();
-        auto time_int = std::chrono::duration_cast<std::chrono::seconds>(now.time_since_epoch()).count();
-        for (auto &split_symbol : split_symbols)
-        {
-          nlohmann::json payload;
-          std::string channel;
-          if(split_symbol.second == "SPOT"){
-            channel = "spot.order_book_update";
-            payload = {split_symbol.first, "100ms"};
+        return hub_->snapshots().read(symbol, snapshot);
+      }
 
-            message = {
-            {"time", time_int},
-            {"channel", channel},
-            {"event", "unsubscribe"},
-            {"payload", payload}};
+      const MarketSnapshotTable::Entry *Gateway::market_snapshot_entry(const std::string &symbol)
+      {
+        return hub_->snapshots().entry(symbol);
+      }
 
-            public_client_spot->send(message.dump());
-          }
-          else if(split_symbol.second == "FUTURE"){
-            channel = "futures.order_book_update";
-            payload = {split_symbol.first,"100ms","20"};
+      bool Gateway::read_basis(const std::string &asset, BasisRecord &record)
+      {
+        return hub_->basis().read(asset, record);
+      }
 
-            message = {
-            {"time", time_int},
-            {"channel", channel},
-            {"event", "unsubscribe"},
-            {"payload", payload}};
+      nlohmann::json Gateway::get_basis_stats()
+      {
+        return hub_->basis().get_stats();
+      }
 
-            if(is_btc(split_symbol.first))
-            {
-              public_client_futures_btc->send(message.dump());
-            }
-            else
-            {
-              public_client_futures_usdt->send(message.dump());
-            }
-          }
-        }
+      nlohmann::json Gateway::get_market_snapshot_stats()
+      {
+        return hub_->snapshots().get_stats();
+      }
 
-        singular::utility::log_event(log_service_name, singular::utility::OEMSEvent::ORDERBOOK_SUBSCRIBE_SUCCESS, "Sent a unsubscribe message for orderbooks channel");
+      nlohmann::json Gateway::get_capture_stats()
+      {
+        return hub_->get_capture_stats();
+      }
+
+      nlohmann::json Gateway::get_book_profiles()
+      {
+        return hub_->get_book_profiles();
       }
 
       void Gateway::do_subscribe_tickers(std::vector<singular::types::Symbol> &symbols)
       {
-        nlohmann::json message1, message2;
+        hub_->subscribe(hub_id_, MarketDataHub::Stream::TICKER, splitSymbols(symbols));
+        singular::utility::log_event(log_service_name, singular::utility::OEMSEvent::TICKER_SUBSCRIBE_SUCCESS, "Sent a subscribe message for both the ticker channels");
+      }
+
+      void Gateway::do_unsubscribe_tickers(std::vector<singular::types::Symbol> &symbols)
+      {
+        hub_->unsubscribe(hub_id_, MarketDataHub::Stream::TICKER, splitSymbols(symbols));
+        singular::utility::log_event(log_service_name, singular::utility::OEMSEvent::TICKER_SUBSCRIBE_SUCCESS, "Sent a unsubscribe message for ticker channel");
+      }
+
+      void Gateway::do_subscribe_top_of_book(std::vector<singular::types::Symbol> &symbols)
+      {
+        
+      }
+
+      void Gateway::do_subscribe_trades(std::vector<singular::types::Symbol> &symbols)
+      {
+        nlohmann::json payload = nlohmann::json::array();
         auto split_symbols = splitSymbols(symbols);
-        auto now = std::chrono::system_clock::now();
-        auto time_int = std::chrono::duration_cast<std::chrono::seconds>(now.time_since_epoch()).count();
         for (auto &split_symbol : split_symbols)
         {
-          nlohmann::json payload = {split_symbol.first};
-          std::string channel1;
-          std::string channel2;
-          if(split_symbol.second == "SPOT"){
-            channel1 = "spot.tickers";
-            channel2 = "spot.book_ticker";
-            payload = {split_symbol.first};
-
-            message1 = {
-              {"time", time_int},
-              {"channel", channel1},
-              {"event", "subscribe"},
-              {"payload", payload}};
-
-            message2 = {
-              {"time", time_int},
-              {"channel", channel2},
-              {"event", "subscribe"},
-              {"payload", payload}};
-
-            public_client_spot->send(message1.dump());
-
-            public_client_spot->send(message2.dump());
-          }
-          else if(split_symbol.second == "FUTURE"){
-            channel1 = "futures.tickers";
-            channel2 = "futures.book_ticker";
-            payload = {split_symbol.first};
-
-            message1 = {
-              {"time", time_int},
-              {"channel", channel1},
-              {"event", "subscribe"},
-              {"payload", payload}};
-
-            message2 = {
-              {"time", time_int},
-              {"channel", channel2},
-              {"event", "subscribe"},
-              {"payload", payload}};
-
-            if(is_btc(split_symbol.first))
-            {
-              public_client_futures_btc->send(message1.dump());
-              public_client_futures_btc->send(message2.dump());
-            }
-            else
-            {
-              public_client_futures_usdt->send(message1.dump());
-              public_client_futures_usdt->send(message2.dump());
-            }
-          }
+          payload.push_back(split_symbol.first);
         }
+        hub_->subscribe(hub_id_, MarketDataHub::Stream::TRADES, split_symbols);
 
-        singular::utility::log_event(log_service_name, singular::utility::OEMSEvent::TICKER_SUBSCRIBE_SUCCESS, "Sent a subscribe message for both the ticker channels");
+        singular::utility::log_event(log_service_name, singular::utility::OEMSEvent::LASTTRADES_SUBSCRIBE_SUCCESS, "Sent a subscribe message for last trades channel", payload.dump());
       }
 
-      void Gateway::do_unsubscribe_tickers(std::vector<singular::types::Symbol> &symbols)
+      void Gateway::do_unsubscribe_trades(std::vector<singular::types::Symbol> &symbols)
       {
-        nlohmann::json message1, message2;
+        nlohmann::json payload = nlohmann::json::array();
         auto split_symbols = splitSymbols(symbols);
-        auto now = std::chrono::system_clock::now();
-        auto time_int = std::chrono::duration_cast<std::chrono::seconds>(now.time_since_epoch()).count();
         for (auto &split_symbol : split_symbols)
         {
-          nlohmann::json payload = {split_symbol.first};
-          std::string channel1;
-          std::string channel2;
-          if(split_symbol.second == "SPOT"){
-            channel1 = "spot.tickers";
-            channel2 = "spot.book_ticker";
-            payload = {split_symbol.first};
-
-            message1 = {
-            {"time", time_int},
-            {"channel", channel1},
-            {"event", "unsubscribe"},
-            {"payload", payload}};
-
-            message2 = {
-            {"time", time_int},
-            {"channel", channel2},
-            {"event", "unsubscribe"},
-            {"payload", payload}};
-
-            public_client_spot->send(message1.dump());
-
-            public_client_spot->send(message2.dump());
+          payload.push_back(split_symbol.first);
+        }
+        hub_->unsubscribe(hub_id_, MarketDataHub::Stream::TRADES, split_symbols);
+
+        singular::utility::log_event(log_service_name, singular::utility::OEMSEvent::LASTTRADES_SUBSCRIBE_SUCCESS, "Sent a unsubscribe message for last trades channel", payload.dump());
+      }
+
+      void Gateway::do_subscribe_funding(std::vector<singular::types::Symbol> &symbols)
+      {
+        // Funding rate, mark/index price and open interest all ride on futures.tickers
+        hub_->subscribe(hub_id_, MarketDataHub::Stream::FUNDING, splitSymbols(symbols));
+        singular::utility::log_event(log_service_name, singular::utility::OEMSEvent::TICKER_SUBSCRIBE_SUCCESS, "Sent a subscribe message for funding through futures.tickers");
+      }
+
+      void Gateway::do_unsubscribe_funding(std::vector<singular::types::Symbol> &symbols)
+      {
+        hub_->unsubscribe(hub_id_, MarketDataHub::Stream::FUNDING, splitSymbols(symbols));
+        singular::utility::log_event(log_service_name, singular::utility::OEMSEvent::TICKER_SUBSCRIBE_SUCCESS, "Sent a unsubscribe message for funding through futures.tickers");
+      }
+
+      void Gateway::set_funding_callback(FundingTable::ChangeCallback callback)
+      {
+        hub_->set_funding_callback(hub_id_, std::move(callback));
+      }
+
+      bool Gateway::read_funding(const std::string &symbol, FundingRecord &record)
+      {
+        return hub_->funding().read(symbol, record);
+      }
+
+      nlohmann::json Gateway::get_funding_stats()
+      {
+        return hub_->funding().get_stats();
+      }
+
+      nlohmann::json Gateway::get_heartbeat_stats()
+      {
+        nlohmann::json stats = hub_->get_heartbeat_stats();
+        for (auto heartbeat : {private_spot_heartbeat_.get(), private_futures_heartbeat_.get(), private_stream_heartbeat_.get()})
+        {
+          if (heartbeat)
+          {
+            stats.push_back(heartbeat->get_stats());
           }
-          else if(split_symbol.second == "FUTURE"){
-            channel1 = "futures.tickers";
-            channel2 = "futures.book_ticker";
-            payload = {split_symbol.first};
-
-            message1 = {
-            {"time", time_int},
-            {"channel", channel1},
-            {"event", "unsubscribe"},
-            {"payload", payload}};
-
-            message2 = {
-            {"time", time_int},
-            {"channel", channel2},
-            {"event", "unsubscribe"},
-            {"payload", payload}};
-
-            if(is_btc(split_symbol.first))  //check if symbol belongs to btc websocket
-            {
-              public_client_futures_btc->send(message1.dump());
-              public_client_futures_btc->send(message2.dump());
-            }
-            else
+        }
+        return stats;
+      }
+
+      bool Gateway::send_order_request(const OrderRoute &route, const char *channel, const std::string &req_id, const std::string &frame, SendQueue::Priority priority)
+      {
+        if (lazy_connect_)
+        {
+          const size_t session = route.spot ? SPOT_SESSION : FUTURES_SESSION;
+          session_last_use_ns_[session] = steady_ns();
+          if (!(route.spot ? spot_authenticated_ : futures_authenticated_))
+          {
+            // Held until the session has connected and logged in
+            start_private_session(session);
+            if (deferred_requests_[session].size() >= MAX_DEFERRED_REQUESTS && priority != SendQueue::Priority::CANCEL)
             {
-              public_client_futures_usdt->send(message1.dump());
-              public_client_futures_usdt->send(message2.dump());
+              return false;
             }
+            deferred_requests_[session].push_back(DeferredRequest{&route, channel, req_id, frame, priority});
+            return true;
           }
         }
+        // Cancels are urgent: they never wait for the next flush on the socket's loop
+        if (route.spot)
+        {
+          return route.sender->send(frame, priority, priority == SendQueue::Priority::CANCEL);
+        }
+        return send_futures_request(channel, req_id, frame, priority);
+      }
 
-        singular::utility::log_event(log_service_name, singular::utility::OEMSEvent::TICKER_SUBSCRIBE_SUCCESS, "Sent a unsubscribe message for ticker channel");
-      
+      bool Gateway::send_futures_request(const std::string &channel, const std::string &req_id, const std::string &frame, SendQueue::Priority priority)
+      {
+        const bool broadcast = priority == SendQueue::Priority::CANCEL;
+        if (!futures_standby_)
+        {
+          return private_futures_send_->send(frame, priority, broadcast);
+        }
+        const bool primary = futures_authenticated_ && private_futures_client_->is_open() && !private_futures_heartbeat_->stale();
+        if (broadcast)
+        {
+          // Cancels race on every session; the first success is the one processed
+          std::vector<RedundantSessions::Session *> standbys = futures_standby_->usable();
+          const bool use_primary = primary || standbys.empty();
+          std::vector<size_t> sources;
+          if (use_primary)
+          {
+            sources.push_back(PRIMARY_SOURCE);
+          }
+          for (RedundantSessions::Session *standby : standbys)
+          {
+            sources.push_back(standby->source);
+          }
+          futures_standby_->expect(channel, req_id, sources);
+          if (use_primary)
+          {
+            private_futures_send_->send(frame, priority, true);
+            futures_standby_->count_primary_send();
+          }
+          for (RedundantSessions::Session *standby : standbys)
+          {
+            futures_standby_->send(*standby, frame, priority, true);
+          }
+          return true;
+        }
+
+        // Everything else goes out once, on the session with the lowest smoothed RTT
+        RedundantSessions::Session *standby = futures_standby_->fastest();
+        const int64_t primary_rtt = private_futures_heartbeat_->smoothed_rtt_ns();
+        const bool use_standby = standby && (!primary || (primary_rtt != 0 && standby->heartbeat->smoothed_rtt_ns() < primary_rtt));
+        // Checked before the response is expected, so a refused request leaves nothing pending
+        if ((use_standby ? standby->sender : private_futures_send_)->full(priority))
+        {
+          return false;
+        }
+        futures_standby_->expect(channel, req_id, {use_standby ? standby->source : PRIMARY_SOURCE});
+        if (use_standby)
+        {
+          futures_standby_->send(*standby, frame, priority, false);
+        }
+        else
+        {
+          private_futures_send_->send(frame, priority, false);
+          futures_standby_->count_primary_send();
+        }
+        return true;
       }
 
-      void Gateway::do_subscribe_top_of_book(std::vector<singular::types::Symbol> &symbols)
+      nlohmann::json Gateway::get_order_session_stats()
       {
-        
+        return futures_standby_ ? futures_standby_->get_stats() : nlohmann::json{{"enabled", false}};
       }
 
-      void Gateway::do_subscribe_trades(std::vector<singular::types::Symbol> &symbols)
+      nlohmann::json Gateway::get_reconnect_stats()
       {
-        nlohmann::json message;
-        auto split_symbols = splitSymbols(symbols);
-        auto now = std::chrono::system_clock::now();
-        auto time_int = std::chrono::duration_cast<std::chrono::seconds>(now.time_since_epoch()).count();
-        for (auto &split_symbol : split_symbols)
+        nlohmann::json stats = hub_->get_reconnect_stats();
+        for (auto reconnect : {private_spot_reconnect_.get(), private_futures_reconnect_.get(), private_stream_reconnect_.get()})
         {
-          nlohmann::json payload = {split_symbol.first};
-          std::string channel;
-          if(split_symbol.second == "SPOT")
+          if (reconnect)
           {
-            channel = "spot.trades";
-            
-            message = {
-            {"time", time_int},
-            {"channel", channel},
-            {"event", "subscribe"},
-            {"payload", payload}};
-
-            public_client_spot->send(message.dump());
+            stats.push_back(reconnect->get_stats());
           }
-          else if(split_symbol.second == "FUTURE")
-          {
-            channel = "futures.trades";
-
-            message = {
-            {"time", time_int},
-            {"channel", channel},
-            {"event", "subscribe"},
-            {"payload", payload}};
-
-            if(is_btc(split_symbol.first))  //check if symbol belongs to btc websocket
-            {
-              public_client_futures_btc->send(message.dump());
-            }
-            else
-            {
-              public_client_futures_usdt->send(message.dump());
-            }
-          } 
         }
-
-        singular::utility::log_event(log_service_name, singular::utility::OEMSEvent::LASTTRADES_SUBSCRIBE_SUCCESS, "Sent a subscribe message for last trades channel", message["payload"].dump());
+        return stats;
       }
 
-      void Gateway::do_unsubscribe_trades(std::vector<singular::types::Symbol> &symbols)
+      nlohmann::json Gateway::get_clock_stats()
       {
-        nlohmann::json message;
-        auto split_symbols = splitSymbols(symbols);
-        auto now = std::chrono::system_clock::now();
-        auto time_int = std::chrono::duration_cast<std::chrono::seconds>(now.time_since_epoch()).count();
-        for (auto &split_symbol : split_symbols)
+        nlohmann::json stats = hub_->get_clock_stats();
+        if (authenticate_)
         {
-          nlohmann::json payload = {split_symbol.first};
-          std::string channel;
-          if(split_symbol.second == "SPOT")
+          stats.push_back(private_spot_clock_.get_stats());
+          stats.push_back(private_futures_clock_.get_stats());
+          if (private_stream_client_)
           {
-            channel = "spot.trades";
-            
-            message = {
-            {"time", time_int},
-            {"channel", channel},
-            {"event", "unsubscribe"},
-            {"payload", payload}};
-
-            public_client_spot->send(message.dump());
+            stats.push_back(private_stream_clock_.get_stats());
           }
-          else if(split_symbol.second == "FUTURE")
-          {
-            channel = "futures.trades";
+        }
+        return stats;
+      }
+
+      void Gateway::expect_ready(unsigned parts)
+      {
+        ready_start_ns_ = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                              std::chrono::steady_clock::now().time_since_epoch())
+                              .count();
+        ready_needed_ = parts;
+      }
 
-            message = {
-            {"time", time_int},
-            {"channel", channel},
-            {"event", "unsubscribe"},
-            {"payload", payload}};
+      void Gateway::mark_ready(unsigned part)
+      {
+        const unsigned seen = ready_seen_.fetch_or(part) | part;
+        const unsigned needed = ready_needed_;
+        if (needed == 0 || (seen & needed) != needed || ready_.exchange(true))
+        {
+          return;
+        }
+        announce_ready();
+      }
 
-            if(is_btc(split_symbol.first))  //check if symbol belongs to btc websocket
-            {
-              public_client_futures_btc->send(message.dump());
-            }
-            else
-            {
-              public_client_futures_usdt->send(message.dump());
-            }
-          } 
+      void Gateway::announce_ready()
+      {
+        ready_time_ns_ = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                             std::chrono::steady_clock::now().time_since_epoch())
+                             .count() -
+                         ready_start_ns_;
+        singular::utility::log_event(log_service_name, singular::utility::OEMSEvent::LOGIN_EXCHANGE_SUCCESS,
+                                     "Gateway ready in " + std::to_string(ready_time_ns_.load() / 1000000) + "ms");
+        if (ready_callback_)
+        {
+          ready_callback_();
         }
+      }
 
-        singular::utility::log_event(log_service_name, singular::utility::OEMSEvent::LASTTRADES_SUBSCRIBE_SUCCESS, "Sent a unsubscribe message for last trades channel", message["payload"].dump());
+      GatewayHealth::State Gateway::health() const
+      {
+        return std::min(health_.state(), hub_->health().state());
       }
 
-      void Gateway::do_subscribe_funding(std::vector<singular::types::Symbol> &symbols)
+      nlohmann::json Gateway::get_health_stats()
       {
-        //singular::utility::log_event(log_service_name, singular::utility::OEMSEvent::ACCOUNT_SUBSCRIBE_SUCCESS, "Sent a subscribe message for funding-rate channel", message["args"].dump());
+        nlohmann::json stats = health_.get_stats();
+        stats["state"] = GatewayHealth::to_string(health());
+        stats["market_data"] = hub_->health().get_stats();
+        return stats;
       }
 
-      void Gateway::run_public_ws_spot()
+      nlohmann::json Gateway::get_readiness_stats()
       {
+        return {{"ready", ready_.load()},
+                {"needed", ready_needed_.load()},
+                {"seen", ready_seen_.load()},
+                {"time_to_ready_ms", ready_time_ns_ ? ready_time_ns_ / 1e6 : -1.0}};
+      }
 
+      void Gateway::run_public_ws_spot()
+      {
+        hub_->run(hub_id_, MarketDataHub::SPOT, [this]() { mark_ready(READY_PUBLIC_SPOT); });
       }
       void Gateway::run_public_ws_futures_btc()
       {
-      
+        hub_->run(hub_id_, MarketDataHub::FUTURES_BTC, [this]() { mark_ready(READY_PUBLIC_FUTURES_BTC); });
       }
       void Gateway::run_public_ws_futures_usdt()
       {
-       
+        hub_->run(hub_id_, MarketDataHub::FUTURES_USDT, [this]() { mark_ready(READY_PUBLIC_FUTURES_USDT); });
       }
 
       singular::types::GatewayStatus Gateway::status()
       {
-        // Temporary code Remove after test
-            return singular::types::GatewayStatus::ONLINE;
-          
+        // One atomic load; DEGRADED feeds still accept orders, a dead order session does not
+        return health_.can_trade() ? singular::types::GatewayStatus::ONLINE : singular::types::GatewayStatus::OFFLINE;
       }
 
       std::vector<std::pair<std::string,std::string>> Gateway::splitSymbols(std::vector<singular::types::Symbol> &symbols)
@@ -921,14 +1252,157 @@ namespace singular
         return nlohmann::json::array();
       }
 
-      void Gateway::subscribe_fills()
+      size_t Gateway::drain_market_data(const MarketDataConflator::Consumer &consumer)
       {
-        
+        return md_conflator_->consume(consumer);
+      }
+
+      nlohmann::json Gateway::get_conflation_stats()
+      {
+        nlohmann::json stats;
+        stats["consumer_attached"] = md_conflator_->consumer_attached();
+        stats["symbols"] = md_conflator_->get_stats();
+        stats["books"] = hub_->get_book_stats();
+        return stats;
+      }
+
+      nlohmann::json Gateway::get_feed_arbitration_stats()
+      {
+        return hub_->get_feed_arbitration_stats();
+      }
+
+      nlohmann::json Gateway::get_public_connection_stats()
+      {
+        return hub_->get_public_connection_stats();
+      }
+
+      nlohmann::json Gateway::get_send_stats()
+      {
+        nlohmann::json stats = hub_->get_send_stats();
+        for (auto sender : {private_spot_send_.get(), private_futures_send_.get(), private_stream_send_.get()})
+        {
+          if (sender)
+          {
+            stats.push_back(sender->get_stats());
+          }
+        }
+        return stats;
+      }
+
+      nlohmann::json Gateway::get_transport_stats()
+      {
+        nlohmann::json stats = hub_->get_transport_stats();
+        const std::pair<const char *, const WsClient *> clients[] = {{PRIVATE_SPOT_CONNECTION, private_spot_client_.get()},
+                                                                     {PRIVATE_FUTURES_CONNECTION, private_futures_client_.get()},
+                                                                     {PRIVATE_FUTURES_STREAM_CONNECTION, private_stream_client_.get()}};
+        for (const auto &[connection, client] : clients)
+        {
+          if (client)
+          {
+            nlohmann::json entry = client->get_stats();
+            entry["connection"] = connection;
+            stats.push_back(entry);
+          }
+        }
+        return stats;
+      }
+
+      nlohmann::json Gateway::get_tls_session_stats()
+      {
+        return TlsSessionCache::shared().get_stats();
+      }
+
+      nlohmann::json Gateway::get_private_order_stats()
+      {
+        nlohmann::json stats = private_orders_.get_stats();
+        stats["stream_session"] = private_stream_client_ != nullptr;
+        stats["inbox_overflows"] = private_overflows_.load();
+        return stats;
+      }
+
+      nlohmann::json Gateway::get_market_data_hub_stats()
+      {
+        return hub_->get_stats();
+      }
+
+      std::string Gateway::private_subscription_frame(const std::string &channel, const std::string &event, const nlohmann::json &payload)
+      {
+        auto timestamp = std::chrono::duration_cast<std::chrono::seconds>(
+                             std::chrono::system_clock::now().time_since_epoch())
+                             .count();
+        const std::string signature_str = "channel=" + channel + "&event=" + event + "&time=" + std::to_string(timestamp);
+
+        nlohmann::json message;
+        message["time"] = timestamp;
+        message["channel"] = channel;
+        message["event"] = event;
+        message["payload"] = payload;
+        message["auth"]["method"] = "api_key";
+        message["auth"]["KEY"] = key_;
+        message["auth"]["SIGN"] = generate_hmac_sha512_hex(signature_str, secret_);
+        return message.dump();
+      }
+
+      void Gateway::subscribe_fills(SendQueue *sender, bool spot)
+      {
+        if (spot)
+        {
+          sender->send(private_subscription_frame("spot.orders", "subscribe", nlohmann::json::array({"!all"})));
+          sender->send(private_subscription_frame("spot.usertrades", "subscribe", nlohmann::json::array({"!all"})));
+        }
+        else
+        {
+          // Futures pushes are per account; the uid comes with the login response
+          sender->send(private_subscription_frame("futures.orders", "subscribe", nlohmann::json::array({user_id_, "!all"})));
+          sender->send(private_subscription_frame("futures.usertrades", "subscribe", nlohmann::json::array({user_id_, "!all"})));
+        }
+        singular::utility::log_event(log_service_name, singular::utility::OEMSEvent::WS_CONNECTION_DEBUG,
+                                     std::string("Subscribed ") + (spot ? "spot" : "futures") + " order and usertrade pushes on " + sender->name());
       }
 
       void Gateway::unsubscribe_fills()
       {
-        
+        if (spot_authenticated_)
+        {
+          private_spot_send_->send(private_subscription_frame("spot.orders", "unsubscribe", nlohmann::json::array({"!all"})));
+          private_spot_send_->send(private_subscription_frame("spot.usertrades", "unsubscribe", nlohmann::json::array({"!all"})));
+        }
+        SendQueue *futures = private_stream_send_ ? private_stream_send_.get() : private_futures_send_.get();
+        if (futures && (private_stream_send_ ? stream_authenticated_.load() : futures_authenticated_.load()))
+        {
+          futures->send(private_subscription_frame("futures.orders", "unsubscribe", nlohmann::json::array({user_id_, "!all"})));
+          futures->send(private_subscription_frame("futures.usertrades", "unsubscribe", nlohmann::json::array({user_id_, "!all"})));
+        }
+      }
+
+      void Gateway::connect_private_spot()
+      {
+        private_spot_client_->run(
+          [this](const HttpResponsePtr &response){
+            private_spot_heartbeat_->start();
+            private_spot_reconnect_->on_open(private_spot_client_->last_connect());
+            login_spot_private();
+          },
+          [this](){
+            private_spot_heartbeat_->stop();
+            private_spot_reconnect_->on_close();
+            health_.set_fault(GatewayHealth::PRIVATE_SPOT, true, "socket closed");
+            spot_authenticated_ = false;
+          },
+          [this](const std::string &message)
+          {
+            if (capture_)
+            {
+              capture_->record(private_spot_capture_id_, message);
+            }
+            if (private_spot_heartbeat_->on_frame(message))
+            {
+              return;
+            }
+            sample_private_clock(private_spot_clock_, message);
+            enqueue_private(PRIMARY_SOURCE, private_spot_inbox_, message);
+          }
+        );
       }
 
       void Gateway::run_private_spot_ws()
@@ -938,24 +1412,76 @@ namespace singular
           //log
           if(private_spot_client_)
           {
-            private_spot_client_->run(
-              [this](const HttpResponsePtr &response){
-
-              },
-              [this](){
-                private_spot_status_=singular::types::GatewayStatus::OFFLINE;
-                authenticated_=false;
-              },
-              [this](const std::string &message)
-              {
-                parse_websocket_private(message);
-              }
-            );
-            while(!private_spot_client_->is_open());
-            login_spot_private();
+            // Login goes out from the open callback, so this returns while the socket connects
+            private_spot_reconnect_->resume();
+            connect_private_spot();
           }
         }
       }
+      void Gateway::connect_private_futures()
+      {
+        private_futures_client_->run(
+          [this](const HttpResponsePtr &response){
+            private_futures_heartbeat_->start();
+            private_futures_reconnect_->on_open(private_futures_client_->last_connect());
+            login_futures_private();
+          },
+          [this](){
+            private_futures_heartbeat_->stop();
+            private_futures_reconnect_->on_close();
+            health_.set_fault(GatewayHealth::PRIVATE_FUTURES, true, "socket closed");
+            futures_authenticated_ = false;
+            if (futures_standby_)
+            {
+              futures_standby_->on_session_closed(PRIMARY_SOURCE);
+            }
+          },
+          [this](const std::string &message)
+          {
+            if (capture_)
+            {
+              capture_->record(private_futures_capture_id_, message);
+            }
+            if (private_futures_heartbeat_->on_frame(message))
+            {
+              return;
+            }
+            sample_private_clock(private_futures_clock_, message);
+            enqueue_private(PRIMARY_SOURCE, private_futures_inbox_, message);
+          }
+        );
+      }
+
+      void Gateway::connect_private_stream()
+      {
+        private_stream_client_->run(
+          [this](const HttpResponsePtr &response){
+            private_stream_heartbeat_->start();
+            private_stream_reconnect_->on_open(private_stream_client_->last_connect());
+            private_stream_send_->send(futures_login_frame(stream_login_id_), SendQueue::Priority::OTHER, true);
+          },
+          [this](){
+            private_stream_heartbeat_->stop();
+            private_stream_reconnect_->on_close();
+            health_.set_fault(GatewayHealth::PRIVATE_FUTURES_STREAM, true, "socket closed");
+            stream_authenticated_ = false;
+          },
+          [this](const std::string &message)
+          {
+            if (capture_)
+            {
+              capture_->record(private_stream_capture_id_, message);
+            }
+            if (private_stream_heartbeat_->on_frame(message))
+            {
+              return;
+            }
+            sample_private_clock(private_stream_clock_, message);
+            enqueue_private(PRIMARY_SOURCE, private_stream_inbox_, message);
+          }
+        );
+      }
+
       void Gateway::run_private_futures_ws()
       {
         if(futures_login_status)
@@ -963,24 +1489,153 @@ namespace singular
           //log
           if(private_futures_client_)
           {
-            private_futures_client_->run(
-              [this](const HttpResponsePtr &response){
-
-              },
-              [this](){
-                private_futures_status_=singular::types::GatewayStatus::OFFLINE;
-                authenticated_=false;
-              },
-              [this](const std::string &message)
-              {
-                parse_websocket_private(message);
-              }
-            );
-            while(!private_futures_client_->is_open());
-            login_futures_private();
+            // Login goes out from the open callback, so this returns while the socket connects
+            private_futures_reconnect_->resume();
+            connect_private_futures();
+            if (private_stream_client_)
+            {
+              private_stream_reconnect_->resume();
+              connect_private_stream();
+            }
+            if (futures_standby_)
+            {
+              futures_standby_->run();
+            }
+          }
+        }
+      }
+      void Gateway::start_private_session(size_t session)
+      {
+        if (session_started_[session])
+        {
+          return;
+        }
+        session_started_[session] = true;
+        ++session_starts_[session];
+        singular::utility::log_event(log_service_name, singular::utility::OEMSEvent::WS_CONNECTION_DEBUG,
+                                     std::string("Connecting the private ") + (session == SPOT_SESSION ? "spot" : "futures") + " session on first use");
+        if (session == SPOT_SESSION)
+        {
+          health_.set_watched(GatewayHealth::PRIVATE_SPOT, true, false, "connecting");
+          run_private_spot_ws();
+          return;
+        }
+        health_.set_watched(GatewayHealth::PRIVATE_FUTURES, true, true, "connecting");
+        if (private_stream_client_)
+        {
+          health_.set_watched(GatewayHealth::PRIVATE_FUTURES_STREAM, true, false, "connecting");
+        }
+        run_private_futures_ws();
+      }
+
+      void Gateway::stop_private_session(size_t session, const std::string &reason)
+      {
+        session_started_[session] = false;
+        if (session == SPOT_SESSION)
+        {
+          private_spot_reconnect_->stop();
+          private_spot_client_->close();
+          spot_authenticated_ = false;
+          health_.set_watched(GatewayHealth::PRIVATE_SPOT, false, false, reason);
+        }
+        else
+        {
+          if (futures_standby_)
+          {
+            futures_standby_->close();
+          }
+          private_futures_reconnect_->stop();
+          private_futures_client_->close();
+          futures_authenticated_ = false;
+          health_.set_watched(GatewayHealth::PRIVATE_FUTURES, false, false, reason);
+          if (private_stream_client_)
+          {
+            private_stream_reconnect_->stop();
+            private_stream_client_->close();
+            stream_authenticated_ = false;
+            health_.set_watched(GatewayHealth::PRIVATE_FUTURES_STREAM, false, false, reason);
+          }
+        }
+      }
+
+      void Gateway::flush_deferred_requests(size_t session)
+      {
+        std::vector<DeferredRequest> deferred;
+        deferred.swap(deferred_requests_[session]);
+        for (const DeferredRequest &request : deferred)
+        {
+          if (!send_order_request(*request.route, request.channel, request.req_id, request.frame, request.priority))
+          {
+            singular::utility::log_event(log_service_name, singular::utility::OEMSEvent::PLACE_ORDER_ERROR,
+                                         "Send queue full, held request " + request.req_id + " dropped after login");
+            if (request.priority == SendQueue::Priority::PLACE)
+            {
+              reject_place(std::strtoull(request.req_id.c_str(), nullptr, 10), "SEND_QUEUE_FULL");
+            }
+          }
+        }
+      }
+
+      void Gateway::reject_place(singular::types::OrderId order_id, const std::string &reason)
+      {
+        auto client = internal_to_client_id_map_.find(order_id);
+        if (client == internal_to_client_id_map_.end())
+        {
+          return;
+        }
+        // The place never went out: nothing will ack it, so it is finished here and reported
+        // on the order channel as a reject, like the engine's own rejects
+        private_orders_.on_reject(client->second);
+        internal_to_route_map_.erase(order_id);
+        nlohmann::json rejected = {{"ordId", ""}, {"sCode", "429"}, {"sMsg", reason}};
+        stream_order_data({{"id", std::to_string(client->second)}, {"data", nlohmann::json::array({rejected})}}, "order_reject");
+        singular::utility::log_event(log_service_name, singular::utility::OEMSEvent::PLACE_ORDER_ERROR,
+                                     reason + ", place " + std::to_string(order_id) + " for " + client_id_to_symbol_map_[client->second] + " rejected");
+      }
+
+      void Gateway::reap_idle_sessions()
+      {
+        const int64_t now = steady_ns();
+        for (size_t session : {FUTURES_SESSION, SPOT_SESSION})
+        {
+          // Open orders keep their sessions: fills and cancels still need them
+          if (!session_started_[session] || !deferred_requests_[session].empty() || private_orders_.open(session) != 0 ||
+              now - session_last_use_ns_[session] < idle_timeout_ns_)
+          {
+            continue;
           }
+          ++session_idle_closes_[session];
+          stop_private_session(session, "idle");
+          singular::utility::log_event(log_service_name, singular::utility::OEMSEvent::WS_CONNECTION_DEBUG,
+                                       std::string("Closed the idle private ") + (session == SPOT_SESSION ? "spot" : "futures") + " session");
+        }
+      }
+
+      nlohmann::json Gateway::get_startup_stats()
+      {
+        const int64_t rss_now = resident_bytes();
+        nlohmann::json stats;
+        stats["name"] = name_;
+        stats["lazy"] = lazy_connect_;
+        stats["construct_ns"] = construct_ns_;
+        stats["ready_ns"] = ready_time_ns_.load();
+        stats["rss_before_bytes"] = rss_before_bytes_;
+        stats["rss_after_bytes"] = rss_after_bytes_;
+        stats["rss_construct_delta_bytes"] = rss_after_bytes_ - rss_before_bytes_;
+        stats["rss_now_bytes"] = rss_now;
+        stats["sessions"] = nlohmann::json::object();
+        for (size_t session : {FUTURES_SESSION, SPOT_SESSION})
+        {
+          stats["sessions"][session == SPOT_SESSION ? "spot" : "futures"] = {{"started", session_started_[session]},
+                                                                            {"starts", session_starts_[session]},
+                                                                            {"idle_closes", session_idle_closes_[session]},
+                                                                            {"held_requests", deferred_requests_[session].size()}};
         }
+        stats["stream_session"] = private_stream_client_ != nullptr && session_started_[FUTURES_SESSION];
+        stats["market_data"] = hub_->get_stats()["markets"];
+        return stats;
       }
+
        std::string Gateway::generate_hmac_sha512_hex(const std::string &message, const std::string &secret_key) 
        {
           unsigned char hmac_result[EVP_MAX_MD_SIZE] = {0};
@@ -1025,12 +1680,12 @@ namespace singular
         message["payload"]["timestamp"] = std::to_string(timestamp);
         message["payload"]["signature"] = signature;
     
-        private_spot_client_->send(message.dump());
+        private_spot_send_->send(message.dump(), SendQueue::Priority::OTHER, true);
         singular::utility::log_event(log_service_name, singular::utility::OEMSEvent::LOGIN_EXCHANGE_SUCCESS, "Sent a private login message to the exchange");
       }
 
-      void Gateway::login_futures_private() //need to call this twice for 2 private clients
-      { 
+      std::string Gateway::futures_login_frame(const std::string &req_id)
+      {
         auto timestamp = std::chrono::duration_cast<std::chrono::seconds>(
                              std::chrono::system_clock::now().time_since_epoch())
                              .count();
@@ -1051,11 +1706,15 @@ namespace singular
         message["channel"] = "futures.login";
         message["event"] = "api";
         message["payload"]["api_key"] = key_;
-        message["payload"]["req_id"] = name_;
+        message["payload"]["req_id"] = req_id;
         message["payload"]["timestamp"] = std::to_string(timestamp);
         message["payload"]["signature"] = signature;
-    
-        private_futures_client_->send(message.dump());
+        return message.dump();
+      }
+
+      void Gateway::login_futures_private() //need to call this twice for 2 private clients
+      { 
+        private_futures_send_->send(futures_login_frame(name_), SendQueue::Priority::OTHER, true);
 
         singular::utility::log_event(log_service_name, singular::utility::OEMSEvent::LOGIN_EXCHANGE_SUCCESS, "Sent a private login message to the exchange");
       }
@@ -1098,6 +1757,13 @@ namespace singular
           return; // Exit the function as parsing failed
         }
 
+        // Order and usertrade pushes carry no header; with a stream session they arrive on their own socket
+        if (!message.contains("header") && message.contains("channel"))
+        {
+          handle_private_push(message);
+          return;
+        }
+
         if (message.contains("header"))
         { 
           std::string channel=message["header"]["channel"];
@@ -1109,10 +1775,29 @@ namespace singular
             {
               if (status==200)
               {
-                authenticated_ = true;
-                public_status_ = singular::types::GatewayStatus::ONLINE;
-                private_spot_status_ = singular::types::GatewayStatus::ONLINE;
-                private_futures_status_ = singular::types::GatewayStatus::ONLINE;
+                if (message.contains("data") && message["data"].contains("result") && message["data"]["result"].contains("uid"))
+                {
+                  user_id_ = id_string(message["data"]["result"]["uid"]);
+                }
+                if (!stream_login_id_.empty() && message.value("request_id", "") == stream_login_id_)
+                {
+                  // The stream session takes no orders; it only carries the futures pushes
+                  private_stream_reconnect_->on_restored();
+                  mark_ready(READY_PRIVATE_STREAM);
+                  stream_authenticated_ = true;
+                  health_.set_fault(GatewayHealth::PRIVATE_FUTURES_STREAM, false, "logged in");
+                  singular::utility::log_event(log_service_name, singular::utility::OEMSEvent::LOGIN_EXCHANGE_SUCCESS, "Stream session logged in");
+                  subscribe_fills(private_stream_send_.get(), false);
+                  return;
+                }
+                Reconnector *reconnect = channel == "futures.login" ? private_futures_reconnect_.get() : private_spot_reconnect_.get();
+                if (reconnect)
+                {
+                  reconnect->on_restored();
+                }
+                mark_ready(channel == "futures.login" ? READY_PRIVATE_FUTURES : READY_PRIVATE_SPOT);
+                (channel == "futures.login" ? futures_authenticated_ : spot_authenticated_) = true;
+                health_.set_fault(channel == "futures.login" ? GatewayHealth::PRIVATE_FUTURES : GatewayHealth::PRIVATE_SPOT, false, "logged in");
 
                 // Send Login Success Response to the endpoint
                 singular::types::EventDetail detail("OK",
@@ -1123,7 +1808,12 @@ namespace singular
                 send_operation_response("SUCCESS", detail);
                 singular::utility::log_event(log_service_name, singular::utility::OEMSEvent::LOGIN_EXCHANGE_SUCCESS, "Logged in successfully");
 
-                subscribe_fills();
+                const bool spot = channel == "spot.login";
+                if (spot || !private_stream_client_)
+                {
+                  subscribe_fills(spot ? private_spot_send_.get() : private_futures_send_.get(), spot);
+                }
+                flush_deferred_requests(spot ? SPOT_SESSION : FUTURES_SESSION);
                 do_subscribe_positions();
                 do_subscribe_account();
               }
@@ -1148,6 +1838,13 @@ namespace singular
             {  
               if (status==200)
               {
+                // The final response carries the order; its text maps it back to the client id
+                if (message.contains("data") && message["data"].contains("result") && message["data"]["result"].is_object() &&
+                    message["data"]["result"].contains("text"))
+                {
+                  const nlohmann::json &result = message["data"]["result"];
+                  private_orders_.on_ack(PrivateOrderTable::parse_text(result["text"].get<std::string>()), id_string(result.value("id", nlohmann::json())));
+                }
                 singular::types::EventDetail detail("OK",
                                                     status,
                                                     "Order Request sent",
@@ -1159,6 +1856,12 @@ namespace singular
               }
               else
               {
+                // The rejected order never reaches the book, so no push will finish its entry
+                auto rejected = internal_to_client_id_map_.find(std::strtoull(message.value("request_id", "").c_str(), nullptr, 10));
+                if (rejected != internal_to_client_id_map_.end())
+                {
+                  private_orders_.on_reject(rejected->second);
+                }
                 singular::types::EventDetail detail(message["data"]["errs"]["label"],
                                                     status,
                                                     "FAILED",
@@ -1243,6 +1946,70 @@ namespace singular
       }
       }
 
+      void Gateway::handle_private_push(const nlohmann::json &message)
+      {
+        const std::string channel = message.value("channel", "");
+        const std::string event = message.value("event", "");
+        if (event == "subscribe" || event == "unsubscribe")
+        {
+          if (message.contains("error") && !message["error"].is_null())
+          {
+            singular::utility::log_event(log_service_name, singular::utility::OEMSEvent::WS_CONNECTION_ERROR, "Subscription to " + channel + " failed: " + message["error"].dump());
+          }
+          return;
+        }
+        if (event != "update" || !message.contains("result") || !message["result"].is_array())
+        {
+          return;
+        }
+        const bool orders = channel == "futures.orders" || channel == "spot.orders";
+        const bool trades = channel == "futures.usertrades" || channel == "spot.usertrades";
+        for (const auto &item : message["result"])
+        {
+          const std::string exchange_id = id_string(item.value(orders ? "id" : "order_id", nlohmann::json()));
+          uint64_t client_id = PrivateOrderTable::parse_text(item.value("text", ""));
+          if (client_id == 0)
+          {
+            client_id = private_orders_.client_id(exchange_id);
+          }
+          if (client_id == 0 || client_to_internal_id_map_.find(client_id) == client_to_internal_id_map_.end())
+          {
+            continue; // not placed through this gateway
+          }
+          nlohmann::json data = {{"ordId", exchange_id}};
+          std::string state;
+          if (orders)
+          {
+            // Futures report size/left in contracts, spot amount/left in base currency
+            const double size = std::abs(json_number(item.contains("size") ? item["size"] : item.value("amount", nlohmann::json())));
+            const double filled = size - std::abs(json_number(item.value("left", nlohmann::json())));
+            const bool finished = item.value("status", "") == "finished" || item.value("event", "") == "finish";
+            if (finished)
+            {
+              state = item.value("finish_as", "") == "filled" ? "filled" : "canceled";
+            }
+            else
+            {
+              state = filled > 0 ? "partially_filled" : "live";
+            }
+            data["accFillSz"] = filled;
+            private_orders_.on_push(client_id, exchange_id, state, filled, finished);
+          }
+          else if (trades)
+          {
+            state = "fill";
+            data["tradeId"] = id_string(item.value("id", nlohmann::json()));
+            data["fillPx"] = json_number(item.value("price", nlohmann::json()));
+            data["fillSz"] = std::abs(json_number(item.contains("size") ? item["size"] : item.value("amount", nlohmann::json())));
+          }
+          else
+          {
+            return;
+          }
+          stream_order_data({{"id", std::to_string(client_id)}, {"data", nlohmann::json::array({data})}}, state);
+        }
+      }
+
       void Gateway::stream_order_data(nlohmann::json message, const std::string order_state)
       {
         auto client_id = std::stoull(static_cast<std::string>(message["id"]));
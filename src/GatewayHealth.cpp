@@ -0,0 +1,189 @@
+#include <chrono>
+
+#include "gateio/include/GatewayHealth.h"
+#include <singular/utility/include/LatencyLogger.h>
+
+namespace singular
+{
+  namespace gateway
+  {
+    namespace gateio
+    {
+
+      namespace
+      {
+        constexpr int SEQUENCE_SHIFT = 40;
+
+        uint64_t make_word(uint64_t sequence, GatewayHealth::State state, uint32_t faults)
+        {
+          return (sequence << SEQUENCE_SHIFT) | (static_cast<uint64_t>(state) << 32) | faults;
+        }
+      }
+
+      GatewayHealth::GatewayHealth(const std::string &name)
+          : name_(name),
+            word_(make_word(0, State::DOWN, 0))
+      {
+      }
+
+      void GatewayHealth::watch(uint32_t components, uint32_t critical)
+      {
+        watched_ = components;
+        critical_ = critical & components;
+        // Sockets are down until they report otherwise; books are valid until a gap says otherwise
+        uint32_t faults = components & ~BOOKS;
+        uint64_t word = word_.load();
+        word_ = make_word((word >> SEQUENCE_SHIFT) + 1, classify(faults), faults);
+      }
+
+      void GatewayHealth::set_watched(uint32_t component, bool watched, bool critical, const std::string &reason)
+      {
+        if (watched)
+        {
+          watched_.fetch_or(component);
+          critical ? critical_.fetch_or(component) : critical_.fetch_and(~component);
+        }
+        else
+        {
+          watched_.fetch_and(~component);
+          critical_.fetch_and(~component);
+        }
+        // Re-derives the state with the new masks
+        set_fault(component, watched, reason);
+      }
+
+      GatewayHealth::State GatewayHealth::classify(uint32_t faults) const
+      {
+        const uint32_t watched = faults & watched_.load(std::memory_order_relaxed);
+        if (watched == 0)
+        {
+          return State::UP;
+        }
+        return watched & critical_.load(std::memory_order_relaxed) ? State::DOWN : State::DEGRADED;
+      }
+
+      void GatewayHealth::set_fault(uint32_t component, bool fault, const std::string &reason)
+      {
+        uint64_t word = word_.load(std::memory_order_relaxed);
+        uint64_t next = word;
+        do
+        {
+          const uint32_t faults = fault ? static_cast<uint32_t>(word) | component : static_cast<uint32_t>(word) & ~component;
+          const State to = classify(faults);
+          const uint64_t sequence = (word >> SEQUENCE_SHIFT) + (to != state_of(word) ? 1 : 0);
+          next = make_word(sequence, to, faults);
+        } while (next != word && !word_.compare_exchange_weak(word, next));
+
+        const State from = state_of(word);
+        const State to = state_of(next);
+        if (from == to)
+        {
+          return;
+        }
+
+        Transition transition{from, to, component, reason,
+                              std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                  std::chrono::system_clock::now().time_since_epoch())
+                                  .count()};
+        singular::utility::log_event(name_,
+                                     to == State::UP ? singular::utility::OEMSEvent::WS_CONNECTION_DEBUG : singular::utility::OEMSEvent::WS_CONNECTION_ERROR,
+                                     std::string("Gateway health ") + to_string(from) + " -> " + to_string(to) + " (" + component_name(component) + ": " + reason + ")");
+        {
+          std::lock_guard<std::mutex> lock(history_mutex_);
+          history_.push_back(transition);
+          if (history_.size() > MAX_HISTORY)
+          {
+            history_.pop_front();
+          }
+        }
+        if (on_transition_)
+        {
+          on_transition_(transition);
+        }
+      }
+
+      void GatewayHealth::on_book_validity(bool valid)
+      {
+        if (valid)
+        {
+          if (invalid_books_.fetch_sub(1) == 1)
+          {
+            set_fault(BOOKS, false, "all books in sequence");
+          }
+        }
+        else if (invalid_books_.fetch_add(1) == 0)
+        {
+          set_fault(BOOKS, true, "book sequence gap");
+        }
+      }
+
+      const char *GatewayHealth::to_string(State state)
+      {
+        switch (state)
+        {
+        case State::DOWN:
+          return "DOWN";
+        case State::DEGRADED:
+          return "DEGRADED";
+        case State::UP:
+          return "UP";
+        }
+        return "UNKNOWN";
+      }
+
+      const char *GatewayHealth::component_name(uint32_t component)
+      {
+        switch (component)
+        {
+        case PUBLIC_SPOT:
+          return "public spot";
+        case PUBLIC_FUTURES_USDT:
+          return "public futures usdt";
+        case PUBLIC_FUTURES_BTC:
+          return "public futures btc";
+        case PRIVATE_SPOT:
+          return "private spot";
+        case PRIVATE_FUTURES:
+          return "private futures";
+        case BOOKS:
+          return "books";
+        case PRIVATE_FUTURES_STREAM:
+          return "private futures stream";
+        }
+        return "unknown";
+      }
+
+      nlohmann::json GatewayHealth::get_stats() const
+      {
+        const uint64_t word = word_.load();
+        const uint32_t faults = static_cast<uint32_t>(word);
+        nlohmann::json stats;
+        stats["state"] = to_string(state_of(word));
+        stats["transitions"] = word >> SEQUENCE_SHIFT;
+        stats["invalid_books"] = invalid_books_.load();
+        stats["components"] = nlohmann::json::array();
+        for (uint32_t component = PUBLIC_SPOT; component <= LAST_COMPONENT; component <<= 1)
+        {
+          if (watched_ & component)
+          {
+            stats["components"].push_back({{"name", component_name(component)},
+                                           {"fault", (faults & component) != 0},
+                                           {"critical", (critical_ & component) != 0}});
+          }
+        }
+        stats["history"] = nlohmann::json::array();
+        std::lock_guard<std::mutex> lock(history_mutex_);
+        for (const Transition &transition : history_)
+        {
+          stats["history"].push_back({{"from", to_string(transition.from)},
+                                      {"to", to_string(transition.to)},
+                                      {"component", component_name(transition.component)},
+                                      {"reason", transition.reason},
+                                      {"time_ns", transition.time_ns}});
+        }
+        return stats;
+      }
+
+    } // namespace gateio
+  } // namespace gateway
+} // namespace singular
@@ -0,0 +1,209 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <string_view>
+
+#include "gateio/include/Heartbeat.h"
+#include "gateio/include/Tsc.h"
+#include <singular/utility/include/LatencyLogger.h>
+
+namespace singular
+{
+  namespace gateway
+  {
+    namespace gateio
+    {
+
+      namespace
+      {
+        int64_t now_ns()
+        {
+          return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                     std::chrono::steady_clock::now().time_since_epoch())
+              .count();
+        }
+
+        int64_t frame_integer(const std::string &frame, const char *key)
+        {
+          size_t at = frame.find(key);
+          if (at == std::string::npos)
+          {
+            return 0;
+          }
+          return std::strtoll(frame.c_str() + at + std::strlen(key), nullptr, 10);
+        }
+
+        // Only the channel name is read. It sits among the first fields of every Gate.io frame,
+        // so market data frames are never scanned to their end.
+        constexpr size_t CHANNEL_SCAN_BYTES = 256;
+        constexpr std::string_view CHANNEL_KEY = "\"channel\":\"";
+        constexpr std::string_view PONG_SUFFIX = ".pong";
+
+        bool is_pong(const std::string &frame)
+        {
+          const std::string_view head(frame.data(), std::min(frame.size(), CHANNEL_SCAN_BYTES));
+          const size_t at = head.find(CHANNEL_KEY);
+          if (at == std::string_view::npos)
+          {
+            return false;
+          }
+          const size_t name = at + CHANNEL_KEY.size();
+          const size_t end = frame.find('"', name);
+          return end != std::string::npos && end - name >= PONG_SUFFIX.size() &&
+                 frame.compare(end - PONG_SUFFIX.size(), PONG_SUFFIX.size(), PONG_SUFFIX.data()) == 0;
+        }
+      }
+
+      Heartbeat::Heartbeat(hv::EventLoopPtr loop, const std::string &name, const char *ping_channel, SendFunction send, const Options &options)
+          : loop_(std::move(loop)),
+            name_(name),
+            ping_channel_(ping_channel),
+            send_(std::move(send)),
+            options_(options)
+      {
+        frame_buffer_.reserve(96);
+      }
+
+      Heartbeat::~Heartbeat()
+      {
+        if (timer_ != INVALID_TIMER_ID)
+        {
+          loop_->killTimer(timer_);
+        }
+      }
+
+      void Heartbeat::start()
+      {
+        last_frame_ns_ = now_ns();
+        sent_.fill(SentPing{});
+        outstanding_id_ = 0;
+        outstanding_send_ns_ = 0;
+        slow_in_row_ = 0;
+        stale_ = false;
+        if (options_.interval_ms <= 0 || timer_ != INVALID_TIMER_ID)
+        {
+          return;
+        }
+        timer_ = loop_->setInterval(options_.interval_ms, [this](hv::TimerID)
+                                    { tick(); });
+      }
+
+      void Heartbeat::stop()
+      {
+        if (timer_ != INVALID_TIMER_ID)
+        {
+          loop_->killTimer(timer_);
+          timer_ = INVALID_TIMER_ID;
+        }
+        outstanding_id_ = 0;
+        outstanding_send_ns_ = 0;
+      }
+
+      bool Heartbeat::on_frame(const std::string &frame)
+      {
+        const int64_t receive_ns = now_ns();
+        last_frame_ns_ = receive_ns;
+        if (!is_pong(frame))
+        {
+          return false;
+        }
+
+        const int64_t id = frame_integer(frame, "\"id\":");
+        auto ping = std::find_if(sent_.begin(), sent_.end(), [id](const SentPing &sent)
+                                 { return sent.id == id; });
+        if (id <= 0 || ping == sent_.end())
+        {
+          return true; // not one of ours, or too old to time
+        }
+        const int64_t rtt = receive_ns - ping->send_ns;
+        *ping = SentPing{};
+        if (id == outstanding_id_)
+        {
+          outstanding_id_ = 0;
+          outstanding_send_ns_ = 0;
+        }
+        ++pongs_;
+        last_rtt_ns_ = rtt;
+        const int64_t smoothed = smoothed_rtt_ns_;
+        smoothed_rtt_ns_ = smoothed == 0 ? rtt : smoothed + (rtt - smoothed) / 8;
+        {
+          std::lock_guard<std::mutex> lock(rtt_mutex_);
+          rtt_.record(static_cast<uint64_t>(rtt));
+        }
+        slow_in_row_ = rtt > options_.stale_rtt_ms * 1000000LL ? slow_in_row_ + 1 : 0;
+        if (clock_)
+        {
+          clock_->on_pong(id, wall_clock_ns(), frame_integer(frame, "\"time_ms\":"));
+        }
+        return true;
+      }
+
+      void Heartbeat::tick()
+      {
+        if (stale_)
+        {
+          return;
+        }
+        const int64_t now = now_ns();
+        const int64_t wall_now = wall_clock_ns();
+        if (now - last_frame_ns_ > options_.stale_silence_ms * 1000000LL)
+        {
+          declare_stale("no frames for " + std::to_string((now - last_frame_ns_) / 1000000) + "ms");
+          return;
+        }
+        if (outstanding_id_ != 0 && now - outstanding_send_ns_ > options_.stale_rtt_ms * 1000000LL)
+        {
+          declare_stale("pong overdue by " + std::to_string((now - outstanding_send_ns_) / 1000000) + "ms");
+          return;
+        }
+        if (slow_in_row_ >= options_.slow_pings)
+        {
+          declare_stale(std::to_string(slow_in_row_) + " pings above " + std::to_string(options_.stale_rtt_ms) + "ms");
+          return;
+        }
+
+        auto time_int = wall_now / 1000000000;
+        frame_buffer_.assign("{\"time\":").append(std::to_string(time_int)).append(",\"id\":").append(std::to_string(wall_now));
+        frame_buffer_.append(",\"channel\":\"").append(ping_channel_).append("\"}");
+        sent_[next_sent_++ % SENT_PINGS] = SentPing{wall_now, now};
+        if (outstanding_id_ == 0)
+        {
+          outstanding_id_ = wall_now;
+          outstanding_send_ns_ = now;
+        }
+        send_(frame_buffer_);
+        ++pings_sent_;
+      }
+
+      void Heartbeat::declare_stale(const std::string &reason)
+      {
+        stale_ = true;
+        ++stale_events_;
+        {
+          std::lock_guard<std::mutex> lock(rtt_mutex_);
+          last_stale_reason_ = reason;
+        }
+        singular::utility::log_event("GATEIO", singular::utility::OEMSEvent::WS_CONNECTION_ERROR, name_ + " is stale: " + reason);
+        if (on_stale_)
+        {
+          on_stale_(reason);
+        }
+      }
+
+      nlohmann::json Heartbeat::get_stats() const
+      {
+        std::lock_guard<std::mutex> lock(rtt_mutex_);
+        return {{"name", name_},
+                {"stale", stale_.load()},
+                {"pings_sent", pings_sent_.load()},
+                {"pongs", pongs_.load()},
+                {"stale_events", stale_events_.load()},
+                {"last_stale_reason", last_stale_reason_},
+                {"last_rtt_ms", last_rtt_ns_.load() / 1e6},
+                {"smoothed_rtt_ms", smoothed_rtt_ns_.load() / 1e6},
+                {"rtt_ns", rtt_.to_json()}};
+      }
+
+    } // namespace gateio
+  } // namespace gateway
+} // namespace singular
@@ -0,0 +1,88 @@
+#include <mutex>
+
+#include "gateio/include/InstrumentCatalog.h"
+
+namespace singular
+{
+  namespace gateway
+  {
+    namespace gateio
+    {
+
+      InstrumentCatalog &InstrumentCatalog::instance()
+      {
+        static InstrumentCatalog catalog;
+        return catalog;
+      }
+
+      std::string InstrumentCatalog::market_suffix(const std::string &instrument_type)
+      {
+        if (instrument_type == "SPOT")
+        {
+          return "SPOT";
+        }
+        if (instrument_type == "LINEAR_PERPETUAL" || instrument_type == "INVERSE_PERPETUAL")
+        {
+          return "FUTURE";
+        }
+        if (instrument_type == "LINEAR_FUTURE" || instrument_type == "INVERSE_FUTURE")
+        {
+          return "DELIVERY";
+        }
+        if (instrument_type == "OPTION")
+        {
+          return "OPTION";
+        }
+        return "UNKNOWN";
+      }
+
+      void InstrumentCatalog::load(const nlohmann::json &instruments)
+      {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        for (const auto &instrument : instruments)
+        {
+          CatalogEntry entry;
+          entry.symbol = instrument.value("symbol", "");
+          entry.instrument_type = instrument.value("instrument_type", "UNKNOWN");
+          entry.base = instrument.value("base", "");
+          entry.quote = instrument.value("quote", "");
+          entry.settle = instrument.value("settle", "");
+          entry.funding_interval_s = instrument.value("funding_interval", 0LL);
+          entry.funding_next_apply_s = instrument.value("funding_next_apply", 0LL);
+          if (entry.symbol.empty())
+          {
+            continue;
+          }
+          std::string key = entry.symbol + "@" + market_suffix(entry.instrument_type);
+          entries_[key] = std::move(entry);
+        }
+      }
+
+      bool InstrumentCatalog::find(const std::string &internal_symbol, CatalogEntry &entry) const
+      {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = entries_.find(internal_symbol);
+        if (it == entries_.end())
+        {
+          return false;
+        }
+        entry = it->second;
+        return true;
+      }
+
+      std::string InstrumentCatalog::settle_of(const std::string &internal_symbol) const
+      {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = entries_.find(internal_symbol);
+        return it == entries_.end() ? std::string() : it->second.settle;
+      }
+
+      size_t InstrumentCatalog::size() const
+      {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        return entries_.size();
+      }
+
+    } // namespace gateio
+  } // namespace gateway
+} // namespace singular
@@ -0,0 +1,231 @@
+#include <chrono>
+#include <stdexcept>
+
+#include "gateio/include/MarketDataConflator.h"
+
+namespace singular
+{
+  namespace gateway
+  {
+    namespace gateio
+    {
+
+      namespace
+      {
+        int64_t now_ns()
+        {
+          return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                     std::chrono::steady_clock::now().time_since_epoch())
+              .count();
+        }
+      }
+
+      MarketDataConflator::Producer::Producer(MarketDataConflator &owner)
+          : owner_(owner),
+            backlog_(owner.enabled_ ? 2 : PASS_THROUGH_CAPACITY),
+            ready_(READY_CAPACITY)
+      {
+      }
+
+      void MarketDataConflator::Producer::mark_dirty(Slot &slot, const BookState &state, int64_t published_ns)
+      {
+        bool became_dirty = false;
+        slot.acquire();
+        slot.state = state;
+        if (slot.dirty)
+        {
+          ++slot.conflated;
+        }
+        else
+        {
+          slot.dirty = true;
+          slot.pending_since_ns = published_ns;
+          became_dirty = true;
+        }
+        slot.release();
+
+        // At most one ready entry per slot is outstanding, so this only fails with more than
+        // READY_CAPACITY symbols; the update then waits for the next publish of the symbol
+        if (became_dirty && !ready_.try_push(&slot))
+        {
+          slot.acquire();
+          slot.dirty = false;
+          slot.release();
+        }
+      }
+
+      void MarketDataConflator::Producer::publish(const BookState &state)
+      {
+        if (!owner_.consumer_attached_.load(std::memory_order_relaxed))
+        {
+          return;
+        }
+        Slot *slot = nullptr;
+        auto cached = slot_cache_.find(state.symbol);
+        if (cached != slot_cache_.end())
+        {
+          slot = cached->second;
+        }
+        else
+        {
+          slot = owner_.slot_for(state.symbol);
+          slot_cache_.emplace(state.symbol, slot);
+        }
+
+        const int64_t published_ns = now_ns();
+        slot->acquire();
+        ++slot->published;
+        slot->release();
+
+        if (!owner_.enabled_)
+        {
+          if (backlog_.produce_one([&](QueuedState &queued)
+                                   {
+                                     queued.state = state;
+                                     queued.published_ns = published_ns;
+                                     queued.slot = slot; }))
+          {
+            return;
+          }
+          // Consumer is a full queue behind: degrade to conflation instead of dropping
+          slot->acquire();
+          ++slot->overflowed;
+          slot->release();
+        }
+
+        mark_dirty(*slot, state, published_ns);
+      }
+
+      MarketDataConflator::MarketDataConflator(bool enabled)
+          : enabled_(enabled)
+      {
+      }
+
+      MarketDataConflator::Producer *MarketDataConflator::add_producer()
+      {
+        std::lock_guard<std::mutex> lock(producers_mutex_);
+        size_t index = producer_count_.load();
+        if (index >= MAX_PRODUCERS)
+        {
+          throw std::runtime_error("Too many market data producers");
+        }
+        owned_producers_.push_back(std::unique_ptr<Producer>(new Producer(*this)));
+        producers_[index].store(owned_producers_.back().get(), std::memory_order_release);
+        producer_count_.store(index + 1, std::memory_order_release);
+        return owned_producers_.back().get();
+      }
+
+      MarketDataConflator::Slot *MarketDataConflator::slot_for(const std::string &symbol)
+      {
+        std::lock_guard<std::mutex> lock(slots_mutex_);
+        auto &slot = slots_[symbol];
+        if (!slot)
+        {
+          slot = std::make_unique<Slot>();
+        }
+        return slot.get();
+      }
+
+      void MarketDataConflator::record_lag(Slot &slot, int64_t lag_ns)
+      {
+        slot.last_lag_ns = lag_ns;
+        if (lag_ns > slot.max_lag_ns)
+        {
+          slot.max_lag_ns = lag_ns;
+        }
+      }
+
+      // Called with the slot lock held; skips states older than what the consumer already saw
+      bool MarketDataConflator::deliver(Slot &slot, const BookState &state, int64_t published_ns)
+      {
+        if (state.last_update_id != 0 && state.last_update_id <= slot.delivered_update_id)
+        {
+          return false;
+        }
+        slot.delivered_update_id = state.last_update_id;
+        ++slot.delivered;
+        record_lag(slot, now_ns() - published_ns);
+        return true;
+      }
+
+      size_t MarketDataConflator::consume(const Consumer &consumer)
+      {
+        size_t delivered = 0;
+        if (!consumer_attached_.load(std::memory_order_relaxed))
+        {
+          consumer_attached_.store(true, std::memory_order_relaxed);
+        }
+        const size_t producers = producer_count_.load(std::memory_order_acquire);
+
+        for (size_t i = 0; i < producers; ++i)
+        {
+          Producer *producer = producers_[i].load(std::memory_order_acquire);
+
+          while (producer->backlog_.consume_one([&](Producer::QueuedState &queued)
+                                                {
+                                                  Slot &slot = *queued.slot;
+                                                  slot.acquire();
+                                                  bool fresh = deliver(slot, queued.state, queued.published_ns);
+                                                  slot.release();
+                                                  if (fresh)
+                                                  {
+                                                    consumer(queued.state);
+                                                    ++delivered;
+                                                  } }))
+          {
+          }
+
+          Slot *slot = nullptr;
+          while (producer->ready_.try_pop(slot))
+          {
+            slot->acquire();
+            if (!slot->dirty)
+            {
+              slot->release();
+              continue;
+            }
+            // Swap rather than copy; the producer's next assignment reuses our old buffers
+            std::swap(consume_scratch_, slot->state);
+            slot->dirty = false;
+            bool fresh = deliver(*slot, consume_scratch_, slot->pending_since_ns);
+            slot->release();
+            if (fresh)
+            {
+              consumer(consume_scratch_);
+              ++delivered;
+            }
+          }
+        }
+        return delivered;
+      }
+
+      nlohmann::json MarketDataConflator::get_stats() const
+      {
+        nlohmann::json stats = nlohmann::json::array();
+        const int64_t now = now_ns();
+        std::lock_guard<std::mutex> slots_lock(slots_mutex_);
+        for (const auto &entry : slots_)
+        {
+          Slot &slot = *entry.second;
+          slot.acquire();
+          // An undelivered update is lagging by at least its age
+          int64_t current_lag_ns = slot.dirty ? now - slot.pending_since_ns : 0;
+          stats.push_back({{"symbol", entry.first},
+                           {"conflation", enabled_},
+                           {"published", slot.published},
+                           {"delivered", slot.delivered},
+                           {"conflated", slot.conflated},
+                           {"overflowed", slot.overflowed},
+                           {"pending", slot.dirty},
+                           {"backlog", slot.published - slot.delivered - slot.conflated},
+                           {"current_lag_us", current_lag_ns / 1000},
+                           {"last_lag_us", slot.last_lag_ns / 1000},
+                           {"max_lag_us", slot.max_lag_ns / 1000}});
+          slot.release();
+        }
+        return stats;
+      }
+
+    } // namespace gateio
+  } // namespace gateway
+} // namespace singular
@@ -0,0 +1,1028 @@
+#include <algorithm>
+#include <chrono>
+
+#include "gateio/include/MarketDataHub.h"
+#include "gateio/include/Config.h"
+#include "gateio/include/InstrumentCatalog.h"
+#include <singular/utility/include/LatencyLogger.h>
+
+namespace singular
+{
+  namespace gateway
+  {
+    namespace gateio
+    {
+
+      namespace
+      {
+        std::mutex hub_mutex;
+        std::weak_ptr<MarketDataHub> hub_instance;
+
+        int64_t now_ns()
+        {
+          return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                     std::chrono::steady_clock::now().time_since_epoch())
+              .count();
+        }
+
+        const char *market_name(size_t market)
+        {
+          static const char *names[] = {"spot", "futures_usdt", "futures_btc"};
+          return market < 3 ? names[market] : "unknown";
+        }
+      }
+
+      std::shared_ptr<MarketDataHub> MarketDataHub::acquire(hv::EventLoopPtr &executor, const char *spot_url,
+                                                            const char *futures_usdt_url, const char *futures_btc_url,
+                                                            std::shared_ptr<MarketDataConflator> conflator, size_t &owner)
+      {
+        std::lock_guard<std::mutex> lock(hub_mutex);
+        std::shared_ptr<MarketDataHub> hub = hub_instance.lock();
+        if (hub)
+        {
+          owner = hub->attach(conflator);
+          if (owner != MAX_OWNERS)
+          {
+            return hub;
+          }
+        }
+        // No hub yet, or the last one closed with its last owner (or ran out of owner ids)
+        hub = std::make_shared<MarketDataHub>(executor, spot_url, futures_usdt_url, futures_btc_url);
+        hub_instance = hub;
+        owner = hub->attach(conflator);
+        return hub;
+      }
+
+      MarketDataHub::MarketDataHub(hv::EventLoopPtr &executor, const char *spot_url, const char *futures_usdt_url, const char *futures_btc_url)
+          : executor_(executor)
+      {
+        // GATEIO_DEDICATED_LOOPS=0 puts every socket back on the shared executor
+        dedicated_loops_ = env_flag("GATEIO_DEDICATED_LOOPS", true);
+        // GATEIO_LAZY_CONNECT=1 opens a market's sockets with its first subscription and closes
+        // them after GATEIO_IDLE_TIMEOUT_MS without one
+        lazy_ = env_flag("GATEIO_LAZY_CONNECT", false);
+        idle_timeout_ns_ = env_long("GATEIO_IDLE_TIMEOUT_MS", 60000) * 1000000;
+
+        // GATEIO_BOOK_PROFILE sets the default order book stream, GATEIO_BOOK_PROFILES overrides it per symbol
+        book_profiles_.load(env_string("GATEIO_BOOK_PROFILE", ""), env_string("GATEIO_BOOK_PROFILES", ""));
+
+        // Each market gets a pool of public sockets; symbols are spread by measured message rate
+        PublicConnectionPool::Options pool_options;
+        pool_options.connections = static_cast<size_t>(env_long("GATEIO_PUBLIC_POOL_SIZE", 1));
+        // Every socket slot of the three pools registers a producer with each owner's conflator
+        const size_t max_connections = MarketDataConflator::MAX_PRODUCERS / MARKETS;
+        if (pool_options.connections > max_connections)
+        {
+          singular::utility::log_event("GATEIO", singular::utility::OEMSEvent::WS_CONNECTION_DEBUG,
+                                       "GATEIO_PUBLIC_POOL_SIZE capped at " + std::to_string(max_connections));
+          pool_options.connections = max_connections;
+        }
+        pool_options.subscribe_rate = static_cast<double>(env_long("GATEIO_SUBSCRIBE_RATE", 50));
+        pool_options.subscribe_batch = static_cast<size_t>(env_long("GATEIO_SUBSCRIBE_BATCH", 50));
+        pool_options.rebalance_interval_ms = static_cast<int>(env_long("GATEIO_POOL_REBALANCE_MS", 30000));
+        // GATEIO_FEED_AB=1 subscribes every symbol on a second, independent socket and arbitrates by update id
+        pool_options.lines = env_flag("GATEIO_FEED_AB", false) ? 2 : 1;
+        const size_t pool_sockets = pool_options.connections * pool_options.lines;
+
+        // Every socket pings on its own loop and is closed once pongs or frames stop coming back in time
+        pool_options.heartbeat.interval_ms = static_cast<int>(env_long("GATEIO_PING_INTERVAL_MS", 5000));
+        pool_options.heartbeat.stale_rtt_ms = static_cast<int>(env_long("GATEIO_STALE_RTT_MS", 2000));
+        pool_options.heartbeat.stale_silence_ms = static_cast<int>(env_long("GATEIO_STALE_SILENCE_MS", 15000));
+
+        // Closed sockets are reopened with jittered exponential backoff, then resubscribed
+        pool_options.reconnect.initial_backoff_ms = static_cast<int>(env_long("GATEIO_RECONNECT_INITIAL_MS", 100));
+        pool_options.reconnect.max_backoff_ms = static_cast<int>(env_long("GATEIO_RECONNECT_MAX_MS", 30000));
+        // GATEIO_SEND_COALESCING=1 flushes subscription storms once per loop iteration
+        pool_options.send.coalesce = env_flag("GATEIO_SEND_COALESCING", false);
+        PublicConnectionPool::Options futures_pool_options = pool_options;
+        futures_pool_options.ping_channel = "futures.ping";
+
+        pools_[SPOT] = std::make_unique<PublicConnectionPool>(
+            "GATEIO_SPOT", make_feed_loops(feed_loops_, dedicated_loops_, "spot", pool_sockets, "GATEIO_CPU_PUBLIC_SPOT", executor_),
+            spot_url, pool_options);
+        pools_[FUTURES_USDT] = std::make_unique<PublicConnectionPool>(
+            "GATEIO_FUTURES_USDT", make_feed_loops(feed_loops_, dedicated_loops_, "usdt", pool_sockets, "GATEIO_CPU_PUBLIC_FUTURES_USDT", executor_),
+            futures_usdt_url, futures_pool_options);
+        pools_[FUTURES_BTC] = std::make_unique<PublicConnectionPool>(
+            "GATEIO_FUTURES_BTC", make_feed_loops(feed_loops_, dedicated_loops_, "btc", pool_sockets, "GATEIO_CPU_PUBLIC_FUTURES_BTC", executor_),
+            futures_btc_url, futures_pool_options);
+
+        // GATEIO_CAPTURE_DIR records every raw frame (public and private) into rotating segment files
+        std::string capture_dir = env_string("GATEIO_CAPTURE_DIR", "");
+        if (!capture_dir.empty())
+        {
+          capture_ = std::make_unique<FeedCapture>(capture_dir,
+                                                   static_cast<size_t>(env_long("GATEIO_CAPTURE_SEGMENT_MB", 256)) << 20,
+                                                   static_cast<size_t>(env_long("GATEIO_CAPTURE_QUEUE", 16384)));
+        }
+
+        // Top of book plus microstructure analytics per symbol, readable lock-free by strategies
+        MarketSnapshotTable::Options snapshot_options;
+        snapshot_options.imbalance_depth = static_cast<size_t>(env_long("GATEIO_IMBALANCE_DEPTH", 5));
+        snapshot_options.vwap_window_ms = env_long("GATEIO_VWAP_WINDOW_MS", 60000);
+        snapshot_options.stale_latency_ns = env_long("GATEIO_STALE_LATENCY_MS", 500) * 1000000;
+        market_snapshots_ = std::make_unique<MarketSnapshotTable>(snapshot_options);
+        market_snapshots_->set_basis_view(&basis_);
+
+        funding_.set_change_callback([this](const std::string &symbol, const FundingRecord &record)
+                                     {
+                                       std::lock_guard<std::mutex> lock(funding_callbacks_mutex_);
+                                       for (auto &callback : funding_callbacks_)
+                                       {
+                                         callback.second(symbol, record);
+                                       } });
+
+        // Feed problems only ever degrade; the order sessions are watched by each gateway.
+        // Lazily connected markets are watched from their first subscription on.
+        health_.watch(lazy_ ? GatewayHealth::BOOKS : GatewayHealth::PUBLIC_SPOT | GatewayHealth::PUBLIC_FUTURES_USDT | GatewayHealth::PUBLIC_FUTURES_BTC | GatewayHealth::BOOKS, 0);
+        if (lazy_ && idle_timeout_ns_ > 0)
+        {
+          const int check_ms = static_cast<int>(std::max<int64_t>(idle_timeout_ns_ / 4000000, 100));
+          idle_timer_ = executor_->setInterval(check_ms, [this](hv::TimerID)
+                                               { reap_idle(); });
+        }
+
+        // One decoder per pool slot, so feed threads share no state. Every decoded book is handed
+        // to one producer per owner; with A/B lines the connections of a slot share the decoder
+        // behind the slot's FeedArbiter.
+        size_t book_depth = static_cast<size_t>(env_long("GATEIO_BOOK_DEPTH", 20));
+        for (auto &pool : pools_)
+        {
+          auto &feeds = public_feeds_[pool.get()];
+          auto &clocks = public_clocks_[pool.get()];
+          auto &arbiters = public_arbiters_[pool.get()];
+          for (size_t i = 0; i < pool->size(); ++i)
+          {
+            clocks.push_back(std::make_unique<ClockEstimator>(pool->name() + "#" + std::to_string(i)));
+            pool->set_clock(i, clocks.back().get());
+            if (capture_)
+            {
+              capture_ids_[pool.get()].push_back(capture_->add_connection(pool->name() + "#" + std::to_string(i)));
+            }
+          }
+          for (size_t i = 0; i < pool->slots(); ++i)
+          {
+            if (pool->lines() > 1)
+            {
+              arbiters.push_back(std::make_unique<FeedArbiter>(pool->name() + "#" + std::to_string(i), pool->lines()));
+            }
+            const size_t feed_index = producers_.size();
+            producers_.push_back(std::make_unique<Producers>());
+            for (auto &producer : *producers_.back())
+            {
+              producer = nullptr;
+            }
+            auto feed = std::make_unique<PublicFeedHandler>(book_depth);
+            feed->set_book_callback([this, feed_index](const BookState &state)
+                                    { publish(feed_index, state); });
+            feed->set_resync_callback([this](const std::string &symbol, bool needed)
+                                      { resync_book(symbol, needed); });
+            feed->set_snapshot_table(market_snapshots_.get());
+            feed->set_funding_table(&funding_);
+            feed->set_clock(clocks[i].get());
+            feed->set_health(&health_);
+            feeds.push_back(std::move(feed));
+          }
+        }
+        for (size_t market = 0; market < MARKETS; ++market)
+        {
+          bind(static_cast<Market>(market));
+        }
+      }
+
+      MarketDataHub::~MarketDataHub()
+      {
+        if (idle_timer_ != INVALID_TIMER_ID)
+        {
+          executor_->killTimer(idle_timer_);
+        }
+        for (auto &pool : pools_)
+        {
+          pool->close();
+        }
+      }
+
+      size_t MarketDataHub::attach(std::shared_ptr<MarketDataConflator> conflator)
+      {
+        std::lock_guard<std::mutex> lock(owners_mutex_);
+        size_t owner = 0;
+        while (owner < conflators_.size() && conflators_[owner])
+        {
+          ++owner;
+        }
+        if (closed_ || owner == MAX_OWNERS)
+        {
+          return MAX_OWNERS;
+        }
+        if (owner == conflators_.size())
+        {
+          conflators_.push_back(std::move(conflator));
+          attached_.push_back(true);
+        }
+        else
+        {
+          conflators_[owner] = std::move(conflator);
+          attached_[owner] = true;
+        }
+        ++attached_count_;
+        if (owner + 1 > owner_count_.load())
+        {
+          owner_count_ = owner + 1;
+        }
+        return owner;
+      }
+
+      void MarketDataHub::add_producers(size_t owner)
+      {
+        std::lock_guard<std::mutex> lock(owners_mutex_);
+        if (owner >= attached_.size() || !attached_[owner])
+        {
+          return;
+        }
+        for (auto &producers : producers_)
+        {
+          if (!(*producers)[owner].load(std::memory_order_relaxed))
+          {
+            (*producers)[owner].store(conflators_[owner]->add_producer(), std::memory_order_release);
+          }
+        }
+      }
+
+      void MarketDataHub::wait_for_feeds()
+      {
+        // publish() runs on the loops of the public sockets; an empty task on each is a barrier
+        for (auto &feed_loop : feed_loops_)
+        {
+          run_in_loop_and_wait(feed_loop->loop(), []() {});
+        }
+        run_in_loop_and_wait(executor_, []() {});
+      }
+
+      void MarketDataHub::publish(size_t feed, const BookState &state)
+      {
+        Producers &producers = *producers_[feed];
+        const size_t owners = owner_count_.load(std::memory_order_acquire);
+        for (size_t owner = 0; owner < owners; ++owner)
+        {
+          MarketDataConflator::Producer *producer = producers[owner].load(std::memory_order_acquire);
+          if (producer)
+          {
+            producer->publish(state);
+          }
+        }
+      }
+
+      void MarketDataHub::detach(size_t owner)
+      {
+        {
+          std::lock_guard<std::mutex> lock(owners_mutex_);
+          if (owner >= attached_.size() || !attached_[owner])
+          {
+            return;
+          }
+          attached_[owner] = false;
+          for (auto &producers : producers_)
+          {
+            (*producers)[owner] = nullptr;
+          }
+        }
+        // The conflator and its producers go with the gateway once no feed thread holds them
+        wait_for_feeds();
+        {
+          std::lock_guard<std::mutex> lock(funding_callbacks_mutex_);
+          funding_callbacks_.erase(std::remove_if(funding_callbacks_.begin(), funding_callbacks_.end(),
+                                                  [owner](const auto &callback) { return callback.first == owner; }),
+                                   funding_callbacks_.end());
+        }
+        {
+          std::lock_guard<std::mutex> lock(markets_mutex_);
+          for (MarketState &market : markets_)
+          {
+            market.on_open.erase(std::remove_if(market.on_open.begin(), market.on_open.end(),
+                                                [owner](const auto &callback) { return callback.first == owner; }),
+                                 market.on_open.end());
+          }
+        }
+        {
+          // Streams nobody else wants are unsubscribed on the exchange
+          std::lock_guard<std::mutex> lock(refs_mutex_);
+          for (auto ref = refs_.begin(); ref != refs_.end();)
+          {
+            if (ref->second.owners.erase(owner) && ref->second.owners.empty())
+            {
+              close_stream(ref->second.stream, ref->second.symbol);
+              release_market(ref->second.market);
+              ref = refs_.erase(ref);
+            }
+            else
+            {
+              ++ref;
+            }
+          }
+        }
+
+        std::lock_guard<std::mutex> lock(owners_mutex_);
+        conflators_[owner].reset();
+        if (--attached_count_ != 0)
+        {
+          return;
+        }
+        closed_ = true;
+        for (size_t market = 0; market < MARKETS; ++market)
+        {
+          pools_[market]->close();
+          health_.set_fault(health_component(static_cast<Market>(market)), true, "closed");
+        }
+        singular::utility::log_event(log_service_name, singular::utility::OEMSEvent::WS_CONNECTION_DEBUG, "Market data hub closed with its last gateway");
+      }
+
+      uint32_t MarketDataHub::health_component(Market market)
+      {
+        switch (market)
+        {
+        case SPOT:
+          return GatewayHealth::PUBLIC_SPOT;
+        case FUTURES_USDT:
+          return GatewayHealth::PUBLIC_FUTURES_USDT;
+        default:
+          return GatewayHealth::PUBLIC_FUTURES_BTC;
+        }
+      }
+
+      void MarketDataHub::run(size_t owner, Market market, std::function<void()> on_open)
+      {
+        bool open = false;
+        bool start_pool = false;
+        {
+          std::lock_guard<std::mutex> lock(markets_mutex_);
+          MarketState &state = markets_[market];
+          open = state.open;
+          if (!open && on_open)
+          {
+            state.on_open.emplace_back(owner, std::move(on_open));
+          }
+          start_pool = !state.started;
+          state.started = true;
+          state.starts += start_pool ? 1 : 0;
+        }
+        if (start_pool)
+        {
+          start(market);
+        }
+        // A later gateway finds the market already streaming
+        if (open && on_open)
+        {
+          on_open();
+        }
+      }
+
+      void MarketDataHub::bind(Market market)
+      {
+        PublicConnectionPool *pool = pools_[market].get();
+        const uint32_t component = health_component(market);
+        auto &arbiters = public_arbiters_[pool];
+        pool->set_callbacks(
+            [this, pool, market, &arbiters, component](size_t index)
+            {
+              if (!arbiters.empty())
+              {
+                arbiters[pool->slot_of(index)]->set_line_open(pool->line_of(index), true);
+              }
+              if (pool->open_connections() == pool->size())
+              {
+                health_.set_fault(component, false, "all sockets open");
+              }
+              std::vector<std::pair<size_t, std::function<void()>>> ready;
+              {
+                std::lock_guard<std::mutex> lock(markets_mutex_);
+                markets_[market].open = true;
+                ready.swap(markets_[market].on_open);
+              }
+              for (auto &callback : ready)
+              {
+                callback.second();
+              }
+            },
+            [this, pool, &arbiters, component](size_t index)
+            {
+              if (!arbiters.empty())
+              {
+                arbiters[pool->slot_of(index)]->set_line_open(pool->line_of(index), false);
+              }
+              // Symbols placed on the closed socket have no data until it is back
+              health_.set_fault(component, true, pool->name() + "#" + std::to_string(index) + " closed");
+            },
+            [pool, &feeds = public_feeds_[pool], &clocks = public_clocks_[pool], &arbiters, capture = capture_.get(), capture_ids = capture_ids_[pool]](size_t index, const std::string &message)
+            {
+              if (capture)
+              {
+                capture->record(capture_ids[index], message);
+              }
+              PublicFeedHandler &feed = *feeds[pool->slot_of(index)];
+              if (arbiters.empty())
+              {
+                feed.on_message(message);
+                pool->record_message(index, feed.last_symbol());
+                return;
+              }
+              // The first line to deliver an update applies it to the shared book, later copies are dropped unparsed
+              bool applied = arbiters[pool->slot_of(index)]->offer(pool->line_of(index), message, [&]()
+                                                                   {
+                                                                     feed.set_clock(clocks[index].get());
+                                                                     feed.on_message(message);
+                                                                     pool->record_message(index, feed.last_symbol()); });
+              if (!applied)
+              {
+                pool->record_duplicate(index);
+              }
+            });
+      }
+
+      void MarketDataHub::start(Market market)
+      {
+        if (lazy_)
+        {
+          health_.set_watched(health_component(market), true, false, "connecting");
+        }
+        pools_[market]->run();
+      }
+
+      MarketDataHub::Market MarketDataHub::market_of(const SplitSymbol &split_symbol) const
+      {
+        if (split_symbol.second == "SPOT")
+        {
+          return SPOT;
+        }
+        if (split_symbol.second == "FUTURE")
+        {
+          // Settle currency comes from the instrument catalog; BTC_USD is the only inverse contract it may miss
+          std::string settle = InstrumentCatalog::instance().settle_of(split_symbol.first + "@FUTURE");
+          if (settle.empty())
+          {
+            settle = split_symbol.first == "BTC_USD" ? "btc" : "usdt";
+          }
+          return settle == "btc" ? FUTURES_BTC : FUTURES_USDT;
+        }
+        return MARKETS;
+      }
+
+      PublicConnectionPool *MarketDataHub::pool_for(const SplitSymbol &split_symbol)
+      {
+        const Market market = market_of(split_symbol);
+        return market == MARKETS ? nullptr : pools_[market].get();
+      }
+
+      SubscriptionManager *MarketDataHub::subscriptions_for(const SplitSymbol &split_symbol, bool place)
+      {
+        auto pool = pool_for(split_symbol);
+        if (!pool)
+        {
+          return nullptr;
+        }
+        std::string symbol = split_symbol.first + "@" + split_symbol.second;
+        return place ? pool->place(symbol) : pool->find(symbol);
+      }
+
+      const char *MarketDataHub::stream_name(Stream stream)
+      {
+        switch (stream)
+        {
+        case Stream::BOOK:
+          return "book";
+        case Stream::TICKER:
+          return "ticker";
+        case Stream::TRADES:
+          return "trades";
+        case Stream::FUNDING:
+          return "funding";
+        }
+        return "unknown";
+      }
+
+      void MarketDataHub::subscribe(size_t owner, Stream stream, const std::vector<SplitSymbol> &symbols)
+      {
+        if (stream == Stream::BOOK)
+        {
+          add_producers(owner);
+        }
+        std::lock_guard<std::mutex> lock(refs_mutex_);
+        for (const SplitSymbol &symbol : symbols)
+        {
+          Ref &ref = refs_[std::string(stream_name(stream)) + "|" + symbol.first + "@" + symbol.second];
+          ref.stream = stream;
+          ref.symbol = symbol;
+          if (ref.owners.insert(owner).second && ref.owners.size() == 1)
+          {
+            ref.market = market_of(symbol);
+            if (ref.market != MARKETS)
+            {
+              ++market_refs_[ref.market];
+              idle_since_ns_[ref.market] = 0;
+              // The market's sockets open with its first subscription
+              if (lazy_)
+              {
+                run(owner, ref.market, nullptr);
+              }
+            }
+            open_stream(stream, symbol);
+          }
+        }
+      }
+
+      void MarketDataHub::unsubscribe(size_t owner, Stream stream, const std::vector<SplitSymbol> &symbols)
+      {
+        std::lock_guard<std::mutex> lock(refs_mutex_);
+        for (const SplitSymbol &symbol : symbols)
+        {
+          auto ref = refs_.find(std::string(stream_name(stream)) + "|" + symbol.first + "@" + symbol.second);
+          if (ref == refs_.end() || !ref->second.owners.erase(owner) || !ref->second.owners.empty())
+          {
+            continue;
+          }
+          close_stream(stream, symbol);
+          release_market(ref->second.market);
+          refs_.erase(ref);
+        }
+      }
+
+      void MarketDataHub::release_market(Market market)
+      {
+        if (market != MARKETS && --market_refs_[market] == 0)
+        {
+          idle_since_ns_[market] = now_ns();
+        }
+      }
+
+      void MarketDataHub::reap_idle()
+      {
+        const int64_t now = now_ns();
+        // Held throughout, so a subscription cannot reopen the market while it is being closed
+        std::lock_guard<std::mutex> refs_lock(refs_mutex_);
+        for (size_t market = 0; market < MARKETS; ++market)
+        {
+          if (market_refs_[market] != 0 || idle_since_ns_[market] == 0 || now - idle_since_ns_[market] < idle_timeout_ns_)
+          {
+            continue;
+          }
+          idle_since_ns_[market] = 0;
+          {
+            std::lock_guard<std::mutex> lock(markets_mutex_);
+            MarketState &state = markets_[market];
+            if (!state.started || closed_)
+            {
+              continue;
+            }
+            state.started = false;
+            state.open = false;
+            ++state.idle_closes;
+          }
+          pools_[market]->close();
+          health_.set_watched(health_component(static_cast<Market>(market)), false, false, "idle");
+          singular::utility::log_event(log_service_name, singular::utility::OEMSEvent::WS_CONNECTION_DEBUG,
+                                       std::string("Closed idle ") + market_name(market) + " public sockets");
+        }
+      }
+
+      void MarketDataHub::open_stream(Stream stream, const SplitSymbol &split_symbol)
+      {
+        const bool spot = split_symbol.second == "SPOT";
+        if (stream == Stream::FUNDING && spot)
+        {
+          return;
+        }
+        auto subscriptions = subscriptions_for(split_symbol, true);
+        if (!subscriptions)
+        {
+          return;
+        }
+        switch (stream)
+        {
+        case Stream::BOOK:
+        {
+          std::string symbol = split_symbol.first + "@" + split_symbol.second;
+          BookProfile profile = book_profiles_.resolve(symbol);
+          subscriptions->subscribe(profile.channel(split_symbol.second), split_symbol.first, profile.payload(split_symbol.first, split_symbol.second));
+          std::lock_guard<std::mutex> lock(book_profiles_mutex_);
+          active_book_profiles_[symbol] = profile;
+          break;
+        }
+        case Stream::TICKER:
+          // Both ticker channels take a symbol list, so these are grouped into multi-symbol frames
+          if (spot || retain_futures_ticker(split_symbol.first, TICKER_USER_TICKERS, true))
+          {
+            subscriptions->subscribe(spot ? "spot.tickers" : "futures.tickers", split_symbol.first);
+          }
+          subscriptions->subscribe(spot ? "spot.book_ticker" : "futures.book_ticker", split_symbol.first);
+          break;
+        case Stream::TRADES:
+          subscriptions->subscribe(spot ? "spot.trades" : "futures.trades", split_symbol.first);
+          break;
+        case Stream::FUNDING:
+          // Funding rate, mark/index price and open interest all ride on futures.tickers
+          if (retain_futures_ticker(split_symbol.first, TICKER_USER_FUNDING, true))
+          {
+            subscriptions->subscribe("futures.tickers", split_symbol.first);
+          }
+          break;
+        }
+      }
+
+      void MarketDataHub::close_stream(Stream stream, const SplitSymbol &split_symbol)
+      {
+        const bool spot = split_symbol.second == "SPOT";
+        if (stream == Stream::FUNDING && spot)
+        {
+          return;
+        }
+        auto subscriptions = subscriptions_for(split_symbol, false);
+        if (!subscriptions)
+        {
+          return;
+        }
+        switch (stream)
+        {
+        case Stream::BOOK:
+        {
+          // Unsubscribe with the profile that was subscribed, which may differ from the current one
+          std::string symbol = split_symbol.first + "@" + split_symbol.second;
+          BookProfile profile;
+          BookProfile resync;
+          bool resyncing = false;
+          {
+            std::lock_guard<std::mutex> lock(book_profiles_mutex_);
+            auto active = active_book_profiles_.find(symbol);
+            if (active == active_book_profiles_.end())
+            {
+              return;
+            }
+            profile = active->second;
+            active_book_profiles_.erase(active);
+            auto seeding = resync_snapshots_.find(symbol);
+            if (seeding != resync_snapshots_.end())
+            {
+              resyncing = seeding->second != profile;
+              resync = seeding->second;
+              resync_snapshots_.erase(seeding);
+            }
+          }
+          subscriptions->unsubscribe(profile.channel(split_symbol.second), split_symbol.first, profile.payload(split_symbol.first, split_symbol.second));
+          if (resyncing)
+          {
+            subscriptions->unsubscribe(resync.channel(split_symbol.second), split_symbol.first, resync.payload(split_symbol.first, split_symbol.second));
+          }
+          break;
+        }
+        case Stream::TICKER:
+          if (spot || retain_futures_ticker(split_symbol.first, TICKER_USER_TICKERS, false))
+          {
+            subscriptions->unsubscribe(spot ? "spot.tickers" : "futures.tickers", split_symbol.first);
+          }
+          subscriptions->unsubscribe(spot ? "spot.book_ticker" : "futures.book_ticker", split_symbol.first);
+          break;
+        case Stream::TRADES:
+          subscriptions->unsubscribe(spot ? "spot.trades" : "futures.trades", split_symbol.first);
+          break;
+        case Stream::FUNDING:
+          if (retain_futures_ticker(split_symbol.first, TICKER_USER_FUNDING, false))
+          {
+            subscriptions->unsubscribe("futures.tickers", split_symbol.first);
+          }
+          break;
+        }
+      }
+
+      bool MarketDataHub::retain_futures_ticker(const std::string &contract, unsigned user, bool retain)
+      {
+        // futures.tickers serves both the ticker and the funding streams;
+        // returns true when the channel itself has to be subscribed or unsubscribed
+        unsigned &users = futures_ticker_users_[contract];
+        const bool was_used = users != 0;
+        users = retain ? (users | user) : (users & ~user);
+        const bool used = users != 0;
+        if (!used)
+        {
+          futures_ticker_users_.erase(contract);
+        }
+        return was_used != used;
+      }
+
+      void MarketDataHub::resync_book(const std::string &symbol, bool needed)
+      {
+        size_t at = symbol.find('@');
+        if (at == std::string::npos)
+        {
+          return;
+        }
+        SplitSymbol split_symbol(symbol.substr(0, at), symbol.substr(at + 1));
+        auto subscriptions = subscriptions_for(split_symbol, false);
+        if (!subscriptions)
+        {
+          return;
+        }
+        BookProfile profile;
+        {
+          std::lock_guard<std::mutex> lock(book_profiles_mutex_);
+          auto active = active_book_profiles_.find(symbol);
+          if (!needed)
+          {
+            // Seeded: the temporary snapshot stream goes, unless it has become the symbol's profile
+            auto seeding = resync_snapshots_.find(symbol);
+            if (seeding == resync_snapshots_.end())
+            {
+              return;
+            }
+            profile = seeding->second;
+            resync_snapshots_.erase(seeding);
+            if (active != active_book_profiles_.end() && active->second == profile)
+            {
+              return;
+            }
+          }
+          else
+          {
+            if (active == active_book_profiles_.end() || active->second.kind == BookProfile::Kind::SNAPSHOT ||
+                resync_snapshots_.count(symbol))
+            {
+              return; // not subscribed, every push is a full book, or a snapshot is already on its way
+            }
+            profile = active->second;
+            if (profile.kind == BookProfile::Kind::DELTA)
+            {
+              BookProfile snapshot;
+              snapshot.kind = BookProfile::Kind::SNAPSHOT;
+              snapshot.depth = profile.depth;
+              profile = snapshot.normalized(split_symbol.second);
+              resync_snapshots_[symbol] = profile;
+            }
+          }
+        }
+        const std::string channel = profile.channel(split_symbol.second);
+        const nlohmann::json payload = profile.payload(split_symbol.first, split_symbol.second);
+        if (!needed)
+        {
+          subscriptions->unsubscribe(channel, split_symbol.first, payload);
+        }
+        else if (profile.kind == BookProfile::Kind::OBU)
+        {
+          subscriptions->unsubscribe(channel, split_symbol.first, payload);
+          subscriptions->subscribe(channel, split_symbol.first, payload);
+        }
+        else
+        {
+          subscriptions->subscribe(channel, split_symbol.first, payload);
+        }
+      }
+
+      bool MarketDataHub::set_book_profile(const std::string &symbol, const std::string &profile_text)
+      {
+        size_t at = symbol.find('@');
+        if (at == std::string::npos)
+        {
+          return false;
+        }
+        if (profile_text.empty())
+        {
+          book_profiles_.reset(symbol);
+        }
+        else
+        {
+          BookProfile requested;
+          if (!BookProfile::parse(profile_text, requested))
+          {
+            singular::utility::log_event(log_service_name, singular::utility::OEMSEvent::WS_CONNECTION_ERROR, "Invalid book profile " + profile_text + " for " + symbol);
+            return false;
+          }
+          book_profiles_.set(symbol, requested);
+        }
+
+        SplitSymbol split_symbol(symbol.substr(0, at), symbol.substr(at + 1));
+        BookProfile next = book_profiles_.resolve(symbol);
+        BookProfile previous;
+        {
+          std::lock_guard<std::mutex> lock(book_profiles_mutex_);
+          auto active = active_book_profiles_.find(symbol);
+          if (active == active_book_profiles_.end() || active->second == next)
+          {
+            return true; // applied on the next subscribe
+          }
+          previous = active->second;
+          active->second = next;
+        }
+
+        auto subscriptions = subscriptions_for(split_symbol, false);
+        if (!subscriptions)
+        {
+          return true;
+        }
+        // Make before break: both streams feed the same local book and duplicates are skipped by update id
+        subscriptions->subscribe(next.channel(split_symbol.second), split_symbol.first, next.payload(split_symbol.first, split_symbol.second));
+        subscriptions->unsubscribe(previous.channel(split_symbol.second), split_symbol.first, previous.payload(split_symbol.first, split_symbol.second));
+        singular::utility::log_event(log_service_name, singular::utility::OEMSEvent::ORDERBOOK_SUBSCRIBE_SUCCESS, "Switched " + symbol + " book profile from " + previous.to_string() + " to " + next.to_string());
+        return true;
+      }
+
+      void MarketDataHub::set_funding_callback(size_t owner, FundingTable::ChangeCallback callback)
+      {
+        std::lock_guard<std::mutex> lock(funding_callbacks_mutex_);
+        funding_callbacks_.erase(std::remove_if(funding_callbacks_.begin(), funding_callbacks_.end(),
+                                                [owner](const auto &entry) { return entry.first == owner; }),
+                                 funding_callbacks_.end());
+        if (callback)
+        {
+          funding_callbacks_.emplace_back(owner, std::move(callback));
+        }
+      }
+
+      void MarketDataHub::dispatch_frame(const std::string &connection, const std::string &frame)
+      {
+        // Public connections are named "<pool>#<index>" and take the live path: the slot's
+        // decoder, behind its arbiter when the pool runs A/B lines
+        size_t separator = connection.rfind('#');
+        std::string pool_name = connection.substr(0, separator);
+        size_t index = separator == std::string::npos ? 0 : std::strtoul(connection.c_str() + separator + 1, nullptr, 10);
+        for (auto &pool : pools_)
+        {
+          if (pool->name() != pool_name || index >= pool->size())
+          {
+            continue;
+          }
+          PublicFeedHandler &feed = *public_feeds_.at(pool.get())[pool->slot_of(index)];
+          auto &arbiters = public_arbiters_.at(pool.get());
+          if (arbiters.empty())
+          {
+            feed.on_message(frame);
+            return;
+          }
+          arbiters[pool->slot_of(index)]->offer(pool->line_of(index), frame, [&]()
+                                                { feed.on_message(frame); });
+          return;
+        }
+      }
+
+      nlohmann::json MarketDataHub::get_book_stats() const
+      {
+        nlohmann::json stats = nlohmann::json::array();
+        for (const auto &entry : public_feeds_)
+        {
+          for (const auto &feed : entry.second)
+          {
+            for (auto &book : feed->get_book_stats())
+            {
+              stats.push_back(book);
+            }
+          }
+        }
+        return stats;
+      }
+
+      nlohmann::json MarketDataHub::get_book_profiles()
+      {
+        nlohmann::json stats = book_profiles_.get_stats();
+        stats["active"] = nlohmann::json::object();
+        std::lock_guard<std::mutex> lock(book_profiles_mutex_);
+        for (const auto &entry : active_book_profiles_)
+        {
+          stats["active"][entry.first] = entry.second.to_string();
+        }
+        stats["resyncing"] = nlohmann::json::object();
+        for (const auto &entry : resync_snapshots_)
+        {
+          stats["resyncing"][entry.first] = entry.second.to_string();
+        }
+        return stats;
+      }
+
+      nlohmann::json MarketDataHub::get_public_connection_stats() const
+      {
+        return {{"spot", pools_[SPOT]->get_stats()},
+                {"futures_usdt", pools_[FUTURES_USDT]->get_stats()},
+                {"futures_btc", pools_[FUTURES_BTC]->get_stats()}};
+      }
+
+      nlohmann::json MarketDataHub::get_feed_arbitration_stats() const
+      {
+        nlohmann::json stats = nlohmann::json::array();
+        for (const auto &pool : pools_)
+        {
+          for (const auto &arbiter : public_arbiters_.at(pool.get()))
+          {
+            stats.push_back(arbiter->get_stats());
+          }
+        }
+        return stats;
+      }
+
+      nlohmann::json MarketDataHub::get_clock_stats() const
+      {
+        nlohmann::json stats = nlohmann::json::array();
+        for (const auto &pool : pools_)
+        {
+          for (const auto &clock : public_clocks_.at(pool.get()))
+          {
+            stats.push_back(clock->get_stats());
+          }
+        }
+        return stats;
+      }
+
+      nlohmann::json MarketDataHub::get_heartbeat_stats() const
+      {
+        nlohmann::json stats = nlohmann::json::array();
+        for (const auto &pool : pools_)
+        {
+          for (auto &heartbeat : pool->get_heartbeat_stats())
+          {
+            stats.push_back(heartbeat);
+          }
+        }
+        return stats;
+      }
+
+      nlohmann::json MarketDataHub::get_reconnect_stats() const
+      {
+        nlohmann::json stats = nlohmann::json::array();
+        for (const auto &pool : pools_)
+        {
+          for (auto &reconnect : pool->get_reconnect_stats())
+          {
+            stats.push_back(reconnect);
+          }
+        }
+        return stats;
+      }
+
+      nlohmann::json MarketDataHub::get_send_stats() const
+      {
+        nlohmann::json stats = nlohmann::json::array();
+        for (const auto &pool : pools_)
+        {
+          for (auto &sender : pool->get_send_stats())
+          {
+            stats.push_back(sender);
+          }
+        }
+        return stats;
+      }
+
+      nlohmann::json MarketDataHub::get_transport_stats() const
+      {
+        nlohmann::json stats = nlohmann::json::array();
+        for (const auto &pool : pools_)
+        {
+          for (auto &client : pool->get_transport_stats())
+          {
+            stats.push_back(client);
+          }
+        }
+        return stats;
+      }
+
+      nlohmann::json MarketDataHub::get_capture_stats() const
+      {
+        return capture_ ? capture_->get_stats() : nlohmann::json{{"enabled", false}};
+      }
+
+      nlohmann::json MarketDataHub::get_stats()
+      {
+        nlohmann::json stats;
+        {
+          std::lock_guard<std::mutex> lock(owners_mutex_);
+          stats["owners"] = attached_count_;
+          stats["owner_ids"] = conflators_.size();
+          stats["closed"] = closed_.load();
+        }
+        std::lock_guard<std::mutex> lock(refs_mutex_);
+        stats["streams"] = nlohmann::json::object();
+        for (Stream stream : {Stream::BOOK, Stream::TICKER, Stream::TRADES, Stream::FUNDING})
+        {
+          stats["streams"][stream_name(stream)] = {{"symbols", 0}, {"shared", 0}, {"references", 0}};
+        }
+        for (const auto &entry : refs_)
+        {
+          // One exchange subscription serves every owner of the symbol
+          nlohmann::json &stream = stats["streams"][stream_name(entry.second.stream)];
+          stream["symbols"] = stream["symbols"].get<size_t>() + 1;
+          stream["references"] = stream["references"].get<size_t>() + entry.second.owners.size();
+          if (entry.second.owners.size() > 1)
+          {
+            stream["shared"] = stream["shared"].get<size_t>() + 1;
+          }
+        }
+        stats["lazy"] = lazy_;
+        stats["markets"] = nlohmann::json::object();
+        std::lock_guard<std::mutex> markets_lock(markets_mutex_);
+        for (size_t market = 0; market < MARKETS; ++market)
+        {
+          const MarketState &state = markets_[market];
+          stats["markets"][market_name(market)] = {{"started", state.started},
+                                                   {"open", state.open},
+                                                   {"streams", market_refs_[market]},
+                                                   {"starts", state.starts},
+                                                   {"idle_closes", state.idle_closes}};
+        }
+        return stats;
+      }
+
+    } // namespace gateio
+  } // namespace gateway
+} // namespace singular
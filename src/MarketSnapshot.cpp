@@ -0,0 +1,211 @@
+#include <algorithm>
+#include <vector>
+
+#include "gateio/include/MarketSnapshot.h"
+#include "gateio/include/Tsc.h"
+
+namespace singular
+{
+  namespace gateway
+  {
+    namespace gateio
+    {
+
+      MarketSnapshotTable::MarketSnapshotTable(const Options &options)
+          : options_(options)
+      {
+      }
+
+      MarketSnapshotTable::Entry *MarketSnapshotTable::entry(const std::string &symbol)
+      {
+        std::lock_guard<std::mutex> lock(entries_mutex_);
+        auto &entry = entries_[symbol];
+        if (!entry)
+        {
+          entry = std::make_unique<Entry>();
+          if (basis_)
+          {
+            entry->basis_ = basis_->link(symbol, entry->basis_spot_leg_);
+          }
+        }
+        return entry.get();
+      }
+
+      const MarketSnapshotTable::Entry *MarketSnapshotTable::find(const std::string &symbol) const
+      {
+        std::lock_guard<std::mutex> lock(entries_mutex_);
+        auto it = entries_.find(symbol);
+        return it == entries_.end() ? nullptr : it->second.get();
+      }
+
+      bool MarketSnapshotTable::read(const std::string &symbol, MarketSnapshot &out) const
+      {
+        const Entry *entry = find(symbol);
+        if (!entry || entry->version() == 0)
+        {
+          return false;
+        }
+        out = entry->read();
+        return true;
+      }
+
+      void MarketSnapshotTable::on_book(Entry &entry, const BookState &state)
+      {
+        const uint64_t start = read_tsc();
+
+        // A gap clears the book and publishes it empty and invalid: that still has to reach readers,
+        // with the top of book zeroed rather than the last quotes left looking live
+        const bool has_top = !state.bids.empty() && !state.asks.empty();
+        const BookLevel empty_level{};
+        const BookLevel &bid = has_top ? state.bids.front() : empty_level;
+        const BookLevel &ask = has_top ? state.asks.front() : empty_level;
+
+        // Everything derived from the book is computed before taking the write side
+        double bid_volume = 0.0;
+        double ask_volume = 0.0;
+        const size_t depth = std::max<size_t>(options_.imbalance_depth, 1);
+        for (size_t i = 0; has_top && i < depth && i < state.bids.size(); ++i)
+        {
+          bid_volume += state.bids[i].quantity;
+        }
+        for (size_t i = 0; has_top && i < depth && i < state.asks.size(); ++i)
+        {
+          ask_volume += state.asks[i].quantity;
+        }
+        const double mid = (bid.price + ask.price) / 2.0;
+        const double top_volume = bid.quantity + ask.quantity;
+        const double microprice = top_volume > 0.0 ? (bid.price * ask.quantity + ask.price * bid.quantity) / top_volume : mid;
+        const double imbalance = bid_volume + ask_volume > 0.0 ? (bid_volume - ask_volume) / (bid_volume + ask_volume) : 0.0;
+        const bool live = has_top && state.valid;
+
+        bool top_changed = false;
+        entry.snapshot_.write([&](MarketSnapshot &snapshot)
+                              {
+                                top_changed = snapshot.bid_price != bid.price || snapshot.ask_price != ask.price ||
+                                              snapshot.bid_quantity != bid.quantity || snapshot.ask_quantity != ask.quantity ||
+                                              snapshot.book_valid != state.valid || snapshot.has_top != has_top;
+                                snapshot.bid_price = bid.price;
+                                snapshot.bid_quantity = bid.quantity;
+                                snapshot.ask_price = ask.price;
+                                snapshot.ask_quantity = ask.quantity;
+                                snapshot.has_top = has_top;
+                                snapshot.update_id = state.last_update_id;
+                                snapshot.exchange_time_ms = state.exchange_time_ms;
+                                snapshot.receive_time_ns = state.receive_time_ns;
+                                snapshot.latency_ns = state.latency_ns;
+                                snapshot.stale = options_.stale_latency_ns > 0 && state.latency_ns > options_.stale_latency_ns;
+                                snapshot.book_valid = state.valid;
+                                snapshot.mid = mid;
+                                snapshot.spread = ask.price - bid.price;
+                                snapshot.spread_bps = mid > 0.0 ? snapshot.spread / mid * 1e4 : 0.0;
+                                snapshot.microprice = microprice;
+                                snapshot.imbalance = imbalance;
+                                entry.book_cost_.record(read_tsc() - start);
+                              });
+
+        if (top_changed && entry.basis_)
+        {
+          basis_->on_leg(*entry.basis_, entry.basis_spot_leg_, live, bid.price, ask.price, state.exchange_time_ms, state.receive_time_ns);
+        }
+      }
+
+      void MarketSnapshotTable::on_trade(Entry &entry, double price, double quantity, int64_t time_ms)
+      {
+        const uint64_t start = read_tsc();
+        quantity = quantity < 0.0 ? -quantity : quantity; // futures sizes carry the side
+        entry.snapshot_.write([&](MarketSnapshot &snapshot)
+                              {
+                                entry.trades_.push_back({time_ms, price, quantity});
+                                entry.window_notional_ += price * quantity;
+                                entry.window_volume_ += quantity;
+                                const int64_t horizon = time_ms - options_.vwap_window_ms;
+                                while (!entry.trades_.empty() && entry.trades_.front().time_ms < horizon)
+                                {
+                                  const auto &old = entry.trades_.front();
+                                  entry.window_notional_ -= old.price * old.quantity;
+                                  entry.window_volume_ -= old.quantity;
+                                  entry.trades_.pop_front();
+                                }
+                                if (entry.trades_.empty())
+                                {
+                                  entry.window_notional_ = 0.0; // drop accumulated rounding
+                                  entry.window_volume_ = 0.0;
+                                }
+
+                                snapshot.vwap = entry.window_volume_ > 0.0 ? entry.window_notional_ / entry.window_volume_ : price;
+                                snapshot.vwap_volume = entry.window_volume_;
+                                snapshot.window_trades = static_cast<uint32_t>(entry.trades_.size());
+                                snapshot.last_trade_price = price;
+                                snapshot.last_trade_time_ms = time_ms;
+                                entry.trade_cost_.record(read_tsc() - start);
+                              });
+      }
+
+      nlohmann::json MarketSnapshotTable::get_stats() const
+      {
+        std::vector<std::pair<std::string, Entry *>> entries;
+        {
+          std::lock_guard<std::mutex> lock(entries_mutex_);
+          for (const auto &entry : entries_)
+          {
+            entries.emplace_back(entry.first, entry.second.get());
+          }
+        }
+
+        // Costs are kept in TSC ticks on the hot path and converted here
+        const double ticks_per_ns = tsc_ticks_per_ns();
+        auto cost_json = [ticks_per_ns](const LatencyHistogram &cost)
+        {
+          return nlohmann::json{{"count", cost.count()},
+                                {"mean_ns", cost.mean() / ticks_per_ns},
+                                {"p50_ns", cost.percentile(0.50) / ticks_per_ns},
+                                {"p99_ns", cost.percentile(0.99) / ticks_per_ns},
+                                {"max_ns", cost.percentile(1.0) / ticks_per_ns}};
+        };
+
+        nlohmann::json stats;
+        stats["imbalance_depth"] = options_.imbalance_depth;
+        stats["vwap_window_ms"] = options_.vwap_window_ms;
+        stats["stale_latency_ms"] = options_.stale_latency_ns / 1000000;
+        stats["symbols"] = nlohmann::json::array();
+        LatencyHistogram book_cost;
+        LatencyHistogram trade_cost;
+        size_t stale = 0;
+        size_t invalid = 0;
+        for (auto &item : entries)
+        {
+          Entry &entry = *item.second;
+          MarketSnapshot snapshot;
+          // Briefly takes the write side to copy the writer-owned cost histograms
+          entry.snapshot_.inspect([&](const MarketSnapshot &current)
+                                {
+                                  snapshot = current;
+                                  book_cost.merge(entry.book_cost_);
+                                  trade_cost.merge(entry.trade_cost_);
+                                });
+          stats["symbols"].push_back({{"symbol", item.first},
+                                      {"version", entry.version()},
+                                      {"bid", snapshot.bid_price},
+                                      {"ask", snapshot.ask_price},
+                                      {"spread_bps", snapshot.spread_bps},
+                                      {"microprice", snapshot.microprice},
+                                      {"imbalance", snapshot.imbalance},
+                                      {"vwap", snapshot.vwap},
+                                      {"window_trades", snapshot.window_trades},
+                                      {"latency_ms", snapshot.latency_ns / 1e6},
+                                      {"stale", snapshot.stale},
+                                      {"book_valid", snapshot.book_valid},
+                                      {"has_top", snapshot.has_top}});
+          stale += snapshot.stale ? 1 : 0;
+          invalid += snapshot.book_valid ? 0 : 1;
+        }
+        stats["stale_symbols"] = stale;
+        stats["invalid_books"] = invalid;
+        stats["book_update_cost"] = cost_json(book_cost);
+        stats["trade_update_cost"] = cost_json(trade_cost);
+        return stats;
+      }
+
+    } // namespace gateio
+  } // namespace gateway
+} // namespace singular
@@ -0,0 +1,40 @@
+#include "gateio/include/OrderRoute.h"
+
+namespace singular
+{
+  namespace gateway
+  {
+    namespace gateio
+    {
+
+      const OrderRoute &OrderRouteTable::resolve(const std::string &symbol, singular::types::InstrumentType type)
+      {
+        auto found = routes_.find(symbol);
+        if (found != routes_.end() && found->second->type == type)
+        {
+          return *found->second;
+        }
+
+        auto route = std::make_unique<OrderRoute>();
+        route->type = type;
+        route->spot = type == singular::types::InstrumentType::SPOT;
+        route->perpetual = type == singular::types::InstrumentType::LINEAR_PERPETUAL || type == singular::types::InstrumentType::INVERSE_PERPETUAL;
+        route->contract = symbol.substr(0, symbol.find('@')); // Symbol is BTC_USDT@SPOT or BTC_USD@FUTURE
+        route->place_channel = route->spot ? "spot.order_place" : "futures.order_place";
+        route->cancel_channel = route->spot ? "spot.order_cancel" : "futures.order_cancel";
+        route->symbol_key = route->spot ? "currency_pair" : "contract";
+        route->sender = route->spot ? spot_sender_ : futures_sender_;
+
+        // A symbol re-resolved with another type keeps its old route alive for orders still open on it
+        if (found != routes_.end())
+        {
+          retired_.push_back(std::move(found->second));
+          found->second = std::move(route);
+          return *found->second;
+        }
+        return *routes_.emplace(symbol, std::move(route)).first->second;
+      }
+
+    } // namespace gateio
+  } // namespace gateway
+} // namespace singular
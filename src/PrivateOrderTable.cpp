@@ -0,0 +1,171 @@
+#include <chrono>
+#include <cstdlib>
+
+#include "gateio/include/PrivateOrderTable.h"
+
+namespace singular
+{
+  namespace gateway
+  {
+    namespace gateio
+    {
+
+      namespace
+      {
+        int64_t now_ns()
+        {
+          return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                     std::chrono::steady_clock::now().time_since_epoch())
+              .count();
+        }
+
+        const char TEXT_PREFIX[] = "t-Z-";
+      }
+
+      uint64_t PrivateOrderTable::parse_text(const std::string &text)
+      {
+        if (text.compare(0, sizeof(TEXT_PREFIX) - 1, TEXT_PREFIX) != 0)
+        {
+          return 0;
+        }
+        return std::strtoull(text.c_str() + sizeof(TEXT_PREFIX) - 1, nullptr, 10);
+      }
+
+      void PrivateOrderTable::reap()
+      {
+        if (finished_ == 0)
+        {
+          return;
+        }
+        auto it = orders_.find(finished_);
+        if (it != orders_.end())
+        {
+          exchange_ids_.erase(it->second.exchange_id);
+          orders_.erase(it);
+        }
+        finished_ = 0;
+      }
+
+      void PrivateOrderTable::record_exchange_id(uint64_t client_id, Entry &entry, const std::string &exchange_id)
+      {
+        if (entry.exchange_id.empty() && !exchange_id.empty())
+        {
+          entry.exchange_id = exchange_id;
+          exchange_ids_[exchange_id] = client_id;
+        }
+      }
+
+      void PrivateOrderTable::on_sent(uint64_t client_id, size_t session)
+      {
+        reap();
+        auto inserted = orders_.try_emplace(client_id);
+        Entry &entry = inserted.first->second;
+        if (!inserted.second)
+        {
+          // Client id reused while its previous order was still open
+          --open_[entry.session];
+          exchange_ids_.erase(entry.exchange_id);
+          entry = Entry{};
+        }
+        entry.sent_ns = now_ns();
+        entry.session = session;
+        ++open_[session];
+      }
+
+      PrivateOrderTable::Entry *PrivateOrderTable::on_ack(uint64_t client_id, const std::string &exchange_id)
+      {
+        reap();
+        auto it = orders_.find(client_id);
+        if (it == orders_.end())
+        {
+          return nullptr;
+        }
+        Entry &entry = it->second;
+        ++acks_;
+        entry.acked = true;
+        entry.acked_ns = now_ns();
+        record_exchange_id(client_id, entry, exchange_id);
+        return &entry;
+      }
+
+      void PrivateOrderTable::on_reject(uint64_t client_id)
+      {
+        reap();
+        auto it = orders_.find(client_id);
+        if (it == orders_.end())
+        {
+          return;
+        }
+        ++rejects_;
+        --open_[it->second.session];
+        exchange_ids_.erase(it->second.exchange_id);
+        orders_.erase(it);
+      }
+
+      PrivateOrderTable::Entry *PrivateOrderTable::on_push(uint64_t client_id, const std::string &exchange_id, const std::string &state,
+                                                           double filled, bool finished)
+      {
+        reap();
+        ++pushes_;
+        auto it = orders_.find(client_id);
+        if (it == orders_.end())
+        {
+          ++unknown_pushes_;
+          return nullptr;
+        }
+        Entry &entry = it->second;
+        const int64_t now = now_ns();
+        if (entry.pushed_ns == 0)
+        {
+          entry.pushed_ns = now;
+          if (!entry.acked)
+          {
+            ++pushes_before_ack_;
+          }
+          else
+          {
+            ack_to_push_ns_total_ += static_cast<uint64_t>(now - entry.acked_ns);
+            ++ack_to_push_samples_;
+          }
+        }
+        record_exchange_id(client_id, entry, exchange_id);
+        entry.state = state;
+        entry.filled = filled;
+        if (finished)
+        {
+          // No longer open; the entry itself stays for the caller until the next call
+          --open_[entry.session];
+          finished_ = client_id;
+        }
+        return &entry;
+      }
+
+      uint64_t PrivateOrderTable::client_id(const std::string &exchange_id) const
+      {
+        auto it = exchange_ids_.find(exchange_id);
+        return it == exchange_ids_.end() ? 0 : it->second;
+      }
+
+      PrivateOrderTable::Entry *PrivateOrderTable::find(uint64_t client_id)
+      {
+        auto it = orders_.find(client_id);
+        return it == orders_.end() ? nullptr : &it->second;
+      }
+
+      nlohmann::json PrivateOrderTable::get_stats() const
+      {
+        nlohmann::json stats;
+        stats["open"] = orders_.size();
+        stats["open_per_session"] = open_;
+        stats["acks"] = acks_;
+        stats["pushes"] = pushes_;
+        stats["pushes_before_ack"] = pushes_before_ack_;
+        stats["unknown_pushes"] = unknown_pushes_;
+        stats["rejects"] = rejects_;
+        stats["mean_ack_to_push_ns"] = ack_to_push_samples_ ? ack_to_push_ns_total_ / ack_to_push_samples_ : 0;
+        return stats;
+      }
+
+    } // namespace gateio
+  } // namespace gateway
+} // namespace singular
@@ -0,0 +1,453 @@
+#include <chrono>
+#include <cmath>
+
+#include "gateio/include/PublicConnectionPool.h"
+#include "gateio/include/FeedLoop.h"
+#include <singular/utility/include/LatencyLogger.h>
+
+namespace singular
+{
+  namespace gateway
+  {
+    namespace gateio
+    {
+
+      namespace
+      {
+        int64_t now_ns()
+        {
+          return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                     std::chrono::steady_clock::now().time_since_epoch())
+              .count();
+        }
+
+        // Weight of the latest window in the per-symbol rate estimate
+        constexpr double RATE_SMOOTHING = 0.5;
+      }
+
+      PublicConnectionPool::PublicConnectionPool(const std::string &name, const std::vector<hv::EventLoopPtr> &loops, const char *url, const Options &options)
+          : name_(name),
+            loop_(loops.front()),
+            options_(options),
+            lines_(std::max<size_t>(options.lines, 1))
+      {
+        size_t slots = std::max<size_t>(options_.connections, 1);
+        for (size_t i = 0; i < slots * lines_; ++i)
+        {
+          auto connection = std::make_unique<Connection>();
+          Connection *raw = connection.get();
+          raw->index = i;
+          raw->line = i / slots;
+          hv::EventLoopPtr loop = loops[i % loops.size()];
+          raw->loop = loop;
+          raw->client = WsClient::create(loop, url, name_ + "#" + std::to_string(i), options_.ping_channel);
+          raw->sender = std::make_unique<SendQueue>(
+              loop, name_ + "#" + std::to_string(i), [raw](const std::string &frame) { raw->client->send(frame); }, options_.send);
+          raw->subscriptions = std::make_unique<SubscriptionManager>(
+              loop, [raw](const std::string &frame) { raw->sender->send(frame); },
+              options_.subscribe_rate, options_.subscribe_batch);
+          raw->heartbeat = std::make_unique<Heartbeat>(
+              loop, name_ + "#" + std::to_string(i), options_.ping_channel.c_str(),
+              [raw](const std::string &frame) { raw->client->send(frame); }, options_.heartbeat);
+          // A stale socket is closed before it can hide a dead feed; the close path takes it from there
+          raw->heartbeat->set_stale_callback([this, raw](const std::string &reason)
+                                             {
+                                               ++stale_closes_;
+                                               raw->client->drop(); });
+          raw->reconnect = std::make_unique<Reconnector>(
+              loop, name_ + "#" + std::to_string(i), [this, raw]() { connect(*raw); }, options_.reconnect);
+          connections_.push_back(std::move(connection));
+        }
+        // Line l of a slot forwards every subscription change to line l + 1
+        for (size_t i = slots; i < connections_.size(); ++i)
+        {
+          connections_[i - slots]->subscriptions->set_mirror(connections_[i]->subscriptions.get());
+        }
+        last_sample_ns_ = now_ns();
+      }
+
+      PublicConnectionPool::~PublicConnectionPool()
+      {
+        run_in_loop_and_wait(loop_, [this]()
+                             {
+                               if (rebalance_timer_ != INVALID_TIMER_ID)
+                               {
+                                 loop_->killTimer(rebalance_timer_);
+                                 rebalance_timer_ = INVALID_TIMER_ID;
+                               } });
+        // Each connection is taken apart on its own loop, users of the socket before the socket,
+        // so none of its callbacks or timers runs meanwhile. The Connection itself stays for
+        // callbacks of sockets on other loops that still count open connections.
+        for (auto &connection : connections_)
+        {
+          Connection *raw = connection.get();
+          run_in_loop_and_wait(raw->loop, [raw]()
+                               {
+                                 raw->reconnect.reset();
+                                 raw->heartbeat.reset();
+                                 raw->subscriptions.reset();
+                                 raw->sender.reset();
+                                 raw->client.reset();
+                                 raw->open = false; });
+        }
+      }
+
+      void PublicConnectionPool::set_callbacks(OpenCallback on_open, CloseCallback on_close, MessageHandler handler)
+      {
+        on_open_ = std::move(on_open);
+        on_close_ = std::move(on_close);
+        handler_ = std::move(handler);
+      }
+
+      void PublicConnectionPool::run()
+      {
+        for (auto &connection : connections_)
+        {
+          connection->reconnect->resume();
+          connect(*connection);
+        }
+
+        if (slots() > 1 && options_.rebalance_interval_ms > 0)
+        {
+          rebalance_timer_ = loop_->setInterval(options_.rebalance_interval_ms, [this](hv::TimerID)
+                                                { rebalance(); });
+        }
+      }
+
+      void PublicConnectionPool::connect(Connection &connection)
+      {
+        Connection *raw = &connection;
+        raw->client->run(
+            [this, raw](const HttpResponsePtr &response)
+            {
+              raw->open = true;
+              raw->reconnect->on_open(raw->client->last_connect());
+              raw->subscriptions->on_connected();
+              raw->heartbeat->start();
+              on_open_(raw->index);
+            },
+            [this, raw]()
+            {
+              raw->open = false;
+              raw->subscriptions->on_disconnected();
+              raw->heartbeat->stop();
+              raw->reconnect->on_close();
+              on_close_(raw->index);
+            },
+            [this, raw](const std::string &message)
+            {
+              ++raw->messages;
+              raw->bytes += message.size();
+              raw->heartbeat->on_frame(message);
+              handler_(raw->index, message);
+            });
+      }
+
+      void PublicConnectionPool::close()
+      {
+        // run() arms it again when the pool is reopened
+        if (rebalance_timer_ != INVALID_TIMER_ID)
+        {
+          loop_->killTimer(rebalance_timer_);
+          rebalance_timer_ = INVALID_TIMER_ID;
+        }
+        for (auto &connection : connections_)
+        {
+          connection->reconnect->stop();
+          connection->client->close();
+          connection->open = false;
+        }
+      }
+
+      void PublicConnectionPool::set_clock(size_t index, ClockEstimator *clock)
+      {
+        if (index < connections_.size())
+        {
+          connections_[index]->heartbeat->set_clock(clock);
+        }
+      }
+
+      double PublicConnectionPool::default_symbol_rate() const
+      {
+        double total = 0.0;
+        size_t measured = 0;
+        for (const auto &entry : placements_)
+        {
+          if (entry.second.rate > 0.0)
+          {
+            total += entry.second.rate;
+            ++measured;
+          }
+        }
+        return measured ? total / measured : 1.0;
+      }
+
+      double PublicConnectionPool::load_of(size_t index) const
+      {
+        double load = 0.0;
+        for (const auto &entry : placements_)
+        {
+          if (entry.second.index == index)
+          {
+            load += entry.second.rate;
+          }
+        }
+        return load;
+      }
+
+      SubscriptionManager *PublicConnectionPool::place(const std::string &symbol)
+      {
+        std::lock_guard<std::mutex> lock(placement_mutex_);
+        auto it = placements_.find(symbol);
+        if (it != placements_.end())
+        {
+          return connections_[it->second.index]->subscriptions.get();
+        }
+
+        size_t best = 0;
+        double best_load = load_of(0);
+        for (size_t i = 1; i < slots(); ++i)
+        {
+          double load = load_of(i);
+          if (load < best_load)
+          {
+            best = i;
+            best_load = load;
+          }
+        }
+
+        Placement placement;
+        placement.index = best;
+        placement.rate = default_symbol_rate(); // until measured, assume an average symbol
+        placements_.emplace(symbol, placement);
+        return connections_[best]->subscriptions.get();
+      }
+
+      SubscriptionManager *PublicConnectionPool::find(const std::string &symbol)
+      {
+        std::lock_guard<std::mutex> lock(placement_mutex_);
+        auto it = placements_.find(symbol);
+        return it == placements_.end() ? nullptr : connections_[it->second.index]->subscriptions.get();
+      }
+
+      void PublicConnectionPool::record_message(size_t index, const std::string &symbol)
+      {
+        if (index >= connections_.size() || symbol.empty())
+        {
+          return;
+        }
+        Connection &connection = *connections_[index];
+        connection.reconnect->on_restored(); // market data is flowing again
+        std::lock_guard<std::mutex> lock(connection.mutex);
+        ++connection.symbol_messages[symbol];
+      }
+
+      void PublicConnectionPool::record_duplicate(size_t index)
+      {
+        if (index >= connections_.size())
+        {
+          return;
+        }
+        Connection &connection = *connections_[index];
+        connection.reconnect->on_restored();
+        ++connection.duplicates;
+      }
+
+      void PublicConnectionPool::sample_rates()
+      {
+        int64_t now = now_ns();
+        double elapsed = (now - last_sample_ns_) / 1e9;
+        last_sample_ns_ = now;
+        if (elapsed <= 0.0)
+        {
+          return;
+        }
+
+        for (auto &connection : connections_)
+        {
+          uint64_t messages = connection->messages;
+          connection->message_rate = (messages - connection->messages_at_sample) / elapsed;
+          connection->messages_at_sample = messages;
+        }
+
+        for (auto it = placements_.begin(); it != placements_.end();)
+        {
+          Connection &owner = *connections_[it->second.index];
+          if (!owner.subscriptions->has_symbol(it->first) && it->second.messages_at_sample > 0)
+          {
+            it = placements_.erase(it); // fully unsubscribed
+            continue;
+          }
+
+          // Counters follow the symbol across moves, so sum over every connection
+          uint64_t total = 0;
+          for (auto &connection : connections_)
+          {
+            std::lock_guard<std::mutex> lock(connection->mutex);
+            auto counter = connection->symbol_messages.find(it->first);
+            if (counter != connection->symbol_messages.end())
+            {
+              total += counter->second;
+            }
+          }
+          double window_rate = (total - std::min(total, it->second.messages_at_sample)) / elapsed;
+          it->second.rate = RATE_SMOOTHING * window_rate + (1.0 - RATE_SMOOTHING) * it->second.rate;
+          it->second.messages_at_sample = std::max<uint64_t>(total, 1);
+          ++it;
+        }
+      }
+
+      void PublicConnectionPool::rebalance()
+      {
+        std::lock_guard<std::mutex> lock(placement_mutex_);
+        sample_rates();
+        if (slots() < 2)
+        {
+          return;
+        }
+
+        // Placements and moves are per slot; the mirrors follow the line-0 connection
+        size_t busiest = 0;
+        size_t quietest = 0;
+        std::vector<double> loads(slots());
+        for (size_t i = 0; i < slots(); ++i)
+        {
+          loads[i] = load_of(i);
+          if (loads[i] > loads[busiest])
+          {
+            busiest = i;
+          }
+          if (loads[i] < loads[quietest])
+          {
+            quietest = i;
+          }
+        }
+
+        double gap = loads[busiest] - loads[quietest];
+        if (busiest == quietest || loads[busiest] <= loads[quietest] * (1.0 + options_.rebalance_threshold) || gap <= 0.0)
+        {
+          return;
+        }
+
+        // Move the symbol that best halves the gap; anything at or above the gap would only swap roles
+        const std::string *candidate = nullptr;
+        double best_distance = gap;
+        size_t symbols_on_busiest = 0;
+        for (auto &entry : placements_)
+        {
+          if (entry.second.index != busiest)
+          {
+            continue;
+          }
+          ++symbols_on_busiest;
+          if (entry.second.rate >= gap)
+          {
+            continue;
+          }
+          double distance = std::fabs(entry.second.rate - gap / 2.0);
+          if (distance < best_distance)
+          {
+            best_distance = distance;
+            candidate = &entry.first;
+          }
+        }
+        if (!candidate || symbols_on_busiest < 2)
+        {
+          return;
+        }
+
+        placements_[*candidate].index = quietest;
+        connections_[busiest]->subscriptions->transfer(*candidate, *connections_[quietest]->subscriptions);
+        ++moves_;
+
+        singular::utility::log_event(name_, singular::utility::OEMSEvent::WS_CONNECTION_DEBUG,
+                                     "Rebalanced " + *candidate + " from connection " + std::to_string(busiest) + " to " + std::to_string(quietest));
+      }
+
+      size_t PublicConnectionPool::open_connections() const
+      {
+        size_t open = 0;
+        for (const auto &connection : connections_)
+        {
+          open += connection->open ? 1 : 0;
+        }
+        return open;
+      }
+
+      nlohmann::json PublicConnectionPool::get_stats() const
+      {
+        std::lock_guard<std::mutex> lock(placement_mutex_);
+        nlohmann::json stats;
+        stats["name"] = name_;
+        stats["moves"] = moves_;
+        stats["lines"] = lines_;
+        stats["stale_closes"] = stale_closes_.load();
+        stats["connections"] = nlohmann::json::array();
+        for (const auto &connection : connections_)
+        {
+          size_t symbols = 0;
+          for (const auto &entry : placements_)
+          {
+            symbols += entry.second.index == slot_of(connection->index) ? 1 : 0;
+          }
+          stats["connections"].push_back({{"index", connection->index},
+                                          {"line", connection->line},
+                                          {"open", connection->open.load()},
+                                          {"messages", connection->messages.load()},
+                                          {"bytes", connection->bytes.load()},
+                                          {"duplicates", connection->duplicates.load()},
+                                          {"message_rate", connection->message_rate},
+                                          {"estimated_load", load_of(slot_of(connection->index))},
+                                          {"symbols", symbols},
+                                          {"heartbeat", connection->heartbeat->get_stats()},
+                                          {"reconnect", connection->reconnect->get_stats()},
+                                          {"subscriptions", connection->subscriptions->get_stats()}});
+        }
+        return stats;
+      }
+
+      nlohmann::json PublicConnectionPool::get_heartbeat_stats() const
+      {
+        nlohmann::json stats = nlohmann::json::array();
+        for (const auto &connection : connections_)
+        {
+          stats.push_back(connection->heartbeat->get_stats());
+        }
+        return stats;
+      }
+
+      nlohmann::json PublicConnectionPool::get_reconnect_stats() const
+      {
+        nlohmann::json stats = nlohmann::json::array();
+        for (const auto &connection : connections_)
+        {
+          stats.push_back(connection->reconnect->get_stats());
+        }
+        return stats;
+      }
+
+      nlohmann::json PublicConnectionPool::get_send_stats() const
+      {
+        nlohmann::json stats = nlohmann::json::array();
+        for (const auto &connection : connections_)
+        {
+          stats.push_back(connection->sender->get_stats());
+        }
+        return stats;
+      }
+
+      nlohmann::json PublicConnectionPool::get_transport_stats() const
+      {
+        nlohmann::json stats = nlohmann::json::array();
+        for (const auto &connection : connections_)
+        {
+          nlohmann::json client = connection->client->get_stats();
+          client["connection"] = name_ + "#" + std::to_string(connection->index);
+          stats.push_back(client);
+        }
+        return stats;
+      }
+
+    } // namespace gateio
+  } // namespace gateway
+} // namespace singular
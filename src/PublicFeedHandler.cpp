@@ -0,0 +1,411 @@
+#include <chrono>
+
+#include "gateio/include/PublicFeedHandler.h"
+#include "gateio/include/Tsc.h"
+#include <singular/utility/include/LatencyLogger.h>
+
+namespace singular
+{
+  namespace gateway
+  {
+    namespace gateio
+    {
+
+      namespace
+      {
+        // Gate.io sends prices as strings and futures sizes as integers
+        double to_double(const nlohmann::json &value)
+        {
+          if (value.is_string())
+          {
+            return std::stod(value.get_ref<const std::string &>());
+          }
+          return value.get<double>();
+        }
+
+        // Spot levels are ["price","amount"], futures levels are {"p":"price","s":size}
+        void read_level(const nlohmann::json &level, double &price, double &quantity)
+        {
+          if (level.is_array())
+          {
+            price = to_double(level[0]);
+            quantity = to_double(level[1]);
+          }
+          else
+          {
+            price = to_double(level["p"]);
+            quantity = to_double(level["s"]);
+          }
+        }
+
+        template <typename Side>
+        void apply_levels(Side &side, const nlohmann::json &levels)
+        {
+          double price = 0.0;
+          double quantity = 0.0;
+          for (const auto &level : levels)
+          {
+            read_level(level, price, quantity);
+            if (quantity == 0.0)
+            {
+              side.erase(price);
+            }
+            else
+            {
+              side[price] = quantity;
+            }
+          }
+        }
+
+        template <typename Side>
+        void copy_top(const Side &side, std::vector<BookLevel> &out, size_t depth)
+        {
+          out.clear();
+          for (auto it = side.begin(); it != side.end() && out.size() < depth; ++it)
+          {
+            out.push_back({it->first, it->second});
+          }
+        }
+      }
+
+      PublicFeedHandler::PublicFeedHandler(size_t depth)
+          : depth_(depth)
+      {
+        scratch_.bids.reserve(depth_);
+        scratch_.asks.reserve(depth_);
+      }
+
+      void PublicFeedHandler::on_message(const std::string &buffer)
+      {
+        last_symbol_.clear();
+        nlohmann::json message;
+        try
+        {
+          message = nlohmann::json::parse(buffer);
+        }
+        catch (const nlohmann::json::parse_error &e)
+        {
+          singular::utility::log_event(log_service_name, singular::utility::OEMSEvent::WS_CONNECTION_ERROR, std::string("JSON parse error: ") + e.what());
+          return;
+        }
+
+        if (!message.contains("channel") || !message.contains("event"))
+        {
+          return;
+        }
+
+        try
+        {
+          const std::string &channel = message["channel"].get_ref<const std::string &>();
+          const std::string &event = message["event"].get_ref<const std::string &>();
+
+          // Pongs are timed by the connection's Heartbeat before they get here
+          if (channel == "spot.pong" || channel == "futures.pong")
+          {
+            return;
+          }
+
+          if (event == "subscribe" || event == "unsubscribe")
+          {
+            if (message.contains("error") && !message["error"].is_null())
+            {
+              singular::utility::log_event(log_service_name, singular::utility::OEMSEvent::WS_CONNECTION_ERROR, "Subscription error on " + channel + ": " + message["error"].dump());
+            }
+            return;
+          }
+
+          if (event != "update" && event != "all")
+          {
+            return;
+          }
+          message_latency_ns_ = clock_ ? clock_->on_message(message.value("time_ms", 0LL), wall_clock_ns()) : 0;
+
+          if (channel == "spot.order_book_update")
+          {
+            apply_book_update(message["result"], "@SPOT");
+          }
+          else if (channel == "futures.order_book_update")
+          {
+            apply_book_update(message["result"], "@FUTURE");
+          }
+          else if (channel == "spot.obu")
+          {
+            apply_book_update(message["result"], "@SPOT");
+          }
+          else if (channel == "futures.obu")
+          {
+            apply_book_update(message["result"], "@FUTURE");
+          }
+          else if (channel == "futures.tickers")
+          {
+            apply_futures_tickers(message["result"], message.value("time_ms", 0LL));
+          }
+          else if (channel == "spot.trades")
+          {
+            apply_trades(message["result"], "@SPOT");
+          }
+          else if (channel == "futures.trades")
+          {
+            apply_trades(message["result"], "@FUTURE");
+          }
+          else if (channel == "spot.order_book")
+          {
+            apply_book_snapshot(message["result"], "@SPOT");
+          }
+          else if (channel == "futures.order_book")
+          {
+            apply_book_snapshot(message["result"], "@FUTURE");
+          }
+        }
+        catch (const std::exception &exception)
+        {
+          singular::utility::log_event(log_service_name, singular::utility::OEMSEvent::WS_CONNECTION_ERROR, std::string("Error reading public websocket message: ") + exception.what());
+        }
+      }
+
+      std::string PublicFeedHandler::book_symbol(const nlohmann::json &result, const char *market_suffix)
+      {
+        // obu streams name the book "ob.BTC_USDT.50", futures snapshots use "contract"
+        std::string name = result.contains("s") ? result["s"].get<std::string>() : result.value("contract", "");
+        if (name.compare(0, 3, "ob.") == 0)
+        {
+          name = name.substr(3, name.rfind('.') - 3);
+        }
+        return name + market_suffix;
+      }
+
+      void PublicFeedHandler::apply_book_update(const nlohmann::json &result, const char *market_suffix)
+      {
+        std::string symbol = book_symbol(result, market_suffix);
+        last_symbol_ = symbol;
+        auto &book = books_[symbol];
+
+        uint64_t first_update_id = result.value("U", 0ULL);
+        uint64_t last_update_id = result.value("u", 0ULL);
+
+        if (result.value("full", false))
+        {
+          book.bids.clear();
+          book.asks.clear();
+          seed(symbol, book);
+        }
+        else if (!book.seeded)
+        {
+          ++book.dropped;
+          request_resync(symbol, book);
+          return;
+        }
+        else if (last_update_id != 0 && last_update_id <= book.last_update_id)
+        {
+          return; // already applied
+        }
+        else if (book.last_update_id != 0 && first_update_id > book.last_update_id + 1)
+        {
+          // Levels past a gap are unknown: drop the book and wait for a fresh snapshot
+          ++book.gaps;
+          book.bids.clear();
+          book.asks.clear();
+          book.seeded = false;
+          book.last_update_id = 0;
+          set_valid(book, false);
+          request_resync(symbol, book);
+          publish_book(symbol, book, result);
+          return;
+        }
+
+        if (result.contains("b"))
+        {
+          apply_levels(book.bids, result["b"]);
+        }
+        if (result.contains("a"))
+        {
+          apply_levels(book.asks, result["a"]);
+        }
+        book.last_update_id = last_update_id;
+        ++book.updates;
+
+        publish_book(symbol, book, result);
+      }
+
+      void PublicFeedHandler::apply_book_snapshot(const nlohmann::json &result, const char *market_suffix)
+      {
+        std::string symbol = book_symbol(result, market_suffix);
+        last_symbol_ = symbol;
+        auto &book = books_[symbol];
+
+        uint64_t update_id = result.contains("lastUpdateId") ? result.value("lastUpdateId", 0ULL) : result.value("id", 0ULL);
+        if (update_id != 0 && update_id < book.last_update_id)
+        {
+          return; // older than what a faster stream already applied during a profile switch
+        }
+
+        book.bids.clear();
+        book.asks.clear();
+        if (result.contains("bids"))
+        {
+          apply_levels(book.bids, result["bids"]);
+        }
+        if (result.contains("asks"))
+        {
+          apply_levels(book.asks, result["asks"]);
+        }
+        book.last_update_id = update_id;
+        ++book.updates;
+        ++book.snapshots;
+        seed(symbol, book);
+
+        publish_book(symbol, book, result);
+      }
+
+      void PublicFeedHandler::apply_futures_tickers(const nlohmann::json &result, int64_t exchange_time_ms)
+      {
+        const int64_t receive_time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                            std::chrono::steady_clock::now().time_since_epoch())
+                                            .count();
+        for (const auto &ticker : result)
+        {
+          std::string symbol = ticker["contract"].get<std::string>() + "@FUTURE";
+          last_symbol_ = symbol;
+          if (!funding_)
+          {
+            continue;
+          }
+          auto &entry = funding_entries_[symbol];
+          if (!entry)
+          {
+            entry = funding_->entry(symbol);
+          }
+          funding_->on_ticker(*entry, ticker, exchange_time_ms, receive_time_ns);
+        }
+      }
+
+      void PublicFeedHandler::apply_trades(const nlohmann::json &result, const char *market_suffix)
+      {
+        // Spot pushes one trade per frame, futures a list
+        if (result.is_array())
+        {
+          for (const auto &trade : result)
+          {
+            apply_trade(trade, market_suffix);
+          }
+        }
+        else
+        {
+          apply_trade(result, market_suffix);
+        }
+      }
+
+      void PublicFeedHandler::apply_trade(const nlohmann::json &trade, const char *market_suffix)
+      {
+        const bool spot = trade.contains("currency_pair");
+        std::string symbol = (spot ? trade["currency_pair"] : trade["contract"]).get<std::string>() + market_suffix;
+        last_symbol_ = symbol;
+        if (!snapshots_)
+        {
+          return;
+        }
+        auto &entry = trade_entries_[symbol];
+        if (!entry)
+        {
+          entry = snapshots_->entry(symbol);
+        }
+        int64_t time_ms = trade.contains("create_time_ms") ? static_cast<int64_t>(to_double(trade["create_time_ms"])) : 0;
+        snapshots_->on_trade(*entry, to_double(trade["price"]), to_double(spot ? trade["amount"] : trade["size"]), time_ms);
+      }
+
+      void PublicFeedHandler::set_valid(LocalBook &book, bool valid)
+      {
+        if (book.valid == valid)
+        {
+          return;
+        }
+        book.valid = valid;
+        if (health_)
+        {
+          health_->on_book_validity(valid);
+        }
+      }
+
+      void PublicFeedHandler::request_resync(const std::string &symbol, LocalBook &book)
+      {
+        if (book.resync_pending)
+        {
+          return;
+        }
+        book.resync_pending = true;
+        ++book.resyncs;
+        singular::utility::log_event(log_service_name, singular::utility::OEMSEvent::WS_CONNECTION_DEBUG, "Requesting book snapshot for " + symbol);
+        if (resync_callback_)
+        {
+          resync_callback_(symbol, true);
+        }
+      }
+
+      void PublicFeedHandler::seed(const std::string &symbol, LocalBook &book)
+      {
+        book.seeded = true;
+        set_valid(book, true);
+        if (book.resync_pending)
+        {
+          book.resync_pending = false;
+          if (resync_callback_)
+          {
+            resync_callback_(symbol, false);
+          }
+        }
+      }
+
+      void PublicFeedHandler::publish_book(const std::string &symbol, LocalBook &book, const nlohmann::json &result)
+      {
+        if (!book_callback_ && !snapshots_)
+        {
+          return;
+        }
+        scratch_.symbol = symbol;
+        scratch_.first_update_id = result.value("U", book.last_update_id);
+        scratch_.last_update_id = book.last_update_id;
+        scratch_.exchange_time_ms = result.value("t", 0LL);
+        scratch_.latency_ns = message_latency_ns_;
+        scratch_.valid = book.valid;
+        scratch_.receive_time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                       std::chrono::steady_clock::now().time_since_epoch())
+                                       .count();
+        copy_top(book.bids, scratch_.bids, depth_);
+        copy_top(book.asks, scratch_.asks, depth_);
+        if (snapshots_)
+        {
+          if (!book.snapshot)
+          {
+            book.snapshot = snapshots_->entry(symbol);
+          }
+          snapshots_->on_book(*book.snapshot, scratch_);
+        }
+        if (book_callback_)
+        {
+          book_callback_(scratch_);
+        }
+      }
+
+      nlohmann::json PublicFeedHandler::get_book_stats() const
+      {
+        nlohmann::json stats = nlohmann::json::array();
+        for (const auto &entry : books_)
+        {
+          stats.push_back({{"symbol", entry.first},
+                           {"last_update_id", entry.second.last_update_id},
+                           {"updates", entry.second.updates},
+                           {"gaps", entry.second.gaps},
+                           {"snapshots", entry.second.snapshots},
+                           {"resyncs", entry.second.resyncs},
+                           {"dropped_unseeded", entry.second.dropped},
+                           {"seeded", entry.second.seeded},
+                           {"valid", entry.second.valid},
+                           {"bid_levels", entry.second.bids.size()},
+                           {"ask_levels", entry.second.asks.size()}});
+        }
+        return stats;
+      }
+
+    } // namespace gateio
+  } // namespace gateway
+} // namespace singular
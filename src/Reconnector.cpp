@@ -0,0 +1,208 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include "gateio/include/Reconnector.h"
+#include <singular/utility/include/LatencyLogger.h>
+
+namespace singular
+{
+  namespace gateway
+  {
+    namespace gateio
+    {
+
+      namespace
+      {
+        int64_t now_ns()
+        {
+          return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                     std::chrono::steady_clock::now().time_since_epoch())
+              .count();
+        }
+      }
+
+      Reconnector::Reconnector(hv::EventLoopPtr loop, const std::string &name, ConnectFunction connect, const Options &options)
+          : loop_(std::move(loop)),
+            name_(name),
+            connect_(std::move(connect)),
+            options_(options),
+            random_(std::random_device{}())
+      {
+      }
+
+      Reconnector::~Reconnector()
+      {
+        if (timer_ != INVALID_TIMER_ID)
+        {
+          loop_->killTimer(timer_);
+        }
+      }
+
+      const char *Reconnector::to_string(State state)
+      {
+        switch (state)
+        {
+        case State::IDLE:
+          return "IDLE";
+        case State::CONNECTED:
+          return "CONNECTED";
+        case State::BACKOFF:
+          return "BACKOFF";
+        case State::CONNECTING:
+          return "CONNECTING";
+        case State::RESTORING:
+          return "RESTORING";
+        case State::STOPPED:
+          return "STOPPED";
+        }
+        return "UNKNOWN";
+      }
+
+      bool Reconnector::on_open(const WsClient::ConnectInfo &connect)
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (state_ == State::STOPPED)
+        {
+          return false;
+        }
+        if (outage_start_ns_ != 0)
+        {
+          if (attempt_start_ns_ != 0)
+          {
+            last_connect_ns_ = now_ns() - attempt_start_ns_;
+            connect_time_.record(static_cast<uint64_t>(last_connect_ns_));
+            last_tls_ns_ = connect.tls_ns;
+            if (connect.tls_ns >= 0)
+            {
+              tls_time_.record(static_cast<uint64_t>(connect.tls_ns));
+              ++(connect.resumed ? tls_resumed_ : tls_full_);
+            }
+          }
+          else
+          {
+            // Opened with no attempt of ours in progress: a standby took over
+            last_connect_ns_ = 0;
+            last_tls_ns_ = -1;
+            ++instant_opens_;
+          }
+        }
+        attempt_start_ns_ = 0;
+        if (timer_ != INVALID_TIMER_ID)
+        {
+          loop_->killTimer(timer_);
+          timer_ = INVALID_TIMER_ID;
+        }
+        state_ = State::RESTORING;
+        return outage_start_ns_ != 0;
+      }
+
+      int Reconnector::next_delay_ms()
+      {
+        const double delay = std::min<double>(options_.max_backoff_ms,
+                                              options_.initial_backoff_ms * std::pow(options_.multiplier, attempt_));
+        std::uniform_real_distribution<double> jitter(0.5, 1.0);
+        return std::max(1, static_cast<int>(delay * jitter(random_)));
+      }
+
+      void Reconnector::on_close()
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (state_ == State::STOPPED || state_ == State::BACKOFF)
+        {
+          return;
+        }
+        if (outage_start_ns_ == 0)
+        {
+          outage_start_ns_ = now_ns();
+          ++disconnects_;
+        }
+        const int delay_ms = next_delay_ms();
+        attempt_start_ns_ = 0;
+        ++attempt_;
+        state_ = State::BACKOFF;
+        singular::utility::log_event("GATEIO", singular::utility::OEMSEvent::WS_CONNECTION_ERROR,
+                                     name_ + " closed, reconnect attempt " + std::to_string(attempt_) + " in " + std::to_string(delay_ms) + "ms");
+        timer_ = loop_->setTimeout(delay_ms, [this](hv::TimerID)
+                                   {
+                                     {
+                                       std::lock_guard<std::mutex> lock(mutex_);
+                                       timer_ = INVALID_TIMER_ID;
+                                       if (state_ != State::BACKOFF)
+                                       {
+                                         return;
+                                       }
+                                       state_ = State::CONNECTING;
+                                       attempt_start_ns_ = now_ns();
+                                       ++attempts_;
+                                     }
+                                     connect_(); });
+      }
+
+      void Reconnector::finish_restore()
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (state_ != State::RESTORING)
+        {
+          return;
+        }
+        state_ = State::CONNECTED;
+        attempt_ = 0;
+        if (outage_start_ns_ != 0)
+        {
+          last_restore_ns_ = now_ns() - outage_start_ns_;
+          restore_time_.record(static_cast<uint64_t>(last_restore_ns_));
+          outage_start_ns_ = 0;
+          ++restores_;
+          singular::utility::log_event("GATEIO", singular::utility::OEMSEvent::WS_CONNECTION_DEBUG,
+                                       name_ + " restored after " + std::to_string(last_restore_ns_ / 1000000) + "ms, connect " +
+                                           std::to_string(last_connect_ns_ / 1000000) + "ms");
+        }
+      }
+
+      void Reconnector::stop()
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        state_ = State::STOPPED;
+        if (timer_ != INVALID_TIMER_ID)
+        {
+          loop_->killTimer(timer_);
+          timer_ = INVALID_TIMER_ID;
+        }
+        outage_start_ns_ = 0;
+        attempt_start_ns_ = 0;
+        attempt_ = 0;
+      }
+
+      void Reconnector::resume()
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (state_ == State::STOPPED)
+        {
+          state_ = State::IDLE;
+        }
+      }
+
+      nlohmann::json Reconnector::get_stats() const
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return {{"name", name_},
+                {"state", to_string(state_)},
+                {"attempt", attempt_},
+                {"disconnects", disconnects_},
+                {"attempts", attempts_},
+                {"restores", restores_},
+                {"last_restore_ms", last_restore_ns_ / 1e6},
+                {"restore_time_ns", restore_time_.to_json()},
+                {"last_connect_ms", last_connect_ns_ / 1e6},
+                {"last_tls_ms", last_tls_ns_ < 0 ? -1.0 : last_tls_ns_ / 1e6},
+                {"connect_time_ns", connect_time_.to_json()},
+                {"tls_handshake_ns", tls_time_.to_json()},
+                {"tls_resumed", tls_resumed_},
+                {"tls_full", tls_full_},
+                {"instant_opens", instant_opens_}};
+      }
+
+    } // namespace gateio
+  } // namespace gateway
+} // namespace singular
@@ -0,0 +1,373 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#include "gateio/include/RedundantSessions.h"
+#include "gateio/include/Tsc.h"
+#include <singular/utility/include/LatencyLogger.h>
+
+namespace singular
+{
+  namespace gateway
+  {
+    namespace gateio
+    {
+
+      namespace
+      {
+        int64_t now_ns()
+        {
+          return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                     std::chrono::steady_clock::now().time_since_epoch())
+              .count();
+        }
+
+        // String value of "key":"value" in a raw frame, empty if absent
+        std::string frame_string(const std::string &frame, const char *key)
+        {
+          size_t at = frame.find(key);
+          if (at == std::string::npos)
+          {
+            return std::string();
+          }
+          at += std::strlen(key);
+          size_t end = frame.find('"', at);
+          return end == std::string::npos ? std::string() : frame.substr(at, end - at);
+        }
+      }
+
+      RedundantSessions::RedundantSessions(const std::vector<hv::EventLoopPtr> &loops, const char *url, const char *login_channel,
+                                           const Heartbeat::Options &heartbeat, const Reconnector::Options &reconnect,
+                                           const SendQueue::Options &send_options, LoginFrame login, FrameSink sink)
+          : login_channel_(login_channel),
+            login_(std::move(login)),
+            sink_(std::move(sink))
+      {
+        const std::string ping_channel = login_channel_.substr(0, login_channel_.find('.')) + ".ping";
+        for (size_t i = 0; i < loops.size(); ++i)
+        {
+          auto session = std::make_unique<Session>();
+          Session *raw = session.get();
+          raw->name = STANDBY_PREFIX + std::to_string(i);
+          raw->source = i + 1;
+          raw->client = WsClient::create(loops[i], url, raw->name, ping_channel);
+          raw->sender = std::make_unique<SendQueue>(
+              loops[i], raw->name, [raw](const std::string &frame) { raw->client->send(frame); }, send_options);
+          raw->clock = std::make_unique<ClockEstimator>(raw->name);
+          raw->heartbeat = std::make_unique<Heartbeat>(
+              loops[i], raw->name, ping_channel.c_str(),
+              [raw](const std::string &frame) { raw->client->send(frame); }, heartbeat);
+          raw->heartbeat->set_clock(raw->clock.get());
+          raw->heartbeat->set_stale_callback([raw](const std::string &reason)
+                                             { raw->client->drop(); });
+          raw->reconnect = std::make_unique<Reconnector>(
+              loops[i], raw->name, [this, raw]() { connect(*raw); }, reconnect);
+          sessions_.push_back(std::move(session));
+        }
+        wins_.assign(sessions_.size() + 1, 0);
+        if (!loops.empty())
+        {
+          timer_loop_ = loops.front();
+        }
+      }
+
+      RedundantSessions::~RedundantSessions()
+      {
+        if (hold_timer_ != INVALID_TIMER_ID)
+        {
+          timer_loop_->killTimer(hold_timer_);
+        }
+      }
+
+      void RedundantSessions::set_capture(FeedCapture *capture, const CaptureName &name)
+      {
+        capture_ = capture;
+        for (auto &session : sessions_)
+        {
+          session->capture_id = capture_->add_connection(name(session->name));
+        }
+      }
+
+      void RedundantSessions::run()
+      {
+        for (auto &session : sessions_)
+        {
+          session->reconnect->resume();
+          connect(*session);
+        }
+        if (timer_loop_ && hold_timer_ == INVALID_TIMER_ID)
+        {
+          hold_timer_ = timer_loop_->setInterval(HOLD_TIMEOUT_MS / 4, [this](hv::TimerID)
+                                                 { release_expired(); });
+        }
+      }
+
+      void RedundantSessions::connect(Session &session)
+      {
+        Session *raw = &session;
+        raw->client->run(
+            [this, raw](const HttpResponsePtr &response)
+            {
+              raw->open = true;
+              raw->heartbeat->start();
+              raw->reconnect->on_open(raw->client->last_connect());
+              raw->sender->send(login_(), SendQueue::Priority::OTHER, true);
+            },
+            [this, raw]()
+            {
+              raw->open = false;
+              raw->authenticated = false;
+              raw->heartbeat->stop();
+              raw->reconnect->on_close();
+              on_session_closed(raw->source);
+            },
+            [this, raw](const std::string &frame)
+            {
+              if (capture_)
+              {
+                capture_->record(raw->capture_id, frame);
+              }
+              if (raw->heartbeat->on_frame(frame))
+              {
+                return;
+              }
+              // Standby logins stay private to the session; only order responses reach the engine
+              if (frame.find(login_channel_) != std::string::npos && frame.find("\"request_id\"") != std::string::npos)
+              {
+                raw->authenticated = frame.find("\"status\":\"200\"") != std::string::npos;
+                if (raw->authenticated)
+                {
+                  raw->reconnect->on_restored();
+                }
+                else
+                {
+                  singular::utility::log_event("GATEIO", singular::utility::OEMSEvent::LOGIN_EXCHANGE_ERROR, raw->name + " login failed");
+                }
+                return;
+              }
+              sink_(raw->source, raw->inbox, frame);
+            });
+      }
+
+      void RedundantSessions::close()
+      {
+        if (hold_timer_ != INVALID_TIMER_ID)
+        {
+          timer_loop_->killTimer(hold_timer_);
+          hold_timer_ = INVALID_TIMER_ID;
+        }
+        for (auto &session : sessions_)
+        {
+          session->reconnect->stop();
+          session->client->close();
+          session->open = false;
+          session->authenticated = false;
+        }
+      }
+
+      RedundantSessions::Session *RedundantSessions::fastest()
+      {
+        Session *best = nullptr;
+        for (auto &session : sessions_)
+        {
+          const int64_t rtt = session->heartbeat->smoothed_rtt_ns();
+          if (!session->usable() || rtt == 0)
+          {
+            continue;
+          }
+          if (!best || rtt < best->heartbeat->smoothed_rtt_ns())
+          {
+            best = session.get();
+          }
+        }
+        return best;
+      }
+
+      std::vector<RedundantSessions::Session *> RedundantSessions::usable()
+      {
+        std::vector<Session *> usable;
+        for (auto &session : sessions_)
+        {
+          if (session->usable())
+          {
+            usable.push_back(session.get());
+          }
+        }
+        return usable;
+      }
+
+      bool RedundantSessions::send(Session &session, const std::string &frame, SendQueue::Priority priority, bool urgent)
+      {
+        if (!session.sender->send(frame, priority, urgent))
+        {
+          return false;
+        }
+        ++session.sent;
+        return true;
+      }
+
+      void RedundantSessions::expect(const std::string &channel, const std::string &req_id, const std::vector<size_t> &sources)
+      {
+        const std::string key = channel + "|" + req_id;
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        // Place and amend are acknowledged before their result; both are deduplicated
+        for (const std::string &name : {key, key + "|ack"})
+        {
+          auto inserted = pending_.emplace(name, Pending());
+          inserted.first->second = Pending();
+          inserted.first->second.waiting = sources;
+          if (inserted.second)
+          {
+            pending_order_.push_back(name);
+          }
+        }
+        while (pending_order_.size() > MAX_TRACKED)
+        {
+          pending_.erase(pending_order_.front());
+          pending_order_.pop_front();
+        }
+      }
+
+      bool RedundantSessions::accept(size_t source, const std::string &frame)
+      {
+        const std::string req_id = frame_string(frame, "\"request_id\":\"");
+        if (req_id.empty())
+        {
+          return true; // pushes and anything else that is not a request response
+        }
+        const bool ack = frame.find("\"ack\":true") != std::string::npos;
+        std::string key = frame_string(frame, "\"channel\":\"");
+        key.append("|").append(req_id);
+        if (ack)
+        {
+          key.append("|ack");
+        }
+        const bool success = frame.find("\"status\":\"200\"") != std::string::npos;
+
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        auto it = pending_.find(key);
+        if (it == pending_.end())
+        {
+          return true; // not sent through the redundant path, e.g. the primary's login
+        }
+        Pending &pending = it->second;
+        pending.waiting.erase(std::remove(pending.waiting.begin(), pending.waiting.end(), source), pending.waiting.end());
+        if (pending.delivered)
+        {
+          ++duplicates_;
+          return false;
+        }
+        if (!success && !pending.waiting.empty())
+        {
+          // Another session may still succeed; kept in case none does
+          ++held_failures_;
+          if (pending.held.empty())
+          {
+            pending.held_since_ns = now_ns();
+            held_order_.push_back(key);
+          }
+          pending.held = frame;
+          return false;
+        }
+        pending.delivered = true;
+        pending.held.clear();
+        if (!ack && source < wins_.size())
+        {
+          ++wins_[source];
+        }
+        return true;
+      }
+
+      void RedundantSessions::release(Pending &pending)
+      {
+        pending.delivered = true;
+        released_.push_back(std::move(pending.held));
+        pending.held.clear();
+        ++failures_released_;
+      }
+
+      void RedundantSessions::on_session_closed(size_t source)
+      {
+        bool released = false;
+        {
+          std::lock_guard<std::mutex> lock(pending_mutex_);
+          for (const std::string &key : held_order_)
+          {
+            auto it = pending_.find(key);
+            if (it == pending_.end() || it->second.held.empty())
+            {
+              continue;
+            }
+            Pending &pending = it->second;
+            pending.waiting.erase(std::remove(pending.waiting.begin(), pending.waiting.end(), source), pending.waiting.end());
+            if (pending.waiting.empty())
+            {
+              release(pending);
+              released = true;
+            }
+          }
+        }
+        if (released && release_callback_)
+        {
+          release_callback_();
+        }
+      }
+
+      void RedundantSessions::release_expired()
+      {
+        const int64_t deadline = now_ns() - static_cast<int64_t>(HOLD_TIMEOUT_MS) * 1000000;
+        bool released = false;
+        {
+          std::lock_guard<std::mutex> lock(pending_mutex_);
+          while (!held_order_.empty())
+          {
+            auto it = pending_.find(held_order_.front());
+            if (it != pending_.end() && !it->second.held.empty())
+            {
+              if (it->second.held_since_ns > deadline)
+              {
+                break;
+              }
+              release(it->second);
+              released = true;
+            }
+            held_order_.pop_front();
+          }
+        }
+        if (released && release_callback_)
+        {
+          release_callback_();
+        }
+      }
+
+      nlohmann::json RedundantSessions::get_stats() const
+      {
+        nlohmann::json stats;
+        {
+          std::lock_guard<std::mutex> lock(pending_mutex_);
+          stats["duplicates_dropped"] = duplicates_;
+          stats["failures_held"] = held_failures_;
+          stats["failures_released"] = failures_released_;
+          stats["tracked_requests"] = pending_.size();
+          stats["primary"] = {{"sent", primary_sent_.load()}, {"wins", wins_[0]}};
+          stats["standby"] = nlohmann::json::array();
+          for (size_t i = 0; i < sessions_.size(); ++i)
+          {
+            const Session &session = *sessions_[i];
+            stats["standby"].push_back({{"name", session.name},
+                                        {"open", session.open.load()},
+                                        {"authenticated", session.authenticated.load()},
+                                        {"smoothed_rtt_ms", session.heartbeat->smoothed_rtt_ns() / 1e6},
+                                        {"sent", session.sent.load()},
+                                        {"wins", wins_[i + 1]},
+                                        {"reconnect", session.reconnect->get_stats()},
+                                        {"send", session.sender->get_stats()},
+                                        {"transport", session.client->get_stats()}});
+          }
+        }
+        return stats;
+      }
+
+    } // namespace gateio
+  } // namespace gateway
+} // namespace singular
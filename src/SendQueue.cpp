@@ -0,0 +1,199 @@
+#include <algorithm>
+#include <chrono>
+
+#include "gateio/include/SendQueue.h"
+
+namespace singular
+{
+  namespace gateway
+  {
+    namespace gateio
+    {
+
+      namespace
+      {
+        int64_t now_ns()
+        {
+          return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                     std::chrono::steady_clock::now().time_since_epoch())
+              .count();
+        }
+      }
+
+      SendQueue::SendQueue(hv::EventLoopPtr loop, const std::string &name, Writer writer, const Options &options)
+          : loop_(std::move(loop)),
+            name_(name),
+            writer_(std::move(writer)),
+            options_(options)
+      {
+        options_.flush_batch = std::max<size_t>(options_.flush_batch, 1);
+      }
+
+      bool SendQueue::full(Priority priority) const
+      {
+        if (!queued() || (priority != Priority::PLACE && priority != Priority::AMEND))
+        {
+          return false;
+        }
+        const size_t index = static_cast<size_t>(priority);
+        return classes_[index].depth.load(std::memory_order_relaxed) >= options_.max_pending;
+      }
+
+      bool SendQueue::send(const std::string &frame, Priority priority, bool urgent)
+      {
+        ClassStats &stats = classes_[static_cast<size_t>(priority)];
+        if (full(priority))
+        {
+          ++stats.refused;
+          return false;
+        }
+        ++frames_;
+        ++stats.frames;
+        if (urgent)
+        {
+          ++urgent_;
+        }
+        const bool in_loop = loop_->isInLoopThread();
+        if (!queued())
+        {
+          // The client hops to its loop itself, one wakeup per frame from other threads
+          if (!in_loop)
+          {
+            ++wakeups_;
+          }
+          ++bursts_;
+          {
+            std::lock_guard<std::mutex> lock(stats_mutex_);
+            frames_per_burst_.record(1);
+          }
+          ++writes_;
+          writer_(frame);
+          return true;
+        }
+
+        const bool flush_now = urgent && in_loop;
+        bool schedule = false;
+        {
+          std::lock_guard<std::mutex> lock(pending_mutex_);
+          const size_t lane = options_.prioritize ? static_cast<size_t>(priority) : 0;
+          lanes_[lane].push_back(Entry{frame, now_ns(), priority});
+          stats.max_depth = std::max(stats.max_depth, ++stats.depth);
+          if (!flush_now && !flush_scheduled_)
+          {
+            flush_scheduled_ = true;
+            schedule = true;
+          }
+        }
+        if (flush_now)
+        {
+          // Everything queued before it, and every higher class, goes first
+          flush(SIZE_MAX);
+          return true;
+        }
+        if (schedule)
+        {
+          schedule_flush();
+        }
+        return true;
+      }
+
+      void SendQueue::schedule_flush()
+      {
+        ++wakeups_;
+        loop_->queueInLoop([this]()
+                           { flush(options_.prioritize ? options_.flush_batch : SIZE_MAX); });
+      }
+
+      void SendQueue::flush(size_t limit)
+      {
+        bool more = false;
+        {
+          std::lock_guard<std::mutex> lock(pending_mutex_);
+          for (auto &lane : lanes_)
+          {
+            while (!lane.empty() && flushing_.size() < limit)
+            {
+              flushing_.push_back(std::move(lane.front()));
+              lane.pop_front();
+              --classes_[static_cast<size_t>(flushing_.back().priority)].depth;
+            }
+            more = more || !lane.empty();
+          }
+          // A bounded flush hands the loop back before the rest, so new cancels can overtake it
+          flush_scheduled_ = more;
+        }
+        if (more)
+        {
+          schedule_flush();
+        }
+        if (flushing_.empty())
+        {
+          return;
+        }
+        ++bursts_;
+        const int64_t now = now_ns();
+        {
+          std::lock_guard<std::mutex> lock(stats_mutex_);
+          frames_per_burst_.record(flushing_.size());
+          for (const Entry &entry : flushing_)
+          {
+            classes_[static_cast<size_t>(entry.priority)].queue_ns.record(static_cast<uint64_t>(std::max<int64_t>(now - entry.enqueued_ns, 0)));
+          }
+        }
+        for (const Entry &entry : flushing_)
+        {
+          writer_(entry.frame);
+        }
+        writes_ += flushing_.size();
+        flushing_.clear();
+      }
+
+      const char *SendQueue::to_string(Priority priority)
+      {
+        switch (priority)
+        {
+        case Priority::CANCEL:
+          return "cancel";
+        case Priority::AMEND:
+          return "amend";
+        case Priority::PLACE:
+          return "place";
+        case Priority::OTHER:
+          return "other";
+        }
+        return "unknown";
+      }
+
+      nlohmann::json SendQueue::get_stats() const
+      {
+        const uint64_t frames = frames_.load();
+        const uint64_t wakeups = wakeups_.load();
+        const uint64_t bursts = bursts_.load();
+        nlohmann::json stats;
+        stats["name"] = name_;
+        stats["coalescing"] = options_.coalesce;
+        stats["prioritizing"] = options_.prioritize;
+        stats["frames"] = frames;
+        stats["urgent"] = urgent_.load();
+        stats["bursts"] = bursts;
+        stats["wakeups"] = wakeups;
+        stats["writes"] = writes_.load();
+        stats["wakeups_per_burst"] = bursts ? static_cast<double>(wakeups) / bursts : 0.0;
+        stats["classes"] = nlohmann::json::object();
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        stats["frames_per_burst"] = frames_per_burst_.to_json();
+        for (size_t i = 0; i < PRIORITIES; ++i)
+        {
+          const ClassStats &entry = classes_[i];
+          stats["classes"][to_string(static_cast<Priority>(i))] = {{"frames", entry.frames.load()},
+                                                                   {"refused", entry.refused.load()},
+                                                                   {"depth", entry.depth.load()},
+                                                                   {"max_depth", entry.max_depth},
+                                                                   {"queue_ns", entry.queue_ns.to_json()}};
+        }
+        return stats;
+      }
+
+    } // namespace gateio
+  } // namespace gateway
+} // namespace singular
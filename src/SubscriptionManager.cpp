@@ -0,0 +1,375 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include "gateio/include/SubscriptionManager.h"
+
+namespace singular
+{
+  namespace gateway
+  {
+    namespace gateio
+    {
+
+      namespace
+      {
+        int64_t now_ns()
+        {
+          return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                     std::chrono::steady_clock::now().time_since_epoch())
+              .count();
+        }
+
+        std::string frame_tail(const std::string &channel, const char *event, const std::string &payload)
+        {
+          std::string tail;
+          tail.reserve(channel.size() + payload.size() + 48);
+          tail.append(",\"channel\":\"").append(channel).append("\",\"event\":\"").append(event).append("\",\"payload\":").append(payload).append("}");
+          return tail;
+        }
+      }
+
+      SubscriptionManager::SubscriptionManager(hv::EventLoopPtr loop, SendFunction send, double frames_per_second, size_t max_batch)
+          : loop_(std::move(loop)),
+            send_(std::move(send)),
+            frames_per_second_(std::max(frames_per_second, 1.0)),
+            burst_(std::max(frames_per_second / 5.0, 1.0)),
+            max_batch_(std::max<size_t>(max_batch, 1)),
+            tokens_(burst_)
+      {
+        frame_buffer_.reserve(1024);
+      }
+
+      SubscriptionManager::~SubscriptionManager()
+      {
+        if (pump_timer_ != INVALID_TIMER_ID)
+        {
+          loop_->killTimer(pump_timer_);
+        }
+      }
+
+      void SubscriptionManager::subscribe(const std::string &channel, const std::string &symbol)
+      {
+        if (mirror_)
+        {
+          mirror_->subscribe(channel, symbol);
+        }
+        loop_->runInLoop([this, channel, symbol]()
+                         { enqueue(channel, cached(channel, symbol, nullptr), Event::SUBSCRIBE); });
+      }
+
+      void SubscriptionManager::unsubscribe(const std::string &channel, const std::string &symbol)
+      {
+        if (mirror_)
+        {
+          mirror_->unsubscribe(channel, symbol);
+        }
+        loop_->runInLoop([this, channel, symbol]()
+                         { enqueue(channel, cached(channel, symbol, nullptr), Event::UNSUBSCRIBE); });
+      }
+
+      void SubscriptionManager::subscribe(const std::string &channel, const std::string &symbol, const nlohmann::json &payload)
+      {
+        if (mirror_)
+        {
+          mirror_->subscribe(channel, symbol, payload);
+        }
+        loop_->runInLoop([this, channel, symbol, payload]()
+                         { enqueue(channel, cached(channel, symbol, &payload), Event::SUBSCRIBE); });
+      }
+
+      void SubscriptionManager::unsubscribe(const std::string &channel, const std::string &symbol, const nlohmann::json &payload)
+      {
+        if (mirror_)
+        {
+          mirror_->unsubscribe(channel, symbol, payload);
+        }
+        loop_->runInLoop([this, channel, symbol, payload]()
+                         { enqueue(channel, cached(channel, symbol, &payload), Event::UNSUBSCRIBE); });
+      }
+
+      void SubscriptionManager::on_connected()
+      {
+        loop_->runInLoop([this]()
+                         {
+                           connected_ = true;
+                           if (was_connected_)
+                           {
+                             replay_active();
+                           }
+                           was_connected_ = true;
+                           pump(); });
+      }
+
+      void SubscriptionManager::on_disconnected()
+      {
+        loop_->runInLoop([this]()
+                         { connected_ = false; });
+      }
+
+      void SubscriptionManager::replay_active()
+      {
+        // The exchange forgot everything with the old socket; queued unsubscribes are moot
+        // and queued subscribes are part of the active set anyway
+        pending_.clear();
+        if (pump_timer_ != INVALID_TIMER_ID)
+        {
+          loop_->killTimer(pump_timer_);
+          pump_timer_ = INVALID_TIMER_ID;
+        }
+        for (const CachedFrames *frames : active_)
+        {
+          append_pending(frames->channel, *frames, Event::SUBSCRIBE);
+        }
+        pending_frames_ = pending_.size();
+        first_request_ns_ = now_ns();
+        ++replays_;
+      }
+
+      void SubscriptionManager::transfer(const std::string &symbol, SubscriptionManager &target)
+      {
+        loop_->runInLoop([this, symbol, &target]()
+                         {
+                           std::vector<const CachedFrames *> entries;
+                           for (const CachedFrames *frames : active_)
+                           {
+                             if (frames->symbol == symbol)
+                             {
+                               entries.push_back(frames);
+                             }
+                           }
+                           for (const CachedFrames *frames : entries)
+                           {
+                             if (frames->batchable)
+                             {
+                               target.subscribe(frames->channel, symbol);
+                             }
+                             else
+                             {
+                               target.subscribe(frames->channel, symbol, frames->payload);
+                             }
+                           }
+                           // target mirrors its subscribes itself; the unsubscribes here bypass the public API
+                           for (const CachedFrames *frames : entries)
+                           {
+                             enqueue(frames->channel, *frames, Event::UNSUBSCRIBE);
+                             if (mirror_ && frames->batchable)
+                             {
+                               mirror_->unsubscribe(frames->channel, symbol);
+                             }
+                             else if (mirror_)
+                             {
+                               mirror_->unsubscribe(frames->channel, symbol, frames->payload);
+                             }
+                           } });
+      }
+
+      bool SubscriptionManager::has_symbol(const std::string &symbol) const
+      {
+        std::lock_guard<std::mutex> lock(symbols_mutex_);
+        return symbol_refs_.count(symbol) > 0;
+      }
+
+      void SubscriptionManager::track_symbol(const std::string &symbol, bool active)
+      {
+        std::lock_guard<std::mutex> lock(symbols_mutex_);
+        if (active)
+        {
+          ++symbol_refs_[symbol];
+          return;
+        }
+        auto it = symbol_refs_.find(symbol);
+        if (it != symbol_refs_.end() && --it->second == 0)
+        {
+          symbol_refs_.erase(it);
+        }
+      }
+
+      const SubscriptionManager::CachedFrames &SubscriptionManager::cached(const std::string &channel, const std::string &symbol, const nlohmann::json *payload)
+      {
+        std::string key = channel;
+        key.append("|").append(payload ? payload->dump() : symbol);
+
+        auto it = cache_.find(key);
+        if (it != cache_.end())
+        {
+          return it->second;
+        }
+
+        CachedFrames frames;
+        frames.channel = channel;
+        frames.symbol = symbol;
+        frames.batchable = (payload == nullptr);
+        std::string payload_string;
+        if (frames.batchable)
+        {
+          frames.token = nlohmann::json(symbol).dump();
+          payload_string = "[" + frames.token + "]";
+        }
+        else
+        {
+          frames.payload = *payload;
+          frames.token = payload->dump();
+          payload_string = frames.token;
+        }
+        frames.subscribe = frame_tail(channel, "subscribe", payload_string);
+        frames.unsubscribe = frame_tail(channel, "unsubscribe", payload_string);
+        return cache_.emplace(std::move(key), std::move(frames)).first->second;
+      }
+
+      void SubscriptionManager::enqueue(const std::string &channel, const CachedFrames &frames, Event event)
+      {
+        bool active = active_.count(&frames) > 0;
+        if ((event == Event::SUBSCRIBE) == active)
+        {
+          return; // already in the requested state
+        }
+
+        track_symbol(frames.symbol, event == Event::SUBSCRIBE);
+        if (event == Event::SUBSCRIBE)
+        {
+          active_.insert(&frames);
+        }
+        else
+        {
+          active_.erase(&frames);
+
+          // A subscribe that has not gone out yet is simply withdrawn
+          for (auto frame = pending_.begin(); frame != pending_.end(); ++frame)
+          {
+            if (frame->event != Event::SUBSCRIBE || frame->channel != channel)
+            {
+              continue;
+            }
+            auto entry = std::find(frame->entries.begin(), frame->entries.end(), &frames);
+            if (entry != frame->entries.end())
+            {
+              frame->entries.erase(entry);
+              if (frame->entries.empty())
+              {
+                pending_.erase(frame);
+              }
+              pending_frames_ = pending_.size();
+              active_count_ = active_.size();
+              return;
+            }
+          }
+        }
+        active_count_ = active_.size();
+
+        if (pending_.empty())
+        {
+          first_request_ns_ = now_ns();
+        }
+
+        append_pending(channel, frames, event);
+        pending_frames_ = pending_.size();
+        pump();
+      }
+
+      void SubscriptionManager::append_pending(const std::string &channel, const CachedFrames &frames, Event event)
+      {
+        if (frames.batchable)
+        {
+          for (auto frame = pending_.rbegin(); frame != pending_.rend(); ++frame)
+          {
+            if (frame->event == event && frame->channel == channel && frame->entries.size() < max_batch_ && frame->entries.front()->batchable)
+            {
+              frame->entries.push_back(&frames);
+              return;
+            }
+          }
+        }
+        pending_.push_back({channel, event, {&frames}});
+      }
+
+      bool SubscriptionManager::take_token()
+      {
+        int64_t now = now_ns();
+        if (last_refill_ns_ != 0)
+        {
+          tokens_ = std::min(burst_, tokens_ + (now - last_refill_ns_) * frames_per_second_ / 1e9);
+        }
+        last_refill_ns_ = now;
+        if (tokens_ < 1.0)
+        {
+          return false;
+        }
+        tokens_ -= 1.0;
+        return true;
+      }
+
+      void SubscriptionManager::pump()
+      {
+        if (!connected_ || pump_timer_ != INVALID_TIMER_ID)
+        {
+          return;
+        }
+
+        while (!pending_.empty() && take_token())
+        {
+          send_frame(pending_.front());
+          pending_.pop_front();
+        }
+        pending_frames_ = pending_.size();
+
+        if (pending_.empty())
+        {
+          last_drain_ns_ = now_ns();
+          return;
+        }
+
+        int wait_ms = static_cast<int>(std::ceil((1.0 - tokens_) * 1000.0 / frames_per_second_));
+        pump_timer_ = loop_->setTimeout(std::max(wait_ms, 1), [this](hv::TimerID)
+                                        {
+                                          pump_timer_ = INVALID_TIMER_ID;
+                                          pump(); });
+      }
+
+      void SubscriptionManager::send_frame(const PendingFrame &frame)
+      {
+        auto time_int = std::chrono::duration_cast<std::chrono::seconds>(
+                            std::chrono::system_clock::now().time_since_epoch())
+                            .count();
+        const bool subscribe = frame.event == Event::SUBSCRIBE;
+
+        frame_buffer_.assign("{\"time\":").append(std::to_string(time_int));
+        if (frame.entries.size() == 1)
+        {
+          const CachedFrames &entry = *frame.entries.front();
+          frame_buffer_.append(subscribe ? entry.subscribe : entry.unsubscribe);
+        }
+        else
+        {
+          frame_buffer_.append(",\"channel\":\"").append(frame.channel).append(subscribe ? "\",\"event\":\"subscribe\",\"payload\":[" : "\",\"event\":\"unsubscribe\",\"payload\":[");
+          for (size_t i = 0; i < frame.entries.size(); ++i)
+          {
+            if (i)
+            {
+              frame_buffer_.push_back(',');
+            }
+            frame_buffer_.append(frame.entries[i]->token);
+          }
+          frame_buffer_.append("]}");
+        }
+
+        send_(frame_buffer_);
+        ++frames_sent_;
+        symbols_sent_ += frame.entries.size();
+      }
+
+      nlohmann::json SubscriptionManager::get_stats() const
+      {
+        int64_t first = first_request_ns_;
+        int64_t drained = last_drain_ns_;
+        return {{"active_subscriptions", active_count_.load()},
+                {"pending_frames", pending_frames_.load()},
+                {"frames_sent", frames_sent_.load()},
+                {"symbols_sent", symbols_sent_.load()},
+                {"replays", replays_.load()},
+                {"last_coverage_ms", drained >= first ? (drained - first) / 1000000 : -1}};
+      }
+
+    } // namespace gateio
+  } // namespace gateway
+} // namespace singular
@@ -0,0 +1,100 @@
+#include <openssl/ssl.h>
+
+#include "gateio/include/TlsSessionCache.h"
+
+namespace singular
+{
+  namespace gateway
+  {
+    namespace gateio
+    {
+
+      TlsSessionCache &TlsSessionCache::shared()
+      {
+        static TlsSessionCache cache;
+        return cache;
+      }
+
+      TlsSessionCache::~TlsSessionCache()
+      {
+        for (auto &[name, endpoint] : endpoints_)
+        {
+          if (endpoint.session)
+          {
+            SSL_SESSION_free(endpoint.session);
+          }
+        }
+      }
+
+      void TlsSessionCache::store(const std::string &endpoint, SSL_SESSION *session)
+      {
+        // A copy: OpenSSL marks a connection's own session unresumable when the socket is torn
+        // down without a close_notify, which is how most reconnects start
+        SSL_SESSION *copy = SSL_SESSION_dup(session);
+        if (!copy)
+        {
+          return;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        Endpoint &entry = endpoints_[endpoint];
+        if (entry.session)
+        {
+          SSL_SESSION_free(entry.session);
+        }
+        entry.session = copy;
+        ++entry.stored;
+      }
+
+      bool TlsSessionCache::apply(const std::string &endpoint, SSL *ssl)
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto found = endpoints_.find(endpoint);
+        if (found == endpoints_.end() || !found->second.session || !SSL_SESSION_is_resumable(found->second.session))
+        {
+          return false;
+        }
+        if (SSL_set_session(ssl, found->second.session) != 1)
+        {
+          return false;
+        }
+        ++found->second.offered;
+        return true;
+      }
+
+      void TlsSessionCache::record(const std::string &endpoint, bool offered, bool resumed, int64_t handshake_ns)
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Endpoint &entry = endpoints_[endpoint];
+        if (resumed)
+        {
+          ++entry.resumed;
+          entry.resumed_ns.record(static_cast<uint64_t>(handshake_ns));
+          return;
+        }
+        if (offered)
+        {
+          ++entry.rejected;
+        }
+        entry.full_ns.record(static_cast<uint64_t>(handshake_ns));
+      }
+
+      nlohmann::json TlsSessionCache::get_stats() const
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        nlohmann::json stats = nlohmann::json::object();
+        for (const auto &[name, endpoint] : endpoints_)
+        {
+          stats[name] = {{"cached", endpoint.session != nullptr},
+                         {"tickets_stored", endpoint.stored},
+                         {"offered", endpoint.offered},
+                         {"resumed", endpoint.resumed},
+                         {"rejected", endpoint.rejected},
+                         {"full_handshake_ns", endpoint.full_ns.to_json()},
+                         {"resumed_handshake_ns", endpoint.resumed_ns.to_json()}};
+        }
+        return stats;
+      }
+
+    } // namespace gateio
+  } // namespace gateway
+} // namespace singular
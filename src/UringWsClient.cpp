@@ -0,0 +1,994 @@
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/eventfd.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <openssl/err.h>
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+#include <openssl/sha.h>
+#include <openssl/ssl.h>
+
+#if __has_include(<liburing.h>)
+#include <liburing.h>
+#define GATEIO_HAVE_URING 1
+#endif
+
+#include "gateio/include/UringWsClient.h"
+#include "gateio/include/TlsSessionCache.h"
+#include "gateio/include/FeedLoop.h"
+#include <singular/network/libhv/hloop.h>
+#include <singular/utility/include/LatencyLogger.h>
+
+namespace singular
+{
+  namespace gateway
+  {
+    namespace gateio
+    {
+
+      namespace
+      {
+        constexpr uint64_t OP_CONNECT = 1;
+        constexpr uint64_t OP_READ = 2;
+        constexpr uint64_t OP_WRITE = 3;
+        constexpr unsigned READ_BUFFER_INDEX = 0;
+        constexpr unsigned WRITE_BUFFER_INDEX = 1;
+        constexpr unsigned COMPLETION_BATCH = 32;
+
+        int64_t now_ns()
+        {
+          return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                     std::chrono::steady_clock::now().time_since_epoch())
+              .count();
+        }
+
+        uint64_t user_data(uint64_t generation, uint64_t op)
+        {
+          return (generation << 8) | op;
+        }
+
+        // Value of header name (lower case) in an HTTP response head, empty when absent
+        std::string header_value(const std::string &head, const char *name)
+        {
+          const size_t name_length = std::strlen(name);
+          size_t line = head.find("\r\n");
+          while (line != std::string::npos && line + 2 < head.size())
+          {
+            line += 2;
+            const size_t line_end = std::min(head.find("\r\n", line), head.size());
+            if (line_end - line > name_length && head[line + name_length] == ':' &&
+                std::equal(name, name + name_length, head.begin() + line,
+                           [](char expected, char actual) { return expected == std::tolower(static_cast<unsigned char>(actual)); }))
+            {
+              size_t value = line + name_length + 1;
+              while (value < line_end && head[value] == ' ')
+              {
+                ++value;
+              }
+              size_t value_end = line_end;
+              while (value_end > value && head[value_end - 1] == ' ')
+              {
+                --value_end;
+              }
+              return head.substr(value, value_end - value);
+            }
+            line = head.find("\r\n", line);
+          }
+          return std::string();
+        }
+
+        // Called for every ticket the server issues; TLS 1.3 sends them after the handshake.
+        // Connections that resume sessions carry their endpoint as app data.
+        int on_new_session(SSL *ssl, SSL_SESSION *session)
+        {
+          const auto *endpoint = static_cast<const std::string *>(SSL_get_app_data(ssl));
+          if (endpoint)
+          {
+            TlsSessionCache::shared().store(*endpoint, session);
+          }
+          return 0;
+        }
+
+        // One client context per process; verification is set per connection
+        SSL_CTX *tls_context()
+        {
+          static SSL_CTX *context = []()
+          {
+            SSL_CTX *created = SSL_CTX_new(TLS_client_method());
+            SSL_CTX_set_default_verify_paths(created);
+            SSL_CTX_set_min_proto_version(created, TLS1_2_VERSION);
+            SSL_CTX_set_session_cache_mode(created, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+            // A write retried after SSL_ERROR_WANT_* may come from a grown, moved buffer
+            SSL_CTX_set_mode(created, SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+            SSL_CTX_sess_set_new_cb(created, on_new_session);
+            return created;
+          }();
+          return context;
+        }
+      }
+
+      struct UringWsClient::Ring
+      {
+#ifdef GATEIO_HAVE_URING
+        io_uring ring{};
+#endif
+        bool ready = false;
+        int event_fd = -1;
+        hio_t *watcher = nullptr;
+      };
+
+      bool UringWsClient::available()
+      {
+#ifdef GATEIO_HAVE_URING
+        static const bool supported = []()
+        {
+          io_uring probe;
+          if (io_uring_queue_init(2, &probe, 0) != 0)
+          {
+            return false;
+          }
+          io_uring_queue_exit(&probe);
+          return true;
+        }();
+        return supported;
+#else
+        return false;
+#endif
+      }
+
+      UringWsClient::UringWsClient(hv::EventLoopPtr loop, const char *url, const Options &options)
+          : loop_(std::move(loop)),
+            options_(options),
+            ring_(std::make_unique<Ring>()),
+            read_buffer_(options.read_buffer),
+            write_buffer_(options.write_buffer)
+      {
+        // wss://host[:port]/path
+        std::string rest = url ? url : "";
+        const size_t scheme_end = rest.find("://");
+        if (scheme_end != std::string::npos)
+        {
+          tls_ = rest.compare(0, scheme_end, "wss") == 0;
+          rest = rest.substr(scheme_end + 3);
+        }
+        const size_t path_start = rest.find('/');
+        path_ = path_start == std::string::npos ? "/" : rest.substr(path_start);
+        const std::string authority = rest.substr(0, path_start);
+        const size_t colon = authority.find(':');
+        host_ = authority.substr(0, colon);
+        port_ = colon == std::string::npos ? (tls_ ? "443" : "80") : authority.substr(colon + 1);
+        endpoint_ = host_ + ":" + port_;
+        RAND_bytes(reinterpret_cast<unsigned char *>(&mask_state_), sizeof(mask_state_));
+        mask_state_ |= 1;
+
+#ifdef GATEIO_HAVE_URING
+        if (io_uring_queue_init(options_.ring_entries, &ring_->ring, 0) != 0)
+        {
+          return;
+        }
+        iovec buffers[2] = {{read_buffer_.data(), read_buffer_.size()}, {write_buffer_.data(), write_buffer_.size()}};
+        ring_->event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (io_uring_register_buffers(&ring_->ring, buffers, 2) != 0 || ring_->event_fd < 0 ||
+            io_uring_register_eventfd(&ring_->ring, ring_->event_fd) != 0)
+        {
+          io_uring_queue_exit(&ring_->ring);
+          return;
+        }
+        ring_->ready = true;
+#endif
+      }
+
+      UringWsClient::~UringWsClient()
+      {
+        // Runs after every task already queued on the loop; tasks queued later see alive_ cleared
+        run_in_loop_and_wait(loop_, [this]()
+                             {
+                               *alive_ = false;
+                               teardown();
+                               // The watcher belongs to the loop and is gone once the loop has stopped
+                               if (ring_->watcher && loop_->isRunning())
+                               {
+                                 hio_set_context(ring_->watcher, nullptr);
+                                 hio_del(ring_->watcher, HV_READ);
+                               }
+                               ring_->watcher = nullptr;
+#ifdef GATEIO_HAVE_URING
+                               if (ring_->ready)
+                               {
+                                 io_uring_unregister_eventfd(&ring_->ring);
+                                 io_uring_queue_exit(&ring_->ring);
+                                 ring_->ready = false;
+                               }
+#endif
+                               if (ring_->event_fd >= 0)
+                               {
+                                 ::close(ring_->event_fd);
+                                 ring_->event_fd = -1;
+                               } });
+      }
+
+      void UringWsClient::run(OpenCallback on_open, CloseCallback on_close, MessageCallback on_message)
+      {
+        on_open_ = std::move(on_open);
+        on_close_ = std::move(on_close);
+        on_message_ = std::move(on_message);
+        loop_->runInLoop([this, alive = alive_]()
+                         {
+                           if (*alive)
+                           {
+                             start();
+                           } });
+      }
+
+      void UringWsClient::start()
+      {
+        if (state_ != State::IDLE)
+        {
+          return;
+        }
+        if (!ring_->ready)
+        {
+          fail("io_uring unavailable");
+          return;
+        }
+        if (!ring_->watcher)
+        {
+          ring_->watcher = hio_get(loop_->loop(), ring_->event_fd);
+          hio_set_context(ring_->watcher, this);
+          hio_add(ring_->watcher, &UringWsClient::on_ring_event, HV_READ);
+        }
+        if (!resolved_)
+        {
+          addrinfo hints{};
+          hints.ai_family = AF_UNSPEC;
+          hints.ai_socktype = SOCK_STREAM;
+          addrinfo *found = nullptr;
+          if (getaddrinfo(host_.c_str(), port_.c_str(), &hints, &found) != 0 || !found)
+          {
+            fail("cannot resolve " + host_);
+            return;
+          }
+          std::memcpy(&address_, found->ai_addr, found->ai_addrlen);
+          address_length_ = found->ai_addrlen;
+          freeaddrinfo(found);
+          resolved_ = true;
+        }
+
+        fd_ = ::socket(address_.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd_ < 0)
+        {
+          fail(std::string("socket: ") + std::strerror(errno));
+          return;
+        }
+        int one = 1;
+        setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        ++generation_;
+        state_ = State::CONNECTING;
+        connect_start_ns_ = now_ns();
+        phase_start_ns_ = connect_start_ns_;
+#ifdef GATEIO_HAVE_URING
+        io_uring_sqe *sqe = io_uring_get_sqe(&ring_->ring);
+        io_uring_prep_connect(sqe, fd_, reinterpret_cast<const sockaddr *>(&address_), address_length_);
+        io_uring_sqe_set_data64(sqe, user_data(generation_, OP_CONNECT));
+#endif
+        request_submit();
+      }
+
+      void UringWsClient::on_ring_event(hio_t *io)
+      {
+        auto *client = static_cast<UringWsClient *>(hio_context(io));
+        if (!client)
+        {
+          return;
+        }
+        eventfd_t count = 0;
+        eventfd_read(client->ring_->event_fd, &count);
+        ++client->wakeups_;
+        client->process_completions();
+      }
+
+      void UringWsClient::process_completions()
+      {
+#ifdef GATEIO_HAVE_URING
+        in_completion_ = true;
+        io_uring_cqe *cqes[COMPLETION_BATCH];
+        unsigned count = 0;
+        while ((count = io_uring_peek_batch_cqe(&ring_->ring, cqes, COMPLETION_BATCH)) > 0)
+        {
+          // Copied out first: handlers may queue new SQEs, never reap CQEs
+          std::pair<uint64_t, int> done[COMPLETION_BATCH];
+          for (unsigned i = 0; i < count; ++i)
+          {
+            done[i] = {cqes[i]->user_data, cqes[i]->res};
+          }
+          io_uring_cq_advance(&ring_->ring, count);
+          completions_ += count;
+          for (unsigned i = 0; i < count; ++i)
+          {
+            const uint64_t op = done[i].first & 0xff;
+            const bool current = (done[i].first >> 8) == generation_ && state_ != State::IDLE;
+            // Buffers are free again whichever socket they belonged to
+            if (op == OP_READ)
+            {
+              read_in_flight_ = false;
+            }
+            else if (op == OP_WRITE && !current)
+            {
+              write_in_flight_ = false;
+            }
+            if (!current)
+            {
+              continue;
+            }
+            if (op == OP_CONNECT)
+            {
+              on_connected(done[i].second);
+            }
+            else if (op == OP_READ)
+            {
+              on_read(done[i].second);
+            }
+            else if (op == OP_WRITE)
+            {
+              on_written(done[i].second);
+            }
+          }
+        }
+        in_completion_ = false;
+        // A reconnect may have been waiting for the old socket's buffers
+        if (state_ != State::IDLE && state_ != State::CONNECTING)
+        {
+          arm_read();
+          arm_write();
+        }
+        submit();
+#endif
+      }
+
+      void UringWsClient::on_connected(int result)
+      {
+        if (result < 0)
+        {
+          fail(std::string("connect: ") + std::strerror(-result));
+          return;
+        }
+        const int64_t now = now_ns();
+        tcp_connect_ns_ = now - phase_start_ns_;
+        phase_start_ns_ = now;
+        arm_read();
+        if (!tls_)
+        {
+          tls_handshake_ns_ = 0;
+          tls_resumed_ = false;
+          send_upgrade();
+          return;
+        }
+        ssl_ = SSL_new(tls_context());
+        rbio_ = BIO_new(BIO_s_mem());
+        wbio_ = BIO_new(BIO_s_mem());
+        SSL_set_bio(ssl_, rbio_, wbio_);
+        SSL_set_tlsext_host_name(ssl_, host_.c_str());
+        if (options_.verify_peer)
+        {
+          SSL_set_verify(ssl_, SSL_VERIFY_PEER, nullptr);
+          SSL_set1_host(ssl_, host_.c_str());
+        }
+        else
+        {
+          SSL_set_verify(ssl_, SSL_VERIFY_NONE, nullptr);
+        }
+        session_offered_ = false;
+        if (options_.resume_sessions)
+        {
+          SSL_set_app_data(ssl_, &endpoint_);
+          session_offered_ = TlsSessionCache::shared().apply(endpoint_, ssl_);
+        }
+        SSL_set_connect_state(ssl_);
+        state_ = State::TLS;
+        continue_handshake();
+      }
+
+      void UringWsClient::continue_handshake()
+      {
+        const int result = SSL_do_handshake(ssl_);
+        drain_tls_output();
+        if (result == 1)
+        {
+          const int64_t now = now_ns();
+          const bool resumed = SSL_session_reused(ssl_) == 1;
+          tls_handshake_ns_ = now - phase_start_ns_;
+          tls_resumed_ = resumed;
+          ++(resumed ? resumed_handshakes_ : full_handshakes_);
+          TlsSessionCache::shared().record(endpoint_, session_offered_, resumed, now - phase_start_ns_);
+          phase_start_ns_ = now;
+          send_upgrade();
+          return;
+        }
+        const int error = SSL_get_error(ssl_, result);
+        if (error != SSL_ERROR_WANT_READ && error != SSL_ERROR_WANT_WRITE)
+        {
+          char reason[256];
+          ERR_error_string_n(ERR_get_error(), reason, sizeof(reason));
+          fail(std::string("tls handshake: ") + reason);
+        }
+      }
+
+      void UringWsClient::send_upgrade()
+      {
+        unsigned char key[16];
+        RAND_bytes(key, sizeof(key));
+        char encoded[32];
+        EVP_EncodeBlock(reinterpret_cast<unsigned char *>(encoded), key, sizeof(key));
+        const std::string upgrade_key = encoded;
+        // The server proves it read the key by answering base64(SHA-1(key + GUID)) (RFC 6455 4.2.2)
+        const std::string accept_input = upgrade_key + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+        unsigned char digest[SHA_DIGEST_LENGTH];
+        SHA1(reinterpret_cast<const unsigned char *>(accept_input.data()), accept_input.size(), digest);
+        char accept[32];
+        EVP_EncodeBlock(reinterpret_cast<unsigned char *>(accept), digest, sizeof(digest));
+        upgrade_accept_ = accept;
+        const bool default_port = port_ == (tls_ ? "443" : "80");
+        std::string request = "GET " + path_ + " HTTP/1.1\r\n"
+                              "Host: " + host_ + (default_port ? "" : ":" + port_) + "\r\n"
+                              "Upgrade: websocket\r\n"
+                              "Connection: Upgrade\r\n"
+                              "Sec-WebSocket-Key: " + upgrade_key + "\r\n"
+                              "Sec-WebSocket-Version: 13\r\n\r\n";
+        state_ = State::UPGRADE;
+        write_plain(request.data(), request.size());
+      }
+
+      bool UringWsClient::parse_upgrade()
+      {
+        const size_t end = plain_in_.find("\r\n\r\n", plain_offset_);
+        if (end == std::string::npos)
+        {
+          return false;
+        }
+        const std::string head = plain_in_.substr(plain_offset_, end + 2 - plain_offset_);
+        const std::string status_line = head.substr(0, head.find("\r\n"));
+        plain_offset_ = end + 4;
+        if (status_line.find(" 101") == std::string::npos)
+        {
+          fail("upgrade refused: " + status_line);
+          return false;
+        }
+        if (header_value(head, "sec-websocket-accept") != upgrade_accept_)
+        {
+          fail("upgrade refused: Sec-WebSocket-Accept does not match the key");
+          return false;
+        }
+        upgrade_ns_ = now_ns() - phase_start_ns_;
+        state_ = State::OPEN;
+        open_ = true;
+        ++connects_;
+        if (on_open_)
+        {
+          on_open_(HttpResponsePtr());
+        }
+        return state_ == State::OPEN;
+      }
+
+      void UringWsClient::on_read(int result)
+      {
+        if (result <= 0)
+        {
+          fail(result == 0 ? "closed by peer" : std::string("read: ") + std::strerror(-result));
+          return;
+        }
+        ++reads_;
+        bytes_in_ += static_cast<uint64_t>(result);
+        if (tls_)
+        {
+          BIO_write(rbio_, read_buffer_.data(), result);
+        }
+        else
+        {
+          plain_in_.append(read_buffer_.data(), static_cast<size_t>(result));
+        }
+        arm_read();
+        if (state_ == State::TLS)
+        {
+          continue_handshake();
+          if (state_ != State::UPGRADE)
+          {
+            return;
+          }
+        }
+        if (tls_)
+        {
+          char plain[16384];
+          int size = 0;
+          while ((size = SSL_read(ssl_, plain, sizeof(plain))) > 0)
+          {
+            plain_in_.append(plain, static_cast<size_t>(size));
+          }
+          const int error = SSL_get_error(ssl_, size);
+          if (error == SSL_ERROR_ZERO_RETURN || (error != SSL_ERROR_WANT_READ && error != SSL_ERROR_WANT_WRITE))
+          {
+            fail("tls closed");
+            return;
+          }
+          // Session tickets and key updates may need an answer; a write waiting on them retries
+          if (!tls_out_.empty())
+          {
+            flush_tls();
+            if (state_ == State::IDLE)
+            {
+              return;
+            }
+          }
+          drain_tls_output();
+        }
+        if (state_ == State::UPGRADE && !parse_upgrade())
+        {
+          return;
+        }
+        parse_frames();
+      }
+
+      void UringWsClient::parse_frames()
+      {
+        while (state_ == State::OPEN)
+        {
+          const size_t available = plain_in_.size() - plain_offset_;
+          if (available < 2)
+          {
+            break;
+          }
+          const auto *data = reinterpret_cast<const uint8_t *>(plain_in_.data() + plain_offset_);
+          const bool fin = data[0] & 0x80;
+          const uint8_t opcode = data[0] & 0x0f;
+          const bool masked = data[1] & 0x80;
+          uint64_t length = data[1] & 0x7f;
+          size_t header = 2;
+          if (length == 126)
+          {
+            if (available < 4)
+            {
+              break;
+            }
+            length = (static_cast<uint64_t>(data[2]) << 8) | data[3];
+            header = 4;
+          }
+          else if (length == 127)
+          {
+            if (available < 10)
+            {
+              break;
+            }
+            length = 0;
+            for (int i = 0; i < 8; ++i)
+            {
+              length = (length << 8) | data[2 + i];
+            }
+            header = 10;
+          }
+          const size_t mask_offset = header;
+          header += masked ? 4 : 0;
+          if (available < header + length)
+          {
+            break;
+          }
+          std::string payload(reinterpret_cast<const char *>(data) + header, static_cast<size_t>(length));
+          if (masked)
+          {
+            for (size_t i = 0; i < payload.size(); ++i)
+            {
+              payload[i] ^= static_cast<char>(data[mask_offset + (i & 3)]);
+            }
+          }
+          plain_offset_ += header + static_cast<size_t>(length);
+
+          switch (opcode)
+          {
+          case 0x0: // continuation
+          case 0x1: // text
+          case 0x2: // binary
+            if (fin && fragment_.empty())
+            {
+              ++messages_;
+              on_message_(payload);
+            }
+            else
+            {
+              fragment_ += payload;
+              if (fin)
+              {
+                ++messages_;
+                std::string message;
+                message.swap(fragment_);
+                on_message_(message);
+              }
+            }
+            break;
+          case 0x8: // close
+            // Echo the status code, then tear down once the reply has left (see on_written)
+            send_frame(0x8, payload.data(), std::min<size_t>(payload.size(), 2));
+            if (state_ == State::OPEN)
+            {
+              state_ = State::CLOSING;
+              open_ = false;
+              finish_close();
+            }
+            return;
+          case 0x9: // ping
+            send_frame(0xA, payload.data(), payload.size());
+            break;
+          default: // pong
+            break;
+          }
+        }
+        // Compact once everything parsed has been consumed, or when the dead prefix gets large
+        if (plain_offset_ == plain_in_.size())
+        {
+          plain_in_.clear();
+          plain_offset_ = 0;
+        }
+        else if (plain_offset_ > (64 << 10))
+        {
+          plain_in_.erase(0, plain_offset_);
+          plain_offset_ = 0;
+        }
+      }
+
+      int UringWsClient::send(const std::string &frame)
+      {
+        if (!open_.load(std::memory_order_acquire))
+        {
+          return -1;
+        }
+        if (loop_->isInLoopThread())
+        {
+          send_in_loop(frame);
+        }
+        else
+        {
+          loop_->queueInLoop([this, alive = alive_, frame]()
+                             {
+                               if (*alive)
+                               {
+                                 send_in_loop(frame);
+                               } });
+        }
+        return static_cast<int>(frame.size());
+      }
+
+      void UringWsClient::send_in_loop(const std::string &frame)
+      {
+        if (state_ != State::OPEN)
+        {
+          return;
+        }
+        send_frame(0x1, frame.data(), frame.size());
+      }
+
+      void UringWsClient::send_frame(uint8_t opcode, const char *data, size_t size)
+      {
+        // Client frames are masked (RFC 6455 5.3)
+        std::string frame;
+        frame.reserve(size + 14);
+        frame.push_back(static_cast<char>(0x80 | opcode));
+        if (size < 126)
+        {
+          frame.push_back(static_cast<char>(0x80 | size));
+        }
+        else if (size <= 0xffff)
+        {
+          frame.push_back(static_cast<char>(0x80 | 126));
+          frame.push_back(static_cast<char>(size >> 8));
+          frame.push_back(static_cast<char>(size & 0xff));
+        }
+        else
+        {
+          frame.push_back(static_cast<char>(0x80 | 127));
+          for (int i = 7; i >= 0; --i)
+          {
+            frame.push_back(static_cast<char>((static_cast<uint64_t>(size) >> (8 * i)) & 0xff));
+          }
+        }
+        mask_state_ ^= mask_state_ << 13;
+        mask_state_ ^= mask_state_ >> 7;
+        mask_state_ ^= mask_state_ << 17;
+        char mask[4];
+        std::memcpy(mask, &mask_state_, sizeof(mask));
+        frame.append(mask, sizeof(mask));
+        const size_t payload_start = frame.size();
+        frame.append(data, size);
+        for (size_t i = 0; i < size; ++i)
+        {
+          frame[payload_start + i] ^= mask[i & 3];
+        }
+        ++frames_out_;
+        write_plain(frame.data(), frame.size());
+      }
+
+      void UringWsClient::write_plain(const char *data, size_t size)
+      {
+        if (!tls_)
+        {
+          pending_out_.append(data, size);
+          arm_write();
+          return;
+        }
+        if (tls_out_.empty())
+        {
+          const int written = SSL_write(ssl_, data, static_cast<int>(size));
+          if (written > 0)
+          {
+            drain_tls_output();
+            return;
+          }
+          if (!tls_write_blocked(written))
+          {
+            return;
+          }
+        }
+        // Waits behind the write OpenSSL could not take yet, so frames keep their order
+        tls_out_.append(data, size);
+      }
+
+      void UringWsClient::flush_tls()
+      {
+        while (!tls_out_.empty())
+        {
+          const int written = SSL_write(ssl_, tls_out_.data(), static_cast<int>(tls_out_.size()));
+          if (written <= 0)
+          {
+            tls_write_blocked(written);
+            return;
+          }
+          tls_out_.erase(0, static_cast<size_t>(written));
+        }
+        drain_tls_output();
+      }
+
+      bool UringWsClient::tls_write_blocked(int result)
+      {
+        const int error = SSL_get_error(ssl_, result);
+        // Records OpenSSL produced before it stopped, e.g. a renegotiation, still go out
+        drain_tls_output();
+        if (error == SSL_ERROR_WANT_READ || error == SSL_ERROR_WANT_WRITE)
+        {
+          ++tls_write_retries_;
+          return true;
+        }
+        char reason[256];
+        ERR_error_string_n(ERR_get_error(), reason, sizeof(reason));
+        fail(std::string("tls write: ") + reason);
+        return false;
+      }
+
+      void UringWsClient::drain_tls_output()
+      {
+        char chunk[16384];
+        int size = 0;
+        while ((size = BIO_read(wbio_, chunk, sizeof(chunk))) > 0)
+        {
+          pending_out_.append(chunk, static_cast<size_t>(size));
+        }
+        arm_write();
+      }
+
+      void UringWsClient::arm_read()
+      {
+#ifdef GATEIO_HAVE_URING
+        if (read_in_flight_ || fd_ < 0)
+        {
+          return;
+        }
+        io_uring_sqe *sqe = io_uring_get_sqe(&ring_->ring);
+        if (!sqe)
+        {
+          submit();
+          sqe = io_uring_get_sqe(&ring_->ring);
+        }
+        io_uring_prep_read_fixed(sqe, fd_, read_buffer_.data(), static_cast<unsigned>(read_buffer_.size()), 0, READ_BUFFER_INDEX);
+        io_uring_sqe_set_data64(sqe, user_data(generation_, OP_READ));
+        read_in_flight_ = true;
+        request_submit();
+#endif
+      }
+
+      void UringWsClient::arm_write()
+      {
+#ifdef GATEIO_HAVE_URING
+        if (write_in_flight_ || fd_ < 0)
+        {
+          return;
+        }
+        if (write_offset_ == write_length_)
+        {
+          if (pending_out_.empty())
+          {
+            return;
+          }
+          // Everything queued since the last write goes out in one
+          write_length_ = std::min(pending_out_.size(), write_buffer_.size());
+          std::memcpy(write_buffer_.data(), pending_out_.data(), write_length_);
+          pending_out_.erase(0, write_length_);
+          write_offset_ = 0;
+        }
+        io_uring_sqe *sqe = io_uring_get_sqe(&ring_->ring);
+        if (!sqe)
+        {
+          submit();
+          sqe = io_uring_get_sqe(&ring_->ring);
+        }
+        io_uring_prep_write_fixed(sqe, fd_, write_buffer_.data() + write_offset_, static_cast<unsigned>(write_length_ - write_offset_), 0, WRITE_BUFFER_INDEX);
+        io_uring_sqe_set_data64(sqe, user_data(generation_, OP_WRITE));
+        write_in_flight_ = true;
+        request_submit();
+#endif
+      }
+
+      void UringWsClient::on_written(int result)
+      {
+        write_in_flight_ = false;
+        if (result < 0)
+        {
+          fail(std::string("write: ") + std::strerror(-result));
+          return;
+        }
+        ++writes_;
+        bytes_out_ += static_cast<uint64_t>(result);
+        write_offset_ += static_cast<size_t>(result);
+        if (write_offset_ < write_length_)
+        {
+          ++short_writes_;
+        }
+        arm_write();
+        if (state_ == State::CLOSING)
+        {
+          finish_close();
+        }
+      }
+
+      void UringWsClient::finish_close()
+      {
+        if (!write_in_flight_ && write_offset_ == write_length_ && pending_out_.empty() && tls_out_.empty())
+        {
+          fail("close frame");
+        }
+      }
+
+      void UringWsClient::request_submit()
+      {
+        // Completion handlers submit once at the end of the batch; anything else once per loop iteration
+        if (in_completion_ || submit_queued_)
+        {
+          return;
+        }
+        submit_queued_ = true;
+        loop_->queueInLoop([this, alive = alive_]()
+                           {
+                             if (*alive)
+                             {
+                               submit_queued_ = false;
+                               submit();
+                             } });
+      }
+
+      void UringWsClient::submit()
+      {
+#ifdef GATEIO_HAVE_URING
+        if (io_uring_sq_ready(&ring_->ring) == 0)
+        {
+          return;
+        }
+        ++submits_;
+        io_uring_submit(&ring_->ring);
+#endif
+      }
+
+      void UringWsClient::close()
+      {
+        loop_->runInLoop([this, alive = alive_]()
+                         {
+                           if (*alive && state_ != State::IDLE)
+                           {
+                             fail("closed");
+                           } });
+      }
+
+      void UringWsClient::teardown()
+      {
+        if (fd_ >= 0)
+        {
+          // Outstanding operations complete with an error and are dropped by generation
+          ::shutdown(fd_, SHUT_RDWR);
+          ::close(fd_);
+          fd_ = -1;
+        }
+        if (ssl_)
+        {
+          SSL_free(ssl_);
+          ssl_ = nullptr;
+          rbio_ = nullptr;
+          wbio_ = nullptr;
+        }
+        pending_out_.clear();
+        tls_out_.clear();
+        plain_in_.clear();
+        plain_offset_ = 0;
+        fragment_.clear();
+        write_length_ = 0;
+        write_offset_ = 0;
+        state_ = State::IDLE;
+        open_ = false;
+      }
+
+      void UringWsClient::fail(const std::string &reason)
+      {
+        const bool was_running = state_ != State::IDLE || fd_ >= 0;
+        if (reason != "closed")
+        {
+          ++failures_;
+          singular::utility::log_event("GATEIO", singular::utility::OEMSEvent::WS_CONNECTION_ERROR, "io_uring client " + host_ + ": " + reason);
+        }
+        teardown();
+        // Like the epoll client, a failed connect also reports a close so reconnects kick in
+        if ((was_running || reason != "closed") && on_close_)
+        {
+          on_close_();
+        }
+      }
+
+      WsClient::ConnectInfo UringWsClient::last_connect() const
+      {
+        ConnectInfo info;
+        if (connects_.load() == 0)
+        {
+          return info;
+        }
+        info.tcp_ns = tcp_connect_ns_.load();
+        info.tls_ns = tls_handshake_ns_.load();
+        info.upgrade_ns = upgrade_ns_.load();
+        info.resumed = tls_resumed_.load();
+        return info;
+      }
+
+      nlohmann::json UringWsClient::get_stats() const
+      {
+        const uint64_t wakeups = wakeups_.load();
+        const uint64_t submits = submits_.load();
+        const uint64_t messages = messages_.load();
+        const uint64_t frames = frames_out_.load();
+        nlohmann::json stats;
+        stats["transport"] = transport();
+        stats["host"] = host_;
+        stats["connects"] = connects_.load();
+        stats["failures"] = failures_.load();
+        stats["messages_in"] = messages;
+        stats["frames_out"] = frames;
+        stats["bytes_in"] = bytes_in_.load();
+        stats["bytes_out"] = bytes_out_.load();
+        stats["reads"] = reads_.load();
+        stats["writes"] = writes_.load();
+        stats["short_writes"] = short_writes_.load();
+        stats["tls_write_retries"] = tls_write_retries_.load();
+        stats["submits"] = submits;
+        stats["wakeups"] = wakeups;
+        stats["completions"] = completions_.load();
+        stats["completions_per_wakeup"] = wakeups ? static_cast<double>(completions_.load()) / wakeups : 0.0;
+        // io_uring_enter plus the eventfd read of each wakeup, per frame moved in either direction
+        stats["syscalls_per_frame"] = messages + frames ? static_cast<double>(submits + wakeups) / (messages + frames) : 0.0;
+        stats["last_connect"] = {{"tcp_ns", tcp_connect_ns_.load()},
+                                 {"tls_ns", tls_handshake_ns_.load()},
+                                 {"upgrade_ns", upgrade_ns_.load()},
+                                 {"tls_resumed", tls_resumed_.load()}};
+        stats["tls_resumed"] = resumed_handshakes_.load();
+        stats["tls_full"] = full_handshakes_.load();
+        return stats;
+      }
+
+    } // namespace gateio
+  } // namespace gateway
+} // namespace singular
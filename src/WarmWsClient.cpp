@@ -0,0 +1,300 @@
+#include <chrono>
+
+#include "gateio/include/WarmWsClient.h"
+#include "gateio/include/FeedLoop.h"
+#include <singular/utility/include/LatencyLogger.h>
+
+namespace singular
+{
+  namespace gateway
+  {
+    namespace gateio
+    {
+
+      namespace
+      {
+        int64_t now_ns()
+        {
+          return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                     std::chrono::steady_clock::now().time_since_epoch())
+              .count();
+        }
+      }
+
+      WarmWsClient::WarmWsClient(hv::EventLoopPtr loop, const std::string &name, std::vector<std::unique_ptr<WsClient>> sockets,
+                                 const Options &options)
+          : loop_(std::move(loop)),
+            name_(name),
+            options_(options),
+            sockets_(sockets.size())
+      {
+        for (size_t i = 0; i < sockets.size(); ++i)
+        {
+          sockets_[i].client = std::move(sockets[i]);
+        }
+        active_ = sockets_.front().client.get();
+      }
+
+      WarmWsClient::~WarmWsClient()
+      {
+        // Timers are killed on the loop, after every task already queued there; the sockets
+        // then tear themselves down without reporting a close
+        run_in_loop_and_wait(loop_, [this]()
+                             {
+                               *alive_ = false;
+                               stopping_ = true;
+                               if (keepalive_timer_ != INVALID_TIMER_ID)
+                               {
+                                 loop_->killTimer(keepalive_timer_);
+                                 keepalive_timer_ = INVALID_TIMER_ID;
+                               }
+                               for (auto &socket : sockets_)
+                               {
+                                 if (socket.retry_timer != INVALID_TIMER_ID)
+                                 {
+                                   loop_->killTimer(socket.retry_timer);
+                                   socket.retry_timer = INVALID_TIMER_ID;
+                                 }
+                               } });
+      }
+
+      void WarmWsClient::run(OpenCallback on_open, CloseCallback on_close, MessageCallback on_message)
+      {
+        on_open_ = std::move(on_open);
+        on_close_ = std::move(on_close);
+        on_message_ = std::move(on_message);
+        loop_->runInLoop([this, alive = alive_]()
+                         {
+                           if (!*alive)
+                           {
+                             return;
+                           }
+                           stopping_ = false;
+                           // Reconnects only restart what is down; open standbys stay as they are
+                           for (size_t i = 0; i < sockets_.size(); ++i)
+                           {
+                             if (!sockets_[i].running)
+                             {
+                               start(i);
+                             }
+                           }
+                           if (options_.keepalive_ms > 0 && keepalive_timer_ == INVALID_TIMER_ID)
+                           {
+                             keepalive_timer_ = loop_->setInterval(options_.keepalive_ms, [this](hv::TimerID)
+                                                                   { keepalive(); });
+                           } });
+      }
+
+      void WarmWsClient::start(size_t index)
+      {
+        Socket &socket = sockets_[index];
+        if (socket.retry_timer != INVALID_TIMER_ID)
+        {
+          loop_->killTimer(socket.retry_timer);
+          socket.retry_timer = INVALID_TIMER_ID;
+        }
+        socket.running = true;
+        socket.client->run(
+            [this, index](const HttpResponsePtr &response)
+            { on_socket_open(index, response); },
+            [this, index]()
+            { on_socket_close(index); },
+            [this, index](const std::string &frame)
+            { on_socket_message(index, frame); });
+      }
+
+      void WarmWsClient::schedule_retry(size_t index)
+      {
+        Socket &socket = sockets_[index];
+        if (stopping_ || socket.running || socket.retry_timer != INVALID_TIMER_ID)
+        {
+          return;
+        }
+        socket.retry_timer = loop_->setTimeout(options_.retry_ms, [this, index](hv::TimerID)
+                                               {
+                                                 sockets_[index].retry_timer = INVALID_TIMER_ID;
+                                                 if (!stopping_ && !sockets_[index].running)
+                                                 {
+                                                   start(index);
+                                                 } });
+      }
+
+      void WarmWsClient::on_socket_open(size_t index, const HttpResponsePtr &response)
+      {
+        Socket &socket = sockets_[index];
+        if (stopping_)
+        {
+          socket.client->close();
+          return;
+        }
+        socket.open = true;
+        socket.last_frame_ns = now_ns();
+        if (index == active_index_)
+        {
+          on_open_(response);
+          return;
+        }
+        ++standby_connects_;
+        ++standbys_open_;
+        // The connection is down and waiting for a reconnect: the first socket up takes over
+        if (!sockets_[active_index_].open)
+        {
+          const size_t previous = active_index_;
+          promote();
+          on_open_(response);
+          schedule_retry(previous);
+        }
+      }
+
+      void WarmWsClient::on_socket_close(size_t index)
+      {
+        Socket &socket = sockets_[index];
+        const bool was_open = socket.open;
+        socket.open = false;
+        socket.running = false;
+        if (index != active_index_)
+        {
+          if (was_open)
+          {
+            --standbys_open_;
+            ++standby_closes_;
+          }
+          schedule_retry(index);
+          return;
+        }
+        if (!stopping_ && promote())
+        {
+          on_close_();
+          on_open_(HttpResponsePtr());
+          schedule_retry(index);
+          return;
+        }
+        on_close_();
+      }
+
+      void WarmWsClient::on_socket_message(size_t index, const std::string &frame)
+      {
+        if (index == active_index_)
+        {
+          on_message_(frame);
+          return;
+        }
+        // Keepalive pongs and anything else a standby receives before it is promoted
+        sockets_[index].last_frame_ns = now_ns();
+        ++standby_frames_;
+      }
+
+      bool WarmWsClient::promote()
+      {
+        for (size_t i = 0; i < sockets_.size(); ++i)
+        {
+          if (i != active_index_ && sockets_[i].open)
+          {
+            active_index_ = i;
+            active_.store(sockets_[i].client.get(), std::memory_order_release);
+            --standbys_open_;
+            ++promotions_;
+            singular::utility::log_event("GATEIO", singular::utility::OEMSEvent::WS_CONNECTION_DEBUG,
+                                         name_ + " promoted standby socket " + std::to_string(i));
+            return true;
+          }
+        }
+        return false;
+      }
+
+      void WarmWsClient::drop()
+      {
+        loop_->runInLoop([this, alive = alive_]()
+                         {
+                           if (!*alive || stopping_)
+                           {
+                             return;
+                           }
+                           // Switch first; the old socket's close then arrives as a standby close
+                           const size_t previous = active_index_;
+                           if (!sockets_[previous].open || !promote())
+                           {
+                             sockets_[previous].client->close();
+                             return;
+                           }
+                           ++standbys_open_;
+                           on_close_();
+                           on_open_(HttpResponsePtr());
+                           sockets_[previous].client->close(); });
+      }
+
+      void WarmWsClient::close()
+      {
+        loop_->runInLoop([this, alive = alive_]()
+                         {
+                           if (!*alive)
+                           {
+                             return;
+                           }
+                           stopping_ = true;
+                           if (keepalive_timer_ != INVALID_TIMER_ID)
+                           {
+                             loop_->killTimer(keepalive_timer_);
+                             keepalive_timer_ = INVALID_TIMER_ID;
+                           }
+                           for (auto &socket : sockets_)
+                           {
+                             if (socket.retry_timer != INVALID_TIMER_ID)
+                             {
+                               loop_->killTimer(socket.retry_timer);
+                               socket.retry_timer = INVALID_TIMER_ID;
+                             }
+                             if (socket.running)
+                             {
+                               socket.client->close();
+                             }
+                           } });
+      }
+
+      void WarmWsClient::keepalive()
+      {
+        const int64_t now = now_ns();
+        const int64_t silence_ns = 3 * static_cast<int64_t>(options_.keepalive_ms) * 1000000;
+        const std::string frame = "{\"time\":" + std::to_string(std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count()) +
+                                  ",\"channel\":\"" + options_.ping_channel + "\"}";
+        for (size_t i = 0; i < sockets_.size(); ++i)
+        {
+          Socket &socket = sockets_[i];
+          if (i == active_index_ || !socket.open)
+          {
+            continue;
+          }
+          if (now - socket.last_frame_ns > silence_ns)
+          {
+            ++standby_silent_;
+            socket.client->close();
+            continue;
+          }
+          socket.client->send(frame);
+        }
+      }
+
+      nlohmann::json WarmWsClient::get_stats() const
+      {
+        const WsClient *active = active_.load(std::memory_order_acquire);
+        nlohmann::json stats = active->get_stats();
+        stats["standbys"] = sockets_.size() - 1;
+        stats["standbys_open"] = standbys_open_.load();
+        stats["promotions"] = promotions_.load();
+        stats["standby_connects"] = standby_connects_.load();
+        stats["standby_closes"] = standby_closes_.load();
+        stats["standby_silent"] = standby_silent_.load();
+        stats["standby_frames"] = standby_frames_.load();
+        stats["sockets"] = nlohmann::json::array();
+        for (const auto &socket : sockets_)
+        {
+          nlohmann::json entry = socket.client->get_stats();
+          entry["active"] = socket.client.get() == active;
+          stats["sockets"].push_back(entry);
+        }
+        return stats;
+      }
+
+    } // namespace gateio
+  } // namespace gateway
+} // namespace singular
@@ -0,0 +1,83 @@
+#include <algorithm>
+
+#include "gateio/include/WsClient.h"
+#include "gateio/include/Config.h"
+#include "gateio/include/UringWsClient.h"
+#include "gateio/include/WarmWsClient.h"
+#include <singular/utility/include/LatencyLogger.h>
+
+namespace singular
+{
+  namespace gateway
+  {
+    namespace gateio
+    {
+
+      namespace
+      {
+        std::unique_ptr<WsClient> make_socket(hv::EventLoopPtr loop, const char *url, const std::string &name)
+        {
+          if (WsClient::uring_selected(name))
+          {
+            if (UringWsClient::available())
+            {
+              UringWsClient::Options options;
+              options.verify_peer = env_flag("GATEIO_TLS_VERIFY", true);
+              options.resume_sessions = env_flag("GATEIO_TLS_SESSION_CACHE", true);
+              return std::make_unique<UringWsClient>(std::move(loop), url, options);
+            }
+            singular::utility::log_event("GATEIO", singular::utility::OEMSEvent::WS_CONNECTION_ERROR,
+                                         "io_uring is not available, " + name + " uses the epoll client");
+          }
+          return std::make_unique<HvWsClient>(std::move(loop), url);
+        }
+      }
+
+      bool WsClient::listed(const std::string &list, const std::string &name)
+      {
+        size_t begin = 0;
+        while (begin < list.size())
+        {
+          size_t end = list.find(',', begin);
+          if (end == std::string::npos)
+          {
+            end = list.size();
+          }
+          const std::string entry = list.substr(begin, end - begin);
+          if (entry == "all" || entry == name || (name.compare(0, entry.size(), entry) == 0 && name.size() > entry.size() && name[entry.size()] == '#'))
+          {
+            return true;
+          }
+          begin = end + 1;
+        }
+        return false;
+      }
+
+      bool WsClient::uring_selected(const std::string &name)
+      {
+        return listed(env_string("GATEIO_URING_CONNECTIONS", ""), name);
+      }
+
+      std::unique_ptr<WsClient> WsClient::create(hv::EventLoopPtr loop, const char *url, const std::string &name,
+                                                 const std::string &ping_channel)
+      {
+        if (!listed(env_string("GATEIO_WARM_STANDBY", ""), name))
+        {
+          return make_socket(std::move(loop), url, name);
+        }
+        // The active socket plus its standbys, all on the connection's loop
+        const size_t standbys = static_cast<size_t>(std::max<long>(env_long("GATEIO_WARM_STANDBY_SOCKETS", 1), 1));
+        std::vector<std::unique_ptr<WsClient>> sockets;
+        for (size_t i = 0; i <= standbys; ++i)
+        {
+          sockets.push_back(make_socket(loop, url, name));
+        }
+        WarmWsClient::Options options;
+        options.ping_channel = ping_channel;
+        options.keepalive_ms = static_cast<int>(env_long("GATEIO_PING_INTERVAL_MS", 5000));
+        return std::make_unique<WarmWsClient>(std::move(loop), name, std::move(sockets), options);
+      }
+
+    } // namespace gateio
+  } // namespace gateway
+} // namespace singular
@@ -20,6 +20,7 @@
 #include <singular/network/include/WebSocketServer.h>
 #include <singular/network/include/WebSocketChannel.h>
 #include <singular/network/include/GlobalWebsocket.h>
+#include <singular/network/libhv/EventLoopThread.h>
 
 // #include <singular/utility/include/LatencyMeasure.h>
 #include <singular/utility/include/LatencyManager.h>
@@ -34,6 +35,10 @@
 #include <system/include/Engine.h>
 #include <system/include/OrderbookManagementSystem.h>
 
+// gateio
+#include "gateio/include/InstrumentCatalog.h"
+#include "gateio/include/Config.h"
+
 using namespace hv;
 
 bool cpupin(int cpuid)
@@ -224,6 +229,9 @@ bool get_gateio_futures_instruments(nlohmann::json &result, hv::HttpClient &clie
                     instrument_config["contract_multiplier"] = std::stod(static_cast<std::string>(it["quanto_multiplier"]));
                     instrument_config["base"] = bq[0];
                     instrument_config["quote"] = bq[1];
+                    instrument_config["settle"] = future_type[iter];
+                    instrument_config["funding_interval"] = it.value("funding_interval", 28800);
+                    instrument_config["funding_next_apply"] = it.value("funding_next_apply", 0);
 
                     result["instruments"].push_back(instrument_config);
                 }
@@ -315,6 +323,7 @@ bool get_gateio_delivery_instruments(nlohmann::json &result, hv::HttpClient &cli
                 instrument_config["contract_multiplier"] = std::stod(static_cast<std::string>(it["quanto_multiplier"]));
                 instrument_config["base"] = bq[0];
                 instrument_config["quote"] = bq[1];
+                instrument_config["settle"] = "usdt";
 
                 result["instruments"].push_back(instrument_config);
             }
@@ -493,6 +502,8 @@ bool get_gateio_instruments()
     if(result.contains("instruments")){
         //(*config_map)["instruments"]["GATEIOUSDT"] = result["instruments"];
         //applyConfigFromMap(result);
+        // The gateway takes settle currency, base and quote from here instead of parsing names
+        singular::gateway::gateio::InstrumentCatalog::instance().load(result["instruments"]);
     }
 
     if(spot && futures && delivery && options){
@@ -513,24 +524,22 @@ int main(int argc, char **argv)
 
     singular::utility::LatencyManager::initialize(3.50);
     // test_db_connection();
-    // Create a new thread that runs the syncWithNTP function at fixed intervals
-    auto ntp_thread = std::thread(syncWithNTP, std::chrono::seconds(60));
-
-    // Detach the NTP synchronization thread
-    ntp_thread.detach();
-
-    // Prevent main from exiting immediately
-    std::this_thread::sleep_for(std::chrono::seconds(1));
+    // Exchange clock offset and feed latency are estimated per connection by the gateway
+    // (get_clock_stats), so stepping the host clock with chronyd is opt-in
+    if (singular::gateway::gateio::env_flag("GATEIO_CHRONY_SYNC", false))
+    {
+        auto ntp_thread = std::thread(syncWithNTP, std::chrono::seconds(singular::gateway::gateio::env_long("GATEIO_CHRONY_SYNC_INTERVAL_S", 60)));
+        ntp_thread.detach();
+    }
 
     hv::EventLoopPtr executor(new hv::EventLoop);
 
-    auto executor_thread = std::thread([&executor]()
-                                       {
+    // Returns once the executor loop is running, instead of sleeping and hoping it is
+    hv::EventLoopThread executor_thread(executor);
+    executor_thread.start(true, []()
+                          {
         cpupin(1);
-        executor->run(); });
-
-    executor_thread.detach();
-    std::this_thread::sleep_for(std::chrono::seconds(1));
+        return 0; });
 
     // Initialize the Engine without the static configuration file
     goquant::system::Engine engine(executor);
@@ -0,0 +1,490 @@
+// Websocket transport comparison: libhv epoll client vs the io_uring client
+// (see GATEIO_URING_CONNECTIONS).
+//
+//   gateio_transport_bench [--messages N] [--size BYTES] [--window N] [--connects N] [--cpu N]
+//                          [--transport epoll|io_uring|both]
+//
+// Starts a local TLS websocket echo server with a throwaway self-signed certificate, then
+// runs each client against it on a FeedLoop, as the gateway does: one round with a single
+// message in flight for RTT percentiles, one with --window messages in flight for
+// throughput, and --connects close/reconnect cycles for connect time. The io_uring client
+// runs the reconnect round twice, with full handshakes and with TLS session resumption.
+// Prints every round and the client's own stats as JSON. No network access is needed; the
+// server runs on 127.0.0.1 with one thread per connection.
+
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include <openssl/evp.h>
+#include <openssl/sha.h>
+#include <openssl/ssl.h>
+#include <openssl/x509.h>
+
+#include "gateio/include/FeedLoop.h"
+#include "gateio/include/LatencyHistogram.h"
+#include "gateio/include/TlsSessionCache.h"
+#include "gateio/include/UringWsClient.h"
+#include "gateio/include/WsClient.h"
+
+namespace
+{
+  using namespace singular::gateway::gateio;
+
+  int64_t now_ns()
+  {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+  }
+
+  void usage(const char *program)
+  {
+    std::fprintf(stderr, "usage: %s [--messages N] [--size BYTES] [--window N] [--connects N] [--cpu N] [--transport epoll|io_uring|both]\n", program);
+  }
+
+  // Self-signed P-256 certificate for 127.0.0.1, valid for a day
+  SSL_CTX *server_context()
+  {
+    EVP_PKEY *key = EVP_EC_gen("P-256");
+    X509 *certificate = X509_new();
+    ASN1_INTEGER_set(X509_get_serialNumber(certificate), 1);
+    X509_gmtime_adj(X509_getm_notBefore(certificate), 0);
+    X509_gmtime_adj(X509_getm_notAfter(certificate), 24 * 3600);
+    X509_set_pubkey(certificate, key);
+    X509_NAME *subject = X509_get_subject_name(certificate);
+    X509_NAME_add_entry_by_txt(subject, "CN", MBSTRING_ASC, reinterpret_cast<const unsigned char *>("127.0.0.1"), -1, -1, 0);
+    X509_set_issuer_name(certificate, subject);
+    X509_sign(certificate, key, EVP_sha256());
+
+    SSL_CTX *context = SSL_CTX_new(TLS_server_method());
+    SSL_CTX_use_certificate(context, certificate);
+    SSL_CTX_use_PrivateKey(context, key);
+    X509_free(certificate);
+    EVP_PKEY_free(key);
+    return context;
+  }
+
+  // Reads exactly size bytes, buffering whatever SSL_read returns beyond them
+  bool read_exact(SSL *ssl, std::string &buffer, size_t size)
+  {
+    char chunk[16384];
+    while (buffer.size() < size)
+    {
+      int read = SSL_read(ssl, chunk, sizeof(chunk));
+      if (read <= 0)
+      {
+        return false;
+      }
+      buffer.append(chunk, static_cast<size_t>(read));
+    }
+    return true;
+  }
+
+  void serve(SSL_CTX *context, int fd)
+  {
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    SSL *ssl = SSL_new(context);
+    SSL_set_fd(ssl, fd);
+    std::string buffer;
+    if (SSL_accept(ssl) == 1)
+    {
+      char chunk[4096];
+      size_t end = std::string::npos;
+      while ((end = buffer.find("\r\n\r\n")) == std::string::npos)
+      {
+        int read = SSL_read(ssl, chunk, sizeof(chunk));
+        if (read <= 0)
+        {
+          break;
+        }
+        buffer.append(chunk, static_cast<size_t>(read));
+      }
+      const size_t key_start = buffer.find("Sec-WebSocket-Key: ");
+      if (end != std::string::npos && key_start != std::string::npos)
+      {
+        std::string key = buffer.substr(key_start + 19, buffer.find("\r\n", key_start) - key_start - 19);
+        key += "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+        unsigned char digest[SHA_DIGEST_LENGTH];
+        SHA1(reinterpret_cast<const unsigned char *>(key.data()), key.size(), digest);
+        char accept[64];
+        EVP_EncodeBlock(reinterpret_cast<unsigned char *>(accept), digest, sizeof(digest));
+        const std::string response = std::string("HTTP/1.1 101 Switching Protocols\r\n"
+                                                 "Upgrade: websocket\r\nConnection: Upgrade\r\n"
+                                                 "Sec-WebSocket-Accept: ") +
+                                     accept + "\r\n\r\n";
+        SSL_write(ssl, response.data(), static_cast<int>(response.size()));
+        buffer.erase(0, end + 4);
+
+        // Echo every data frame back unmasked, as a server sends them
+        while (read_exact(ssl, buffer, 2))
+        {
+          const uint8_t opcode = buffer[0] & 0x0f;
+          uint64_t length = buffer[1] & 0x7f;
+          size_t header = 2;
+          if (length == 126)
+          {
+            if (!read_exact(ssl, buffer, 4))
+            {
+              break;
+            }
+            length = (static_cast<uint8_t>(buffer[2]) << 8) | static_cast<uint8_t>(buffer[3]);
+            header = 4;
+          }
+          else if (length == 127)
+          {
+            if (!read_exact(ssl, buffer, 10))
+            {
+              break;
+            }
+            length = 0;
+            for (int i = 0; i < 8; ++i)
+            {
+              length = (length << 8) | static_cast<uint8_t>(buffer[2 + i]);
+            }
+            header = 10;
+          }
+          if (!read_exact(ssl, buffer, header + 4 + length))
+          {
+            break;
+          }
+          const char *mask = buffer.data() + header;
+          std::string frame = buffer.substr(0, header);
+          frame[1] = static_cast<char>(frame[1] & 0x7f);
+          for (size_t i = 0; i < length; ++i)
+          {
+            frame.push_back(static_cast<char>(buffer[header + 4 + i] ^ mask[i & 3]));
+          }
+          buffer.erase(0, header + 4 + length);
+          if (opcode == 0x8)
+          {
+            break;
+          }
+          SSL_write(ssl, frame.data(), static_cast<int>(frame.size()));
+        }
+      }
+    }
+    SSL_shutdown(ssl);
+    SSL_free(ssl);
+    ::close(fd);
+  }
+
+  struct Round
+  {
+    LatencyHistogram rtt;
+    int64_t elapsed_ns = 0;
+    size_t received = 0;
+  };
+
+  // Sends messages with window frames in flight; every echo sends the next one
+  bool run_round(WsClient &client, size_t messages, size_t size, size_t window, Round &round)
+  {
+    std::mutex mutex;
+    std::condition_variable done;
+    std::vector<int64_t> sent_ns(messages, 0);
+    std::atomic<size_t> next{0};
+    std::atomic<size_t> received{0};
+    std::string padding(size > 16 ? size - 16 : 0, 'x');
+
+    auto send_next = [&]()
+    {
+      const size_t index = next.fetch_add(1);
+      if (index >= messages)
+      {
+        return;
+      }
+      char prefix[17];
+      std::snprintf(prefix, sizeof(prefix), "%015zu:", index);
+      sent_ns[index] = now_ns();
+      client.send(prefix + padding);
+    };
+
+    auto on_message = [&](const std::string &frame)
+    {
+      const size_t index = static_cast<size_t>(std::strtoull(frame.c_str(), nullptr, 10));
+      if (index < messages)
+      {
+        round.rtt.record(static_cast<uint64_t>(now_ns() - sent_ns[index]));
+      }
+      send_next();
+      if (received.fetch_add(1) + 1 == messages)
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        done.notify_all();
+      }
+    };
+
+    std::atomic<bool> open{false};
+    std::atomic<bool> closed{false};
+    client.run([&](const HttpResponsePtr &)
+               {
+                 std::lock_guard<std::mutex> lock(mutex);
+                 open = true;
+                 done.notify_all(); },
+               [&]()
+               {
+                 std::lock_guard<std::mutex> lock(mutex);
+                 closed = true;
+                 done.notify_all(); },
+               on_message);
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      if (!done.wait_for(lock, std::chrono::seconds(10), [&]() { return open || closed; }) || !open)
+      {
+        return false;
+      }
+    }
+
+    const int64_t start = now_ns();
+    for (size_t i = 0; i < window; ++i)
+    {
+      send_next();
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    const bool finished = done.wait_for(lock, std::chrono::seconds(60), [&]()
+                                        { return received.load() >= messages || closed; });
+    round.elapsed_ns = now_ns() - start;
+    round.received = received.load();
+    lock.unlock();
+    // The callbacks use this frame, so wait for the close before returning
+    client.close();
+    lock.lock();
+    done.wait_for(lock, std::chrono::seconds(5), [&]()
+                  { return closed.load(); });
+    return finished && round.received >= messages;
+  }
+
+  // Opens and closes the client connects times; run() to open is the reconnect's connect time
+  nlohmann::json run_reconnects(WsClient &client, size_t connects)
+  {
+    std::mutex mutex;
+    std::condition_variable changed;
+    bool open = false;
+    bool closed = false;
+    LatencyHistogram open_ns;
+    LatencyHistogram tls_ns;
+    size_t resumed = 0;
+    size_t failed = 0;
+    for (size_t i = 0; i < connects; ++i)
+    {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        open = false;
+        closed = false;
+      }
+      const int64_t start = now_ns();
+      client.run([&](const HttpResponsePtr &)
+                 {
+                   std::lock_guard<std::mutex> lock(mutex);
+                   open = true;
+                   changed.notify_all(); },
+                 [&]()
+                 {
+                   std::lock_guard<std::mutex> lock(mutex);
+                   closed = true;
+                   changed.notify_all(); },
+                 [](const std::string &) {});
+      std::unique_lock<std::mutex> lock(mutex);
+      changed.wait_for(lock, std::chrono::seconds(10), [&]()
+                       { return open || closed; });
+      if (!open)
+      {
+        ++failed;
+        continue;
+      }
+      open_ns.record(static_cast<uint64_t>(now_ns() - start));
+      const WsClient::ConnectInfo info = client.last_connect();
+      if (info.tls_ns >= 0)
+      {
+        tls_ns.record(static_cast<uint64_t>(info.tls_ns));
+        resumed += info.resumed ? 1 : 0;
+      }
+      lock.unlock();
+      client.close();
+      lock.lock();
+      changed.wait_for(lock, std::chrono::seconds(5), [&]()
+                       { return closed; });
+    }
+    nlohmann::json stats = {{"connects", connects - failed},
+                            {"failed", failed},
+                            {"connect_ns", open_ns.to_json()}};
+    if (tls_ns.count() > 0)
+    {
+      stats["tls_handshake_ns"] = tls_ns.to_json();
+      stats["tls_resumed"] = resumed;
+    }
+    return stats;
+  }
+
+  nlohmann::json round_json(const Round &round, size_t size)
+  {
+    const double seconds = round.elapsed_ns / 1e9;
+    return {{"messages", round.received},
+            {"elapsed_ms", round.elapsed_ns / 1e6},
+            {"messages_per_s", seconds > 0 ? round.received / seconds : 0.0},
+            {"mbytes_per_s", seconds > 0 ? round.received * size / seconds / 1e6 : 0.0},
+            {"rtt_ns", round.rtt.to_json()}};
+  }
+}
+
+int main(int argc, char **argv)
+{
+  size_t messages = 100000;
+  size_t size = 256;
+  size_t window = 64;
+  size_t connects = 50;
+  int cpu = -1;
+  std::string transport = "both";
+
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg = argv[i];
+    if (arg == "--messages" && i + 1 < argc)
+    {
+      messages = static_cast<size_t>(std::atol(argv[++i]));
+    }
+    else if (arg == "--size" && i + 1 < argc)
+    {
+      size = static_cast<size_t>(std::atol(argv[++i]));
+    }
+    else if (arg == "--window" && i + 1 < argc)
+    {
+      window = std::max<size_t>(static_cast<size_t>(std::atol(argv[++i])), 1);
+    }
+    else if (arg == "--connects" && i + 1 < argc)
+    {
+      connects = static_cast<size_t>(std::atol(argv[++i]));
+    }
+    else if (arg == "--cpu" && i + 1 < argc)
+    {
+      cpu = std::atoi(argv[++i]);
+    }
+    else if (arg == "--transport" && i + 1 < argc)
+    {
+      transport = argv[++i];
+    }
+    else
+    {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+  if (messages == 0 || (transport != "epoll" && transport != "io_uring" && transport != "both"))
+  {
+    usage(argv[0]);
+    return 1;
+  }
+
+  SSL_CTX *context = server_context();
+  int listener = ::socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t length = sizeof(address);
+  if (::bind(listener, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 || ::listen(listener, 16) != 0)
+  {
+    std::perror("listen");
+    return 1;
+  }
+  getsockname(listener, reinterpret_cast<sockaddr *>(&address), &length);
+  std::thread([context, listener]()
+              {
+                for (;;)
+                {
+                  int fd = ::accept(listener, nullptr, nullptr);
+                  if (fd < 0)
+                  {
+                    return;
+                  }
+                  std::thread(serve, context, fd).detach();
+                } })
+      .detach();
+  const std::string url = "wss://127.0.0.1:" + std::to_string(ntohs(address.sin_port)) + "/ws";
+
+  nlohmann::json report;
+  report["messages"] = messages;
+  report["size"] = size;
+  report["window"] = window;
+  report["connects"] = connects;
+  for (const std::string name : {"epoll", "io_uring"})
+  {
+    if (transport != "both" && transport != name)
+    {
+      continue;
+    }
+    if (name == "io_uring" && !UringWsClient::available())
+    {
+      report[name] = {{"error", "io_uring is not available in this build or kernel"}};
+      continue;
+    }
+    FeedLoop loop("gio-bench-" + name, cpu);
+    auto make_client = [&](bool resume) -> std::unique_ptr<WsClient>
+    {
+      if (name == "epoll")
+      {
+        return std::make_unique<HvWsClient>(loop.loop(), url.c_str());
+      }
+      UringWsClient::Options options;
+      options.verify_peer = false;   // self-signed
+      options.resume_sessions = resume;
+      return std::make_unique<UringWsClient>(loop.loop(), url.c_str(), options);
+    };
+    // Clients are destroyed on their loop
+    auto release = [&loop](std::unique_ptr<WsClient> &client)
+    {
+      std::promise<void> released;
+      loop.loop()->runInLoop([&client, &released]()
+                             {
+                               client.reset();
+                               released.set_value(); });
+      released.get_future().wait();
+    };
+
+    nlohmann::json result;
+    const std::pair<const char *, size_t> rounds[] = {{"rtt", 1}, {"throughput", window}};
+    for (const auto &[round_name, in_flight] : rounds)
+    {
+      std::unique_ptr<WsClient> client = make_client(true);
+      Round round;
+      const bool completed = run_round(*client, messages, size, in_flight, round);
+      result[round_name] = round_json(round, size);
+      result[round_name]["completed"] = completed;
+      result[round_name]["client"] = client->get_stats();
+      release(client);
+    }
+    if (connects > 0)
+    {
+      const std::pair<const char *, bool> reconnect_rounds[] = {{"reconnect_full", false}, {"reconnect_resumed", true}};
+      for (const auto &[round_name, resume] : reconnect_rounds)
+      {
+        // libhv keeps its TLS session to itself, so the epoll client only has the one kind
+        if (name == "epoll" && resume)
+        {
+          continue;
+        }
+        std::unique_ptr<WsClient> client = make_client(resume);
+        result[name == "epoll" ? "reconnect" : round_name] = run_reconnects(*client, connects);
+        release(client);
+      }
+    }
+    report[name] = result;
+  }
+  report["tls_sessions"] = TlsSessionCache::shared().get_stats();
+  std::printf("%s\n", report.dump(2).c_str());
+  ::close(listener);
+  return 0;
+}